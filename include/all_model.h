@@ -1,10 +1,66 @@
 #ifndef ALL_MODEL_H
 #define ALL_MODEL_H
 
+#include <stdint.h>
+
+#include <cstddef>
 #include <vector>
 #include "model.h"
 
 class TimeGraph;
+class RailSchedule;
+class ScheduleSink;
+struct CraneTask;
+struct ScheduleViolation;
+
+/**
+ * @brief Represents the data of an `All_Model` instance as a text instance lays it out.
+ *
+ * Containers keep their ids, which need not be contiguous, so instances built one after
+ * another over the same yard refer to the same containers.
+ */
+struct AllModelData {
+    int H, W, L;                    /**< The dimensions of the yard (height, bays, rows). */
+    std::map<int, dat> containers;  /**< The containers in the yard by id, at (h, w, l). */
+    std::vector<dat> areas;         /**< The lowest free slot of each stack that takes containers. */
+    std::set<int> res_ss;           /**< The reserved short-span containers. */
+    int imp_ss;                     /**< The number of short-span imports. */
+    std::set<int> exp_ss;           /**< The short-span exports. */
+    std::set<int> res_ls;           /**< The reserved long-span containers. */
+    int imp_ls;                     /**< The number of long-span imports. */
+    std::set<int> exp_ls;           /**< The long-span exports. */
+};
+
+/**
+ * @brief Represents a genome decoded up to some move, for searches that build genomes move by move.
+ *
+ * Reserved moves come first for each crane, then the imports and exports. The short-span
+ * moves of a joint genome all come before the long-span ones.
+ */
+struct MovePrefix {
+    bool ls;        /**< Whether the next move is made by the long-span crane. */
+    int step;       /**< The index of the next move of that crane. */
+    int start;      /**< The first bit of the next move in the genome. */
+    bool done;      /**< Whether every move has been simulated. */
+    bool reserved;  /**< Whether the next move is a reserved move. */
+    int res;        /**< The reserved containers the next move can take. */
+    int imp;        /**< The imports left to the crane. */
+    int exp;        /**< The exports left to the crane. */
+    int areas;      /**< The slots a container can be dropped on. */
+    double time;    /**< The makespan of the crane over the simulated moves. */
+    double floor;   /**< The makespan of the short-span crane once the long-span one is reached, else 0. */
+    double bound;   /**< A lower bound on the makespan of any genome with this prefix. */
+    uint64_t state; /**< A hash of what the remaining moves of the crane depend on besides the time. */
+};
+
+/**
+ * @brief Represents one choice for the next move of a prefix.
+ */
+struct MoveChoice {
+    bool import; /**< For an import or export move, `true` to import. */
+    int pick;    /**< The index of the reserved container or the export to take, 0 for imports. */
+    int area;    /**< The index of the slot to drop on, 0 for exports. */
+};
 
 /**
  * @brief Represents a comprehensive model for the Particle Swarm Optimization (PSO) algorithm.
@@ -60,6 +116,12 @@ private:
     std::vector<TimeGraph*> ss_graph; /**< Time graph for the short-span model. */
     std::vector<TimeGraph*> ls_graph; /**< Time graph for the long-span model. */
 
+    ScheduleSink* sink = NULL; /**< The receiver of shown schedules, not owned; NULL prints text to stdout. */
+
+    double ss_travel = 0; /**< The time the short-span crane spent travelling in the last `ss_solve()`. */
+    double ls_travel = 0; /**< The time the long-span crane spent travelling in the last `ls_solve()`. */
+    double ls_wait = 0;   /**< The time the long-span crane waited for the short-span one in the last `ls_solve()`. */
+
     const static int TRAVEL_TIME = 3;  /**< Time required for travel. */
     const static int CONTROL_TIME = 28; /**< Time required for control operations. */
 
@@ -69,10 +131,22 @@ private:
      */
     void load_data(const char* file);
 
+    /**
+     * @brief Loads a precomputed binary instance written by `save_binary()`.
+     *
+     * Restores the data together with the stack table, the pools and the bit layout,
+     * so neither `analyze()` nor `calculate_malloc_size()` has to run.
+     *
+     * @param file The path to the binary file.
+     */
+    void load_binary(const char* file);
+
     /**
      * @brief Analyzes the loaded data.
+     * @param solved Whether the yard has been solved into: stacks are then indexed by height,
+     * with -1 where a container was taken out, and area slots filled since are not free.
      */
-    void analyze();
+    void analyze(bool solved = false);
 
     /**
      * @brief Calculates the required memory allocation size.
@@ -94,6 +168,105 @@ private:
      */
     int check_ss(TimeGraph* src, int& time_counter, int start_time);
 
+    /**
+     * @brief Decodes and simulates the short-span crane.
+     * @param x The input vector.
+     * @param record A flag indicating whether to record the timeline and marks.
+     * @param verbose A flag indicating whether to print the schedule.
+     * @param cutoff Stops once the makespan cannot stay below this value.
+     * @param steps Stops before this move, -1 to simulate them all.
+     * @param prefix If not NULL, receives where the simulation stopped.
+     * @return The fitness value, or a lower bound of at least `cutoff` if stopped early.
+     */
+    double ss_solve(char* x, bool record, bool verbose, double cutoff, int steps = -1, MovePrefix* prefix = NULL);
+
+    /**
+     * @brief Decodes and simulates the long-span crane against the short-span timeline.
+     * @param x The input vector.
+     * @param edited A flag indicating whether to record and print the schedule.
+     * @param cutoff Stops once the makespan cannot stay below this value.
+     * @param steps Stops before this move, -1 to simulate them all.
+     * @param prefix If not NULL, receives where the simulation stopped.
+     * @return The fitness value, or a lower bound of at least `cutoff` if stopped early.
+     */
+    double ls_solve(char* x, bool edited, double cutoff, int steps = -1, MovePrefix* prefix = NULL);
+
+    /**
+     * @brief Describes the state of a crane before one of its moves.
+     *
+     * The state hash covers the pools of the crane, the heights and bays of the free
+     * slots and the bay of the crane, which is all the timing of later moves reads. The
+     * rows of the slots are left out: they only matter through the marks that decide the
+     * slots of the long-span crane.
+     *
+     * @param p The description.
+     * @param ls `true` for the long-span crane.
+     * @param step The index of the next move.
+     * @param start The first bit of the next move.
+     * @param y The makespan so far.
+     * @param pos The bay of the crane, or the position in the short-span timeline for the long-span crane.
+     */
+    void describe_prefix(MovePrefix& p, bool ls, int step, int start, double y, int pos);
+
+    /**
+     * @brief Gets a lower bound on the time of the moves still to be simulated.
+     *
+     * Every move takes a pick and a drop. Imports and exports of the short-span crane
+     * also travel at least one bay to or from the truck lane, and every move of the
+     * long-span crane travels at least one bay out from and back to its rail end.
+     *
+     * @param ls `true` for the long-span crane.
+     * @param res_steps The reserved moves left.
+     * @param io_steps The import and export moves left.
+     * @return The bound.
+     */
+    static double remaining_bound(bool ls, int res_steps, int io_steps) {
+        double move = 2 * CONTROL_TIME;
+        double io = move + (ls ? 2 : 1) * TRAVEL_TIME;
+        return res_steps * (ls ? io : move) + io_steps * io;
+    }
+
+    /**
+     * @brief Decodes the short-span genome into crane tasks.
+     *
+     * Pools, containers and marks are updated the same way `fx_function_solve()` does
+     * in edited mode.
+     *
+     * @param x The input vector.
+     * @param tasks The decoded tasks in execution order.
+     */
+    void decode_ss_tasks(char* x, std::vector<CraneTask>& tasks);
+
+    /**
+     * @brief Decodes the long-span genome into crane tasks.
+     * @param x The input vector.
+     * @param tasks The decoded tasks in execution order.
+     */
+    void decode_ls_tasks(char* x, std::vector<CraneTask>& tasks);
+
+    /**
+     * @brief Finds the free slot closest to a position.
+     * @param w The bay.
+     * @param l The row.
+     * @return The index in the area pool, 0 if the position is off the yard.
+     */
+    int nearest_area(int w, int l) const;
+
+    /**
+     * @brief Encodes the moves of another instance as a genome of one crane of this one.
+     *
+     * Reserved moves keep their order as long as their container is still reserved here.
+     * Imports and exports keep their order and drop on the free slot closest to the old
+     * one; exports of containers no longer exported are left out. Moves the old tasks do
+     * not cover come last. Pools, containers and marks are updated as `decode_ss_tasks()`
+     * and `decode_ls_tasks()` do.
+     *
+     * @param ls `true` for the long-span crane.
+     * @param old The decoded tasks of the crane on the other instance.
+     * @param x Receives the genome of the crane.
+     */
+    void remap_tasks(bool ls, const std::vector<CraneTask>& old, char* x);
+
 public:
     /**
      * @brief Default constructor.
@@ -102,10 +275,26 @@ public:
 
     /**
      * @brief Constructor that loads data from a file.
+     *
+     * The file may be a text instance or a binary instance written by `save_binary()`.
+     *
      * @param input The path to the input file.
+     * @throws std::runtime_error If the file is missing or malformed.
      */
     All_Model(const char*& input);
 
+    /**
+     * @brief Constructor that builds an instance in memory.
+     * @param data The instance.
+     */
+    explicit All_Model(const AllModelData& data);
+
+    /**
+     * @brief Gets the instance as it was loaded.
+     * @return The yard, the reserved containers and the jobs.
+     */
+    AllModelData get_data() const;
+
     /**
      * @brief Destructor.
      */
@@ -117,6 +306,16 @@ public:
      */
     All_Model* clone();
 
+    /**
+     * @brief Writes the instance and its precomputed state to a binary file.
+     *
+     * Must be called on a freshly loaded model, before any solve has changed the pools.
+     *
+     * @param file The path to the output file.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void save_binary(const char* file) const;
+
     /**
      * @brief Pops an element from a pool.
      * @param pool The pool to pop from.
@@ -172,6 +371,15 @@ public:
      */
     void ls_analyze();
 
+    /**
+     * @brief Rebuilds the stack table and the pools from the containers and areas.
+     *
+     * The long-span part of a joint evaluation sees the yard exactly as the short-span part
+     * left it, holes and filled area slots included. `clone()` keeps the view the two-phase
+     * pipeline always had, which stacks what is left without holes.
+     */
+    void reanalyze();
+
     /**
      * @brief Solves the fitness function for the short-span model.
      * @param x_size The size of the input vector.
@@ -190,6 +398,216 @@ public:
      */
     double fx_function_solve_2(int x_size, char* x, bool edited = false);
 
+    /**
+     * @brief Solves the joint fitness function for both cranes in one pass.
+     *
+     * The input vector is the short-span genome followed by the long-span genome
+     * (see `get_joint_bit_size()`). The short-span crane is simulated first and its
+     * timeline is used as the interference model for the long-span crane.
+     *
+     * @param x_size The size of the input vector.
+     * @param x The concatenated input vector.
+     * @param edited A flag indicating whether the model has been edited.
+     * @return The makespan over both cranes.
+     */
+    double fx_function_solve_joint(int x_size, char* x, bool edited = false);
+
+    /**
+     * @brief Solves the short-span fitness function unless it cannot beat a cutoff.
+     *
+     * Makespans only grow as moves are simulated, so once the makespan so far plus a
+     * lower bound on the remaining moves reaches `cutoff` the rest is skipped. This
+     * suits a particle whose personal best is the cutoff: any result not below it
+     * changes nothing. The model is left partly solved when stopped early.
+     *
+     * @param x The input vector.
+     * @param cutoff The value to beat.
+     * @return The exact fitness value if below `cutoff`, otherwise a lower bound of at least `cutoff`.
+     */
+    double fx_function_solve_bounded(char* x, double cutoff);
+
+    /**
+     * @brief Solves the long-span fitness function unless it cannot beat a cutoff.
+     * @param x The input vector.
+     * @param cutoff The value to beat.
+     * @return The exact fitness value if below `cutoff`, otherwise a lower bound of at least `cutoff`.
+     * @see fx_function_solve_bounded()
+     */
+    double fx_function_solve_2_bounded(char* x, double cutoff);
+
+    /**
+     * @brief Solves the joint fitness function unless it cannot beat a cutoff.
+     * @param x The concatenated input vector.
+     * @param cutoff The value to beat.
+     * @return The exact makespan if below `cutoff`, otherwise a lower bound of at least `cutoff`.
+     * @see fx_function_solve_bounded()
+     */
+    double fx_function_solve_joint_bounded(char* x, double cutoff);
+
+    /**
+     * @brief Solves the long-span fitness function as if the short-span crane were never in the way.
+     *
+     * The moves are only summed, without the `check_ss` waiting loops. Waits only delay the
+     * crane, so the result is a lower bound of `fx_function_solve_2()`.
+     *
+     * @param x The input vector.
+     * @return A lower bound of the long-span fitness value.
+     */
+    double fx_function_solve_2_relaxed(char* x);
+
+    /**
+     * @brief Solves the joint fitness function with the long-span crane relaxed.
+     *
+     * The short-span crane is simulated exactly and bounds the makespan from below on its
+     * own, which corrects the relaxed long-span makespan when that crane is the longer one.
+     *
+     * @param x The concatenated input vector.
+     * @return A lower bound of `fx_function_solve_joint()`.
+     * @see fx_function_solve_2_relaxed()
+     */
+    double fx_function_solve_joint_relaxed(char* x);
+
+    /**
+     * @brief Solves the long-span fitness function and scores it on every objective.
+     *
+     * Fills `f` with the makespan, the time the long-span crane waits for the short-span
+     * one and the time it travels. `fx_function_solve_2()` folds the waits into the
+     * makespan; here they are also kept apart, so that schedules can be traded off.
+     *
+     * @param x The input vector.
+     * @param f Receives the 3 objectives.
+     * @return The makespan, `f[0]`.
+     */
+    double fx_function_solve_2_objectives(char* x, double* f);
+
+    /**
+     * @brief Solves the joint fitness function and scores it on every objective.
+     *
+     * Fills `f` with the makespan over both cranes, the time the long-span crane waits
+     * for the short-span one and the time both cranes travel.
+     *
+     * @param x The concatenated input vector.
+     * @param f Receives the 3 objectives.
+     * @return The makespan, `f[0]`.
+     * @see fx_function_solve_2_objectives()
+     */
+    double fx_function_solve_joint_objectives(char* x, double* f);
+
+    /**
+     * @brief Simulates the first moves of a genome and describes the choices of the next one.
+     *
+     * With `joint` the genome is the joint genome and its moves are counted over both
+     * cranes; otherwise it is the short-span genome. Bits past the simulated moves are
+     * not read. The model is used up, so call this on a clone.
+     *
+     * @param x The input vector.
+     * @param joint `true` for the joint genome.
+     * @param steps The number of moves to simulate.
+     * @param p Receives the state before the next move and a lower bound on any completion.
+     */
+    void fx_function_solve_prefix(char* x, bool joint, int steps, MovePrefix& p);
+
+    /**
+     * @brief Hashes the crane moves a genome decodes to.
+     *
+     * Bits are mapped onto pools by `adjust()` and the import/export bit of a move is not
+     * read once a pool is empty, so many genomes decode to the same moves and share a
+     * fitness. They also share this key, which also leaves out which import a move takes. The model is used up, so call this on a clone.
+     *
+     * @param x The input vector.
+     * @param ss `true` if the input vector holds a short-span genome, which comes first.
+     * @param ls `true` if the input vector holds a long-span genome.
+     * @return The key.
+     */
+    uint64_t decoded_key(char* x, bool ss, bool ls);
+
+    /**
+     * @brief Hashes the crane moves a genome of one crane decodes to, without using up the model.
+     *
+     * Only pool copies are walked, so the key costs no clone. It equals `decoded_key()` of the
+     * same genome on a clone as long as the pools are the ones `analyze()` leaves, as on a
+     * clone or a model not yet solved into. A joint genome still needs a clone, as its
+     * long-span moves are decoded on the yard the short-span ones leave.
+     *
+     * @param x The input vector.
+     * @param ls `true` for a long-span genome, `false` for a short-span one.
+     * @return The key.
+     */
+    uint64_t phase_key(char* x, bool ls) const;
+
+    /**
+     * @brief Carries a genome of another instance of the same yard over to this instance.
+     *
+     * Containers are matched by their index in the instance files and slots by their
+     * position, so small edits such as one more export or a container that moved keep
+     * most of the old decisions. Both models are used up, so call this on clones.
+     *
+     * @param from The model of the other instance.
+     * @param from_x The genome on the other instance.
+     * @param joint `true` for joint genomes, otherwise short-span genomes.
+     * @param x Receives the genome on this instance, `get_joint_bit_size()` or `get_bit_size()` bytes.
+     */
+    void remap_genome(All_Model& from, char* from_x, bool joint, char* x);
+
+    /**
+     * @brief Decodes a joint genome into the moves of both cranes.
+     *
+     * The model is used up, so call this on a clone.
+     *
+     * @param x The joint input vector.
+     * @param ss Receives the short-span moves in execution order.
+     * @param ls Receives the long-span moves in execution order.
+     */
+    void decode_tasks(char* x, std::vector<CraneTask>& ss, std::vector<CraneTask>& ls);
+
+    /**
+     * @brief Writes the bits that make the next move of a prefix take the given choices.
+     * @param p The prefix, as filled by `fx_function_solve_prefix()`.
+     * @param import For an import or export move, `true` to import.
+     * @param pick The index of the reserved container or the export to take, 0 for imports.
+     * @param area The index of the slot to drop on, ignored for exports.
+     * @param x The genome to write to.
+     */
+    void encode_move(const MovePrefix& p, bool import, int pick, int area, char* x) const;
+
+    /**
+     * @brief Lists the choices for the next move of a prefix that can lead to different schedules.
+     * @param p The prefix, as filled by `fx_function_solve_prefix()`.
+     * @param moves Receives the choices, to pass to `encode_move()`.
+     */
+    static void list_moves(const MovePrefix& p, std::vector<MoveChoice>& moves);
+
+    /**
+     * @brief Gets the number of moves of the short-span crane.
+     * @return The number of moves.
+     */
+    inline int get_ss_steps() const {
+        return res_ss_steps + imp_ss_steps + exp_ss_steps;
+    }
+
+    /**
+     * @brief Gets the number of moves of the long-span crane.
+     * @return The number of moves.
+     */
+    inline int get_ls_steps() const {
+        return res_ls_steps + imp_ls_steps + exp_ls_steps;
+    }
+
+    /**
+     * @brief Solves the joint fitness function for k cranes on the shared rail.
+     *
+     * Decodes the same genome as `fx_function_solve_joint()`. Crane 0 takes the
+     * short-span transfers and crane k-1 the long-span transfers. For k > 2 the reserved
+     * reshuffles go to the intermediate crane whose zone holds the container. With two
+     * cranes this gives the same makespan as `fx_function_solve_joint()`.
+     *
+     * @param x The concatenated input vector.
+     * @param cranes The number of cranes on the rail.
+     * @param schedule If not NULL, receives the crane timelines.
+     * @return The makespan over all cranes.
+     */
+    double fx_function_solve_rail(char* x, int cranes, RailSchedule* schedule = NULL);
+
     /**
      * @brief Gets the bit size of the model.
      * @return The bit size.
@@ -199,7 +617,53 @@ public:
     }
 
     /**
-     * @brief Displays the model's state.
+     * @brief Gets the bit size of the short-span part of the joint genome.
+     * @return The bit size.
+     */
+    inline int get_ss_bit_size() const {
+        return ss_allocate_size;
+    }
+
+    /**
+     * @brief Gets the bit size of the joint short-span and long-span genome.
+     * @return The bit size.
+     */
+    inline int get_joint_bit_size() const {
+        return ss_allocate_size + ls_allocate_size;
+    }
+
+    /**
+     * @brief Gets the number of stacks that can still take a container.
+     * @return The size of the area pool.
+     */
+    inline int get_area_pool_size() const {
+        return area_pool.size();
+    }
+
+    /**
+     * @brief Sets where schedules are sent when a solve is called in edited mode.
+     *
+     * Edited solves emit one `ScheduleEvent` per move, pick, drop and wait. Without a
+     * sink they are printed to stdout as text.
+     *
+     * @param s The sink, not owned, or `NULL` for text on stdout.
+     */
+    inline void set_schedule_sink(ScheduleSink* s) {
+        sink = s;
+    }
+
+    /**
+     * @brief Checks the recorded timelines of both cranes with `validate_schedule()`.
+     *
+     * The timelines are recorded by a solve in edited mode, as for `display()`. Each time
+     * graph is checked as one event, the short-span crane being crane 0.
+     *
+     * @return The violations, empty for a valid schedule.
+     */
+    std::vector<ScheduleViolation> validate();
+
+    /**
+     * @brief Displays the model's state, then the violations `validate()` finds.
      */
     void display();
 };
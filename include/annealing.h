@@ -0,0 +1,219 @@
+#ifndef ANNEALING_H
+#define ANNEALING_H
+
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "binary_pso.h"
+#include "packed_swarm.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Represents simulated annealing over bit strings, with parallel tempering for several replicas.
+ *
+ * A move flips one random bit and is kept by the Metropolis rule. The acceptance
+ * threshold is drawn before the evaluation, so with `params.bounded` a flip is scored
+ * only as far as needed to reject it. One replica cools geometrically from the hottest
+ * temperature to a hundredth of it over the run. Several replicas each stay at one
+ * temperature of a geometric ladder and swap their solutions with their neighbours after
+ * every sweep of as many moves as there are bits, so good solutions found hot are refined
+ * cold. The replicas of a sweep run on `threads` threads; every replica has its own
+ * generator, so the result does not depend on the number of threads.
+ */
+class Annealing : public Optimizer {
+public:
+    BinaryPSOParams params; /**< The parameters of the run. */
+    unsigned seed;          /**< The seed of the run. */
+    int threads;            /**< The number of threads the replicas share. */
+
+    /**
+     * @brief Constructor that sets the parameters and the seed.
+     * @param p The parameters.
+     * @param s The seed.
+     * @param t The number of threads.
+     */
+    Annealing(const BinaryPSOParams& p, unsigned s, int t = 1) : params(p), seed(s), threads(t) {}
+
+    BinaryPSOResult Run(Objective& f) {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        int n = f.Size();
+        int count = std::max(1, params.replicas);
+        long long budget = std::max<long long>((long long) params.popsize * params.iterations, count);
+        std::vector<Replica> reps(count);
+        BinaryPSOResult res;
+        res.evaluations = res.screened = res.relaxed = 0;
+        res.relaxed_gap = 0;
+        res.retired = 0;
+        res.duplicates = res.reseeded = 0;
+        res.key_seconds = 0;
+        res.diversity = 0;
+        res.best = std::numeric_limits<double>::infinity();
+
+        std::vector<std::vector<char> > x(count, std::vector<char>(n));
+        for (int k = 0; k < count; k++) {
+            reps[k].rng.seed(seed + 7919u * k);
+            for (int j = 0; j < n; j++) x[k][j] = reps[k].rng() % 2;
+        }
+        Start(x);
+        double scale = 0;
+        for (int k = 0; k < count; k++) {
+            Replica& r = reps[k];
+            r.count.evaluations = 0;
+            r.x = x[k];
+            r.fx = r.best = BinaryPSO::Evaluate(f, r.x.data(), r.count);
+            r.xbest = r.x;
+            scale += fabs(r.fx) / count;
+        }
+        //! The temperatures follow the scale of the objective, so TEMP works for any instance
+        double hot = std::max(params.temp * scale, 1e-9), cold = hot / 100;
+        for (int k = 0; k < count; k++) {
+            reps[k].temp = count > 1 ? hot * pow(cold / hot, (double) k / (count - 1)) : hot;
+        }
+        Collect(reps, res, t0);
+
+        std::mt19937 swap_rng(seed ^ 0x5bd1e995u);
+        ThreadPool* pool = threads > 1 && count > 1 ? new ThreadPool(std::min(threads, count)) : NULL;
+        for (int round = 1; res.evaluations < budget; round++) {
+            long long steps = std::min<long long>(std::max(n, 1), (budget - res.evaluations) / count);
+            if (steps <= 0) break;
+            for (int k = 0; k < count; k++) {
+                Replica* r = &reps[k];
+                if (pool) {
+                    pool->submit([this, &f, r, steps, budget, count, hot, cold] {
+                        Sweep(f, *r, steps, budget / count, count == 1, hot, cold);
+                    });
+                } else {
+                    Sweep(f, *r, steps, budget / count, count == 1, hot, cold);
+                }
+            }
+            if (pool) pool->wait();
+            //! Neighbours swap solutions, even pairs on even rounds and odd pairs on odd ones
+            for (int k = round % 2; k + 1 < count; k += 2) {
+                Replica& a = reps[k];
+                Replica& b = reps[k + 1];
+                double delta = (a.fx - b.fx) * (1 / a.temp - 1 / b.temp);
+                if (delta >= 0 || (double) swap_rng() / swap_rng.max() < exp(delta)) {
+                    std::swap(a.x, b.x);
+                    std::swap(a.fx, b.fx);
+                }
+            }
+            Collect(reps, res, t0);
+            if (trace) Record(round, t0, res, reps);
+        }
+        delete pool;
+
+        res.mean_pbest = 0;
+        for (Replica& r : reps) res.mean_pbest += r.best / count;
+        res.swarm.clear();
+        for (Replica& r : reps) res.swarm.push_back(r.xbest);
+        res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return res;
+    }
+
+private:
+    /**
+     * @brief Represents one replica of the tempering ladder.
+     */
+    struct Replica {
+        std::mt19937 rng;        /**< The random generator of the replica. */
+        std::vector<char> x;     /**< The current solution. */
+        double fx;               /**< The fitness of the current solution. */
+        std::vector<char> xbest; /**< The best solution of the replica. */
+        double best;             /**< The best fitness of the replica. */
+        double temp;             /**< The temperature. */
+        BinaryPSOResult count;   /**< Counts the evaluations of the replica. */
+    };
+
+    /**
+     * @brief Runs Metropolis moves on one replica.
+     * @param f The objective.
+     * @param r The replica.
+     * @param steps The number of moves.
+     * @param length The number of moves of the replica over the whole run, for the cooling schedule.
+     * @param cooling `true` to cool a single replica instead of keeping its temperature.
+     * @param hot The hottest temperature.
+     * @param cold The coldest temperature.
+     */
+    void Sweep(Objective& f, Replica& r, long long steps, long long length, bool cooling, double hot, double cold) {
+        int n = r.x.size();
+        for (long long s = 0; s < steps && n > 0; s++) {
+            if (cooling) r.temp = hot * pow(cold / hot, (double) r.count.evaluations / std::max(length, 1LL));
+            int j = r.rng() % n;
+            double u = ((double) r.rng() + 1) / ((double) r.rng.max() + 1);
+            double threshold = r.fx - r.temp * log(u);
+            r.x[j] = !r.x[j];
+            double y = params.bounded ? BinaryPSO::Evaluate(f, r.x.data(), threshold, r.count)
+                    : BinaryPSO::Evaluate(f, r.x.data(), r.count);
+            if (y < threshold) {
+                r.fx = y;
+                if (y < r.best) {
+                    r.best = y;
+                    r.xbest = r.x;
+                }
+            } else {
+                r.x[j] = !r.x[j];
+            }
+        }
+    }
+
+    /**
+     * @brief Sums the evaluations of the replicas and takes over a better best.
+     * @param reps The replicas.
+     * @param res The outcome of the run so far.
+     * @param t0 The start of the run.
+     */
+    static void Collect(std::vector<Replica>& reps, BinaryPSOResult& res, std::chrono::steady_clock::time_point t0) {
+        res.evaluations = 0;
+        int l = -1;
+        for (size_t k = 0; k < reps.size(); k++) {
+            res.evaluations += reps[k].count.evaluations;
+            if (reps[k].best < res.best && (l < 0 || reps[k].best < reps[l].best)) l = k;
+        }
+        if (l >= 0) {
+            res.best = reps[l].best;
+            res.xbest = reps[l].xbest;
+            BinaryPSO::Improved(res, t0, res.best);
+        }
+    }
+
+    /**
+     * @brief Sends the state of the replicas after a sweep to the trace.
+     *
+     * The iteration is the sweep, the mean personal best is the mean best of the
+     * replicas, the diversity is taken over the current solutions of the replicas and
+     * the velocity index is 0.
+     */
+    void Record(int round, std::chrono::steady_clock::time_point t0, const BinaryPSOResult& res,
+            const std::vector<Replica>& reps) {
+        TraceRecord r = tag;
+        int count = reps.size();
+        int n = res.xbest.size();
+        PackedSwarm packed(n);
+        std::vector<std::vector<char> > x;
+        for (const Replica& p : reps) x.push_back(p.x);
+        packed.assign(x);
+        r.iteration = round;
+        r.gbest = res.best;
+        r.mean_pbest = r.avg_obj = r.vel_index = 0;
+        r.min_obj = r.max_obj = reps[0].fx;
+        for (const Replica& p : reps) {
+            r.mean_pbest += p.best / count;
+            r.avg_obj += p.fx / count;
+            r.min_obj = std::min(r.min_obj, p.fx);
+            r.max_obj = std::max(r.max_obj, p.fx);
+        }
+        r.dispersion = packed.dispersion(res.xbest.data());
+        r.diversity = packed.diversity();
+        r.unique = packed.unique();
+        r.evaluations = res.evaluations;
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        trace->record(r);
+    }
+};
+
+#endif /* ANNEALING_H */
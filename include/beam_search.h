@@ -0,0 +1,73 @@
+#ifndef BEAM_SEARCH_H
+#define BEAM_SEARCH_H
+
+#include <vector>
+
+#include "all_model.h"
+
+/**
+ * @brief Represents the outcome of a beam search.
+ */
+struct BeamSearchResult {
+    double best;             /**< The makespan of the best schedule built. */
+    std::vector<char> xbest; /**< A genome of the best schedule. */
+    long long nodes;         /**< The number of prefixes simulated. */
+    long long merged;        /**< The prefixes dropped because another one reached the same state at the same time. */
+    double seconds;          /**< The wall time of the search. */
+};
+
+/**
+ * @brief Builds a schedule of an `All_Model` instance move by move, keeping the best few prefixes.
+ *
+ * The search makes the same decisions as `BranchAndBound` (which reserved container,
+ * export or import each move takes and which slot it is dropped on), but breadth first:
+ * every prefix of the beam is extended by each choice of its next move, and only the
+ * `width` prefixes with the lowest makespan plus bound on the moves left are kept for
+ * the next move. All prefixes have the same number of moves, so after the last move the
+ * beam holds complete schedules and the best is returned as a genome.
+ *
+ * The work is fixed by the width and the instance, not by how good the solutions are,
+ * so the latency is predictable. The result is the same for any number of threads.
+ */
+class BeamSearch {
+public:
+    All_Model* model; /**< The master model, only read. */
+    int width;        /**< The number of prefixes kept after each move. */
+    bool joint;       /**< `true` for the joint genome of both cranes, `false` for the short-span genome. */
+    int threads;      /**< The number of threads simulating the prefixes of a move. */
+
+    /**
+     * @brief Constructor that sets the model and the search.
+     * @param m The master model, not owned.
+     * @param w The beam width.
+     * @param j `true` to build the joint genome as `JointObjective`, `false` for the short-span genome as `ShortSpanObjective`.
+     * @param t The number of threads.
+     */
+    BeamSearch(All_Model* m, int w = 16, bool j = true, int t = 1);
+
+    /**
+     * @brief Runs the search.
+     * @return The outcome.
+     */
+    BeamSearchResult Run();
+
+private:
+    /**
+     * @brief Represents a prefix in the beam.
+     */
+    struct Node {
+        std::vector<char> x; /**< The genome, valid up to the prefix. */
+        MovePrefix p;        /**< The simulated prefix. */
+    };
+
+    int size; /**< The size of the genome. */
+
+    /**
+     * @brief Simulates a prefix on a clone of the model.
+     * @param depth The number of moves to simulate.
+     * @param n The node, whose genome is read and whose prefix is filled.
+     */
+    void Simulate(int depth, Node& n);
+};
+
+#endif /* BEAM_SEARCH_H */
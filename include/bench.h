@@ -0,0 +1,206 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "function.h"
+#include "perf_counters.h"
+
+/**
+ * @brief Represents one microbenchmark.
+ *
+ * A repetition calls `setup(n)` outside the timer, then `op(0)` to `op(n - 1)` inside it,
+ * then `teardown()` outside it again. State an operation consumes, such as a clone of
+ * the model, is built by `setup` so that only the operation itself is timed.
+ */
+struct BenchCase {
+    std::string name;                 /**< The name of the benchmark. */
+    std::function<void(int)> setup;   /**< Prepares the inputs of n operations, may be empty. */
+    std::function<void(int)> op;      /**< Runs the i-th operation. */
+    std::function<void()> teardown;   /**< Frees what `setup` built, may be empty. */
+    int max_batch;                    /**< The largest number of operations per repetition, 0 for no limit. */
+};
+
+/**
+ * @brief Represents the timings of one microbenchmark.
+ */
+struct BenchResult {
+    std::string name;  /**< The name of the benchmark. */
+    int batch;         /**< The number of operations per repetition. */
+    int repetitions;   /**< The number of timed repetitions. */
+    double min_ns;     /**< The fastest repetition, in nanoseconds per operation. */
+    double median_ns;  /**< The median repetition, in nanoseconds per operation. */
+    double mean_ns;    /**< The mean repetition, in nanoseconds per operation. */
+    double stddev_ns;  /**< The standard deviation of the repetitions, in nanoseconds per operation. */
+    PerfRegion perf;   /**< The hardware counts of the timed repetitions, empty without counters. */
+};
+
+/**
+ * @brief Keeps a computed value alive so the compiler cannot drop the work behind it.
+ * @param v The value.
+ */
+inline void bench_keep(double v) {
+    __asm__ __volatile__("" : : "g"(v) : "memory");
+}
+
+/**
+ * @brief Runs microbenchmarks with warmup and repetitions.
+ *
+ * The batch size of a benchmark is doubled during the warmup until one repetition takes
+ * at least `target_ms`, so fast and slow operations are both timed over a measurable
+ * interval. Results are reported per operation. When `perf` is set, each benchmark is also
+ * a region of hardware counters read around its timed repetitions, so cache misses and
+ * branch mispredictions per operation are reported next to the time.
+ */
+class Bench {
+public:
+    int warmup;        /**< The number of untimed repetitions. */
+    int repetitions;   /**< The number of timed repetitions. */
+    double target_ms;  /**< The shortest repetition the batch size is grown to. */
+    const PerfCounters* perf; /**< The hardware counters, `NULL` for none. */
+    std::vector<BenchResult> results; /**< The results, in the order the benchmarks ran. */
+
+    /**
+     * @brief Constructor that sets the repetition counts.
+     * @param w The number of warmup repetitions.
+     * @param r The number of timed repetitions.
+     * @param t The target time of a repetition in milliseconds.
+     */
+    Bench(int w = 2, int r = 10, double t = 5) : warmup(w), repetitions(r), target_ms(t), perf(NULL) {}
+
+    /**
+     * @brief Runs one benchmark and records its result.
+     * @param c The benchmark.
+     * @return The result.
+     */
+    const BenchResult& run(const BenchCase& c) {
+        int batch = 1;
+        double ms = time(c, batch);
+        while (ms < target_ms && (c.max_batch <= 0 || batch < c.max_batch)) {
+            batch *= 2;
+            if (c.max_batch > 0) batch = std::min(batch, c.max_batch);
+            ms = time(c, batch);
+        }
+        for (int i = 0; i < warmup; i++) {
+            time(c, batch);
+        }
+        BenchResult r;
+        r.perf.name = c.name;
+        std::vector<double> ns(repetitions);
+        for (int i = 0; i < repetitions; i++) {
+            ns[i] = time(c, batch, &r.perf) * 1e6 / batch;
+        }
+        std::sort(ns.begin(), ns.end());
+        r.name = c.name;
+        r.batch = batch;
+        r.repetitions = repetitions;
+        r.min_ns = ns.empty() ? 0 : ns.front();
+        r.median_ns = ns.empty() ? 0 : ns[ns.size() / 2];
+        r.mean_ns = 0;
+        for (double v : ns) r.mean_ns += v;
+        r.mean_ns /= std::max<size_t>(ns.size(), 1);
+        r.stddev_ns = 0;
+        for (double v : ns) r.stddev_ns += (v - r.mean_ns) * (v - r.mean_ns);
+        r.stddev_ns = sqrt(r.stddev_ns / std::max<size_t>(ns.size(), 1));
+        results.push_back(r);
+        return results.back();
+    }
+
+    /**
+     * @brief Prints the results as a table.
+     * @param out The stream to print to.
+     */
+    void print(FILE* out) const {
+        fprintf(out, "%-28s %10s %14s %14s %14s %8s\n", "benchmark", "batch", "min ns/op", "median ns/op",
+                "mean ns/op", "stddev");
+        for (const BenchResult& r : results) {
+            fprintf(out, "%-28s %10d %14.1f %14.1f %14.1f %7.1f%%\n", r.name.c_str(), r.batch, r.min_ns,
+                    r.median_ns, r.mean_ns, r.mean_ns > 0 ? 100 * r.stddev_ns / r.mean_ns : 0.0);
+        }
+        if (!perf || !perf->available()) return;
+        fprintf(out, "\n%-28s", "benchmark");
+        for (int e = 0; e < PERF_EVENTS; e++) {
+            fprintf(out, " %14s", PerfCounters::name((PerfEvent) e));
+        }
+        fprintf(out, " %8s\n", "IPC");
+        for (const BenchResult& r : results) {
+            fprintf(out, "%-28s", r.name.c_str());
+            for (int e = 0; e < PERF_EVENTS; e++) {
+                if (perf->available((PerfEvent) e)) fprintf(out, " %14.1f", per_op(r, (PerfEvent) e));
+                else fprintf(out, " %14s", "-");
+            }
+            double cycles = per_op(r, PERF_CYCLES);
+            fprintf(out, " %8.2f\n", cycles > 0 ? per_op(r, PERF_INSTRUCTIONS) / cycles : 0.0);
+        }
+    }
+
+    /**
+     * @brief Writes the results as JSON, one benchmark per line so runs diff cleanly.
+     * @param out The stream to write to.
+     * @param context The name of what was measured, such as the instance file.
+     */
+    void write_json(FILE* out, const std::string& context) const {
+        fprintf(out, "{\n  \"context\": %s,\n  \"warmup\": %d,\n  \"repetitions\": %d,\n  \"benchmarks\": [",
+                json_quote(context).c_str(), warmup, repetitions);
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            fprintf(out, "%s\n    {\"name\": %s, \"batch\": %d, \"min_ns\": %.1f, \"median_ns\": %.1f, "
+                    "\"mean_ns\": %.1f, \"stddev_ns\": %.1f", i ? "," : "", json_quote(r.name).c_str(), r.batch,
+                    r.min_ns, r.median_ns, r.mean_ns, r.stddev_ns);
+            //! Events that could not be counted are left out rather than reported as 0
+            for (int e = 0; perf && e < PERF_EVENTS; e++) {
+                if (perf->available((PerfEvent) e)) {
+                    fprintf(out, ", \"%s\": %.1f", PerfCounters::name((PerfEvent) e), per_op(r, (PerfEvent) e));
+                }
+            }
+            fprintf(out, "}");
+        }
+        fprintf(out, "\n  ]\n}\n");
+    }
+
+private:
+    /**
+     * @brief Gets the mean count of an event per operation.
+     * @param r The result.
+     * @param e The event.
+     * @return The count per operation.
+     */
+    static double per_op(const BenchResult& r, PerfEvent e) {
+        uint64_t ops = r.perf.calls * (uint64_t) r.batch;
+        return ops ? (double) r.perf.total.counts[e] / ops : 0;
+    }
+
+    /**
+     * @brief Times one repetition.
+     * @param c The benchmark.
+     * @param n The number of operations.
+     * @param region The region the hardware counts are added to, `NULL` for an untimed repetition.
+     * @return The time of the operations in milliseconds.
+     */
+    double time(const BenchCase& c, int n, PerfRegion* region = NULL) const {
+        if (c.setup) c.setup(n);
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        if (region) {
+            PerfScope scope(perf, *region);
+            for (int i = 0; i < n; i++) {
+                c.op(i);
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                c.op(i);
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (c.teardown) c.teardown();
+        return ms;
+    }
+};
+
+#endif /* BENCH_H */
@@ -0,0 +1,134 @@
+#ifndef BINARY_INSTANCE_H
+#define BINARY_INSTANCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Header of a precomputed binary instance file.
+ *
+ * The header is followed by `words` native 32-bit integers. `checksum` is the FNV-1a
+ * hash of those integers, so a truncated or corrupted file is rejected on load.
+ */
+struct BinaryInstanceHeader {
+    char magic[4];     /**< The file signature, `BINARY_INSTANCE_MAGIC`. */
+    uint32_t version;  /**< The layout version, `BINARY_INSTANCE_VERSION`. */
+    uint32_t words;    /**< The number of 32-bit words after the header. */
+    uint32_t reserved; /**< Reserved, written as zero. */
+    uint64_t checksum; /**< The FNV-1a hash of the payload. */
+};
+
+const char BINARY_INSTANCE_MAGIC[4] = {'P', 'S', 'O', 'B'}; /**< The file signature. */
+const uint32_t BINARY_INSTANCE_VERSION = 1;                /**< The current layout version. */
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of a buffer.
+ * @param data The buffer.
+ * @param size The size of the buffer in bytes.
+ * @return The hash.
+ */
+uint64_t fnv1a_64(const void* data, size_t size);
+
+/**
+ * @brief Checks whether a file starts with the binary instance signature.
+ * @param file The path to the file.
+ * @return `true` if the file is a binary instance.
+ */
+bool is_binary_instance(const char* file);
+
+/**
+ * @brief Collects the payload of a binary instance and writes it out.
+ */
+class BinaryInstanceWriter {
+private:
+    std::vector<int32_t> words; /**< The payload. */
+
+public:
+    /**
+     * @brief Appends one value.
+     * @param v The value.
+     */
+    inline void put(int v) {
+        words.push_back(v);
+    }
+
+    /**
+     * @brief Appends a length-prefixed array.
+     * @param v The values.
+     */
+    void put(const std::vector<int>& v);
+
+    /**
+     * @brief Writes the header and the payload to a file.
+     * @param file The path to the output file.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void save(const char* file) const;
+};
+
+/**
+ * @brief Maps a binary instance and hands out its payload without parsing.
+ *
+ * The header, version, size and checksum are verified in the constructor.
+ */
+class BinaryInstanceReader {
+private:
+    std::string file;    /**< The path of the file, for error messages. */
+    void* map;           /**< The mapping. */
+    size_t length;       /**< The length of the mapping. */
+    const int32_t* ptr;  /**< The next word. */
+    const int32_t* end;  /**< One past the last word. */
+
+public:
+    /**
+     * @brief Constructor that maps and verifies a binary instance.
+     * @param path The path to the file.
+     * @throws std::runtime_error If the file is missing, truncated or corrupted.
+     */
+    explicit BinaryInstanceReader(const char* path);
+
+    /**
+     * @brief Destructor that unmaps the file.
+     */
+    ~BinaryInstanceReader();
+
+    /**
+     * @brief Reads one value.
+     * @return The value.
+     */
+    int next();
+
+    /**
+     * @brief Reads a length-prefixed array in place.
+     * @param size Receives the number of values.
+     * @return A pointer to the values inside the mapping.
+     */
+    const int32_t* next_array(int& size);
+
+    /**
+     * @brief Reads a length-prefixed array into a vector.
+     * @param v The vector to fill.
+     */
+    void next_array(std::vector<int>& v);
+
+    /**
+     * @brief Gets the position of the next word.
+     * @return The offset in bytes from the start of the file.
+     */
+    inline size_t offset() const {
+        return reinterpret_cast<const char*>(ptr) - static_cast<const char*>(map);
+    }
+
+    /**
+     * @brief Throws an error for a value of the payload.
+     * @param message The description of the problem.
+     * @param at The offset of the value in bytes, as given by `offset()`.
+     * @throws std::runtime_error Always, naming the file and the offset.
+     */
+    void fail(const std::string& message, size_t at) const;
+};
+
+#endif /* BINARY_INSTANCE_H */
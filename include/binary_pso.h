@@ -0,0 +1,727 @@
+#ifndef BINARY_PSO_H
+#define BINARY_PSO_H
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "function.h"
+#include "instrument.h"
+#include "packed_swarm.h"
+#include "pareto_archive.h"
+#include "surrogate.h"
+#include "trace_recorder.h"
+
+/**
+ * @brief Represents a fitness function over a bit string.
+ *
+ * An objective is used by one run at a time. Objectives that keep no state between
+ * evaluations may be shared by several threads.
+ */
+class Objective {
+public:
+    /**
+     * @brief Destructor.
+     */
+    virtual ~Objective() {}
+
+    /**
+     * @brief Gets the number of bits of a solution.
+     * @return The number of bits.
+     */
+    virtual int Size() const = 0;
+
+    /**
+     * @brief Evaluates a solution.
+     * @param x The bits of the solution, `Size()` bytes holding 0 or 1.
+     * @return The fitness value, lower is better.
+     */
+    virtual double Evaluate(char* x) = 0;
+
+    /**
+     * @brief Evaluates a solution unless it cannot beat a cutoff.
+     *
+     * Objectives that can bound their value part way through override this to stop
+     * early. The default evaluates the whole solution.
+     *
+     * @param x The bits of the solution.
+     * @param cutoff The value to beat.
+     * @return The fitness value if below `cutoff`, otherwise a lower bound of at least `cutoff`.
+     */
+    virtual double EvaluateBounded(char* x, double cutoff) {
+        (void) cutoff;
+        return Evaluate(x);
+    }
+
+    /**
+     * @brief Scores a solution cheaply from below.
+     *
+     * Objectives with a relaxation much cheaper than the exact evaluation override this.
+     * The default evaluates the whole solution.
+     *
+     * @param x The bits of the solution.
+     * @return A lower bound of the fitness value.
+     */
+    virtual double EvaluateRelaxed(char* x) {
+        return Evaluate(x);
+    }
+
+    /**
+     * @brief Tells whether `EvaluateRelaxed()` is cheaper than `Evaluate()`.
+     * @return `false` unless overridden together with `EvaluateRelaxed()`.
+     */
+    virtual bool Relaxes() const {
+        return false;
+    }
+
+    /**
+     * @brief Gets a key shared by solutions the objective cannot tell apart.
+     *
+     * Objectives whose decoding ignores some bits override this, so that solutions that
+     * decode to the same thing share a key. The default hashes the bits.
+     *
+     * @param x The bits of the solution.
+     * @return The key.
+     */
+    virtual uint64_t Key(char* x) {
+        std::vector<uint64_t> w((Size() + 63) / 64);
+        PackedSwarm::pack(x, Size(), w.data());
+        return PackedSwarm::hash(w.data(), w.size());
+    }
+
+    /**
+     * @brief Gets the number of objectives `EvaluateVector()` fills.
+     * @return The number of objectives, 1 unless overridden.
+     */
+    virtual int Objectives() const {
+        return 1;
+    }
+
+    /**
+     * @brief Evaluates a solution on every objective.
+     *
+     * Objectives that can tell apart things the fitness value folds together override
+     * this with `Objectives()`. The default only fills the fitness value.
+     *
+     * @param x The bits of the solution.
+     * @param f Receives the `Objectives()` objectives, lower is better, the first being the fitness value.
+     * @return The fitness value, `f[0]`.
+     */
+    virtual double EvaluateVector(char* x, double* f) {
+        return f[0] = Evaluate(x);
+    }
+};
+
+/**
+ * @brief Lists the ways the inertia weight changes over a run.
+ */
+enum InertiaSchedule {
+    INERTIA_CONSTANT, /**< WEIGHT throughout. */
+    INERTIA_LINEAR,   /**< From WEIGHT at the first iteration to WEIGHTEND at the last. */
+    INERTIA_ADAPTIVE  /**< Between WEIGHTEND and WEIGHT by the fraction of particles that improved. */
+};
+
+/**
+ * @brief Lists what makes two particles duplicates of each other.
+ */
+enum DuplicateCheck {
+    DEDUP_OFF,    /**< No check. */
+    DEDUP_BITS,   /**< The same bits. */
+    DEDUP_DECODED /**< The same `Objective::Key()`. */
+};
+
+/**
+ * @brief Represents the parameters of a binary PSO run.
+ */
+struct BinaryPSOParams {
+    int popsize;    /**< The number of particles. */
+    int iterations; /**< The number of iterations of a restart. */
+    int restarts;   /**< The number of restarts of an instance. */
+    double weight;  /**< The inertia weight. */
+    double c1;      /**< The cognitive parameter. */
+    double c2;      /**< The social parameter. */
+    double vmax;    /**< The velocity clamp. */
+    bool bounded;   /**< Whether an evaluation may stop once it cannot change the search. */
+    int method;     /**< The optimizer, see `OptimizerMethod` in optimizers.h. */
+    double temp;    /**< The hottest annealing temperature, as a fraction of the initial fitness. */
+    int replicas;   /**< The number of annealing replicas at different temperatures. */
+    int tenure;     /**< The number of iterations a flipped bit stays tabu, 0 to derive it from the size. */
+    int neighbors;  /**< The number of flips a tabu iteration tries, 0 for `popsize`. */
+    double screen;  /**< The fraction of moved particles the PSO evaluates exactly, 0 to evaluate all. */
+    double fidelity; /**< The fraction of moved particles evaluated exactly after a relaxed score, 0 for no relaxed scores. */
+    int inertia;    /**< How the inertia weight changes, see `InertiaSchedule`. */
+    double weight_end; /**< The lowest inertia weight of a changing schedule. */
+    int min_pop;    /**< The fewest particles duplicate retirement may leave, 0 to never retire. */
+    int dedup;      /**< Which particles share one evaluation in an iteration, see `DuplicateCheck`. */
+    bool reseed;    /**< Whether a duplicate moves to a random position instead of sharing the evaluation. */
+    double min_div; /**< The diversity below which a restart ends early, 0 to run every iteration. */
+    int pareto;     /**< The most points of the Pareto front a PSO run keeps, 0 for none. */
+
+    /**
+     * @brief Constructor that reads the parameters from `config.txt` entries.
+     *
+     * Uses the keys POPSIZE, ITERATION, WEIGHT, C1, C2 and VMAX of the drivers, plus
+     * RESTARTS which defaults to the 10 restarts the drivers run and BOUNDED which
+     * defaults to 1. METHOD picks the optimizer (0 PSO, 1 annealing, 2 tabu search);
+     * TEMP, REPLICAS, TENURE and NEIGHBORS tune the other two. Every method gets the
+     * POPSIZE times ITERATION evaluations of a PSO restart. SCREEN (default 0, off) is the
+     * fraction of particles per PSO iteration evaluated exactly after a surrogate ranks them.
+     * FIDELITY (default 0, off) does the same after ranking by `Objective::EvaluateRelaxed()`
+     * and takes the place of SCREEN when both are set; it is ignored for an objective that
+     * `Relaxes()` nothing, which would only be evaluated twice. INERTIA (default 0, constant) makes
+     * the weight fall from WEIGHT to WEIGHTEND (default 0.4), linearly (1) or with the success
+     * rate of the swarm (2). MINPOP (default 0, off) lets the swarm retire particles that
+     * duplicate another one down to that many. DEDUP (default 0, off) lets a particle reuse
+     * the evaluation of an earlier particle of the iteration with the same bits (1) or the
+     * same decoded solution (2); with RESEED 1 the duplicate jumps to a random position
+     * instead. MINDIV (default 0, off) ends a restart once the diversity falls below it.
+     * PARETO (default 0, off) makes a PSO run keep a front of up to that many solutions
+     * non-dominated on every objective of `Objective::EvaluateVector()`; its evaluations then
+     * always run in full, whatever BOUNDED says.
+     *
+     * @param configs The entries read by `read_configs()`.
+     */
+    BinaryPSOParams(std::map<std::string, double>& configs) {
+        popsize = (int) configs["POPSIZE"];
+        iterations = (int) configs["ITERATION"];
+        restarts = configs.count("RESTARTS") ? (int) configs["RESTARTS"] : 10;
+        weight = configs["WEIGHT"];
+        c1 = configs["C1"];
+        c2 = configs["C2"];
+        vmax = configs["VMAX"];
+        bounded = configs.count("BOUNDED") ? configs["BOUNDED"] != 0 : true;
+        method = configs.count("METHOD") ? (int) configs["METHOD"] : 0;
+        temp = configs.count("TEMP") ? configs["TEMP"] : 0.05;
+        replicas = configs.count("REPLICAS") ? (int) configs["REPLICAS"] : 4;
+        tenure = configs.count("TENURE") ? (int) configs["TENURE"] : 0;
+        neighbors = configs.count("NEIGHBORS") ? (int) configs["NEIGHBORS"] : 0;
+        screen = configs.count("SCREEN") ? configs["SCREEN"] : 0;
+        fidelity = configs.count("FIDELITY") ? configs["FIDELITY"] : 0;
+        inertia = configs.count("INERTIA") ? (int) configs["INERTIA"] : INERTIA_CONSTANT;
+        weight_end = configs.count("WEIGHTEND") ? configs["WEIGHTEND"] : 0.4;
+        min_pop = configs.count("MINPOP") ? (int) configs["MINPOP"] : 0;
+        dedup = configs.count("DEDUP") ? (int) configs["DEDUP"] : DEDUP_OFF;
+        reseed = configs.count("RESEED") ? configs["RESEED"] != 0 : false;
+        min_div = configs.count("MINDIV") ? configs["MINDIV"] : 0;
+        pareto = configs.count("PARETO") ? (int) configs["PARETO"] : 0;
+    }
+};
+
+/**
+ * @brief Represents an improvement of the best fitness during a run.
+ */
+struct BinaryPSOProgress {
+    double seconds;        /**< The wall time since the start of the run. */
+    long long evaluations; /**< The number of evaluations since the start of the run. */
+    double best;           /**< The new best fitness. */
+};
+
+/**
+ * @brief Represents the outcome of one binary PSO restart.
+ */
+struct BinaryPSOResult {
+    double best;             /**< The best fitness found. */
+    double mean_pbest;       /**< The mean of the personal bests at the end of the run. */
+    long long evaluations;   /**< The number of fitness evaluations. */
+    long long screened;      /**< The evaluations the surrogate or the relaxed scores saved. */
+    long long relaxed;       /**< The number of relaxed scores. */
+    int retired;             /**< The particles retired as duplicates. */
+    long long duplicates;    /**< The evaluations saved by reusing the one of a duplicate. */
+    long long reseeded;      /**< The duplicates moved to a random position. */
+    double key_seconds;      /**< The wall time spent on `Objective::Key()`, which `DEDUP 2` calls once per particle. */
+    double diversity;        /**< The mean fraction of bits in which two particles differ at the end of the run. */
+    double relaxed_gap;      /**< The mean of (exact - relaxed) / exact over the particles scored both ways. */
+    double seconds;          /**< The wall time of the run. */
+    std::vector<char> xbest; /**< The best solution found. */
+    std::vector<std::vector<char> > swarm; /**< The personal bests at the end of the run, to warm-start another. */
+    std::vector<BinaryPSOProgress> history; /**< The initial best and every improvement, in order. */
+    std::vector<ParetoPoint> front; /**< The solutions of the run non-dominated on every objective, with PARETO. */
+};
+
+/**
+ * @brief Represents a search over bit strings that the drivers can run.
+ *
+ * Every optimizer reports through `BinaryPSOResult`, so drivers compare methods on the
+ * same best fitness, evaluation count, wall time and improvement history.
+ */
+class Optimizer {
+public:
+    TraceRecorder* trace;   /**< Where the convergence trace goes, `NULL` for none. */
+    TraceRecord tag;        /**< The run, restart and island written with the trace. */
+    std::vector<std::vector<char> > start; /**< Solutions the next runs start from instead of random ones. */
+
+    /**
+     * @brief Constructor without a trace.
+     */
+    Optimizer() : trace(NULL) {
+        memset(&tag, 0, sizeof tag);
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~Optimizer() {}
+
+    /**
+     * @brief Records a convergence trace of the next runs.
+     * @param t The recorder, not owned, or `NULL` to stop tracing.
+     * @param run The run written with each record.
+     * @param restart The restart written with each record.
+     * @param island The island written with each record.
+     */
+    void Trace(TraceRecorder* t, int run, int restart, int island = 0) {
+        trace = t;
+        tag.run = run;
+        tag.restart = restart;
+        tag.island = island;
+    }
+
+    /**
+     * @brief Runs one restart.
+     * @param f The objective to minimize.
+     * @return The outcome of the run.
+     */
+    virtual BinaryPSOResult Run(Objective& f) = 0;
+
+protected:
+    /**
+     * @brief Replaces the first random solutions by the given starting ones.
+     * @param x The random solutions.
+     * @throws std::runtime_error If a starting solution does not have the size of the objective.
+     */
+    void Start(std::vector<std::vector<char> >& x) const {
+        for (size_t i = 0; i < start.size() && i < x.size(); i++) {
+            if (start[i].size() != x[i].size()) {
+                throw std::runtime_error("start solution of " + std::to_string(start[i].size()) + " bits, expected "
+                        + std::to_string(x[i].size()));
+            }
+            x[i] = start[i];
+        }
+    }
+};
+
+/**
+ * @brief Represents one restart of the binary PSO used by the drivers.
+ *
+ * This is the loop of `test_1` to `test_4` taken out of `main()`: the same velocity
+ * update, clamp and flip rule, but with its own random generator instead of `rand()`, so
+ * that any number of runs can go on at the same time and a seed reproduces a run.
+ */
+class BinaryPSO : public Optimizer {
+public:
+    BinaryPSOParams params; /**< The parameters of the run. */
+    std::mt19937 rng;       /**< The random generator of the run. */
+    double weight;          /**< The inertia weight `Move()` uses. */
+
+    /**
+     * @brief Constructor that sets the parameters and the seed.
+     * @param p The parameters.
+     * @param seed The seed of the random generator.
+     */
+    BinaryPSO(const BinaryPSOParams& p, unsigned seed) : params(p), rng(seed), weight(p.weight) {}
+
+    /**
+     * @brief Draws a number uniformly from [0, 1].
+     * @return The number.
+     */
+    double Uniform() {
+        return (double) rng() / rng.max();
+    }
+
+    /**
+     * @brief Records a new best fitness in the history of a run.
+     * @param res The outcome of the run so far.
+     * @param t0 The start of the run.
+     * @param best The new best fitness.
+     */
+    static void Improved(BinaryPSOResult& res, std::chrono::steady_clock::time_point t0, double best) {
+        BinaryPSOProgress p;
+        p.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        p.evaluations = res.evaluations;
+        p.best = best;
+        res.history.push_back(p);
+    }
+
+    /**
+     * @brief Sends the state of the swarm after an iteration to the trace.
+     *
+     * The dispersion is the mean fraction of bits differing from the global best, the
+     * binary form of `Swarm::EvalDispersion`, and the velocity index is the mean absolute
+     * velocity as in `Swarm::EvalVelIndex`. The diversity and the unique positions come from
+     * the packed positions. In a bounded run the fitness of a particle stopped early is the
+     * lower bound it returned.
+     */
+    void Record(int iter, std::chrono::steady_clock::time_point t0, const BinaryPSOResult& res, double gbest,
+            const std::vector<double>& fx, const std::vector<double>& pbest,
+            const PackedSwarm& packed, double diversity, const std::vector<std::vector<double> >& vel) {
+        TraceRecord r = tag;
+        int popsize = fx.size();
+        int n = res.xbest.size();
+        r.iteration = iter;
+        r.gbest = gbest;
+        r.mean_pbest = r.avg_obj = 0;
+        r.min_obj = r.max_obj = fx[0];
+        for (int i = 0; i < popsize; i++) {
+            r.mean_pbest += pbest[i];
+            r.avg_obj += fx[i];
+            r.min_obj = std::min(r.min_obj, fx[i]);
+            r.max_obj = std::max(r.max_obj, fx[i]);
+        }
+        r.mean_pbest /= popsize;
+        r.avg_obj /= popsize;
+        double speed = 0;
+        for (int i = 0; i < popsize; i++) {
+            for (int j = 0; j < n; j++) speed += fabs(vel[i][j]);
+        }
+        r.dispersion = packed.dispersion(res.xbest.data());
+        r.vel_index = n ? speed / popsize / n : 0;
+        r.diversity = diversity;
+        r.unique = packed.unique();
+        r.evaluations = res.evaluations;
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        trace->record(r);
+    }
+
+    /**
+     * @brief Evaluates one solution and counts the evaluation.
+     * @param f The objective.
+     * @param x The bits of the solution.
+     * @param res The outcome of the run so far.
+     * @return The fitness value.
+     */
+    static double Evaluate(Objective& f, char* x, BinaryPSOResult& res) {
+        PSO_COUNT(COUNT_EVALUATION);
+        PSO_TIME(TIME_EVALUATION);
+        res.evaluations++;
+        return f.Evaluate(x);
+    }
+
+    /**
+     * @brief Evaluates one solution against a cutoff and counts the evaluation.
+     * @param f The objective.
+     * @param x The bits of the solution.
+     * @param cutoff The value to beat.
+     * @param res The outcome of the run so far.
+     * @return The fitness value if below `cutoff`, otherwise a lower bound of at least `cutoff`.
+     */
+    static double Evaluate(Objective& f, char* x, double cutoff, BinaryPSOResult& res) {
+        PSO_COUNT(COUNT_EVALUATION);
+        PSO_TIME(TIME_EVALUATION);
+        res.evaluations++;
+        return f.EvaluateBounded(x, cutoff);
+    }
+
+    /**
+     * @brief Evaluates one solution on every objective, offers it to a front and counts the evaluation.
+     * @param f The objective.
+     * @param x The bits of the solution.
+     * @param res The outcome of the run so far.
+     * @param front The front.
+     * @return The fitness value.
+     */
+    static double Evaluate(Objective& f, char* x, BinaryPSOResult& res, ParetoArchive& front) {
+        PSO_COUNT(COUNT_EVALUATION);
+        PSO_TIME(TIME_EVALUATION);
+        res.evaluations++;
+        std::vector<double> obj(front.objectives());
+        double y = f.EvaluateVector(x, obj.data());
+        front.insert(obj.data(), x, f.Size());
+        return y;
+    }
+
+    /**
+     * @brief Scores one solution from below and counts the relaxed score.
+     * @param f The objective.
+     * @param x The bits of the solution.
+     * @param res The outcome of the run so far.
+     * @return A lower bound of the fitness value.
+     */
+    static double Relaxed(Objective& f, char* x, BinaryPSOResult& res) {
+        PSO_COUNT(COUNT_RELAXED);
+        res.relaxed++;
+        return f.EvaluateRelaxed(x);
+    }
+
+    /**
+     * @brief Updates the velocities of one particle and flips its bits.
+     * @param n The number of bits.
+     * @param x The bits of the particle.
+     * @param xpbest The personal best of the particle.
+     * @param xbest The global best.
+     * @param vel The velocity of each bit.
+     * @param one_vel The velocity of each bit towards 1.
+     * @param zero_vel The velocity of each bit towards 0.
+     * @param c3 The cognitive pull of this iteration.
+     * @param dd3 The social pull of this iteration.
+     */
+    void Move(int n, char* x, const char* xpbest, const char* xbest, double* vel,
+            double* one_vel, double* zero_vel, double c3, double dd3) {
+        PSO_TIME(TIME_MOVE);
+        for (int j = 0; j < n; j++) {
+            double oneadd = xpbest[j] ? c3 : -c3;
+            oneadd += xbest[j] ? dd3 : -dd3;
+            double zeroadd = -oneadd;
+            one_vel[j] = (weight * one_vel[j]) + oneadd;
+            zero_vel[j] = (weight * zero_vel[j]) + zeroadd;
+            if (fabs(vel[j]) > params.vmax) {
+                zero_vel[j] = params.vmax * sign(zero_vel[j]);
+                one_vel[j] = params.vmax * sign(one_vel[j]);
+            }
+            vel[j] = (x[j] == 1) ? zero_vel[j] : one_vel[j];
+            if (Uniform() < logsig(vel[j])) {
+                x[j] = !x[j];
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the inertia weight of an iteration.
+     * @param iter The iteration, from 1.
+     * @param success The fraction of particles that improved their personal best in it.
+     * @return The weight.
+     */
+    double Inertia(int iter, double success) const {
+        switch (params.inertia) {
+        case INERTIA_LINEAR:
+            return params.weight + (params.weight_end - params.weight) * (iter - 1) / std::max(1, params.iterations - 1);
+        case INERTIA_ADAPTIVE:
+            return params.weight_end + (params.weight - params.weight_end) * success;
+        default:
+            return params.weight;
+        }
+    }
+
+    /**
+     * @brief Finds the particles whose position and personal best both repeat an earlier particle's.
+     *
+     * Such a particle only differs from the earlier one by its velocities, so once the
+     * swarm has converged its evaluations add little.
+     *
+     * @param x The positions.
+     * @param xpbest The personal bests.
+     * @param dup Receives the duplicates, in increasing order.
+     */
+    static void Duplicates(const std::vector<std::vector<char> >& x, const std::vector<std::vector<char> >& xpbest,
+            std::vector<int>& dup) {
+        dup.clear();
+        std::map<std::pair<size_t, size_t>, std::vector<int> > seen;
+        std::hash<std::string> hash;
+        for (size_t i = 0; i < x.size(); i++) {
+            std::pair<size_t, size_t> key(hash(std::string(x[i].begin(), x[i].end())),
+                    hash(std::string(xpbest[i].begin(), xpbest[i].end())));
+            std::vector<int>& same = seen[key];
+            bool repeat = false;
+            for (int k : same) repeat = repeat || (x[k] == x[i] && xpbest[k] == xpbest[i]);
+            if (repeat) dup.push_back(i);
+            else same.push_back(i);
+        }
+    }
+
+    /**
+     * @brief Runs one restart.
+     * @param f The objective to minimize.
+     * @return The outcome of the run.
+     */
+    BinaryPSOResult Run(Objective& f) {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        int n = f.Size();
+        int popsize = params.popsize;
+        std::vector<std::vector<char> > x(popsize, std::vector<char>(n));
+        std::vector<std::vector<char> > xpbest(popsize, std::vector<char>(n));
+        std::vector<std::vector<double> > vel(popsize, std::vector<double>(n));
+        std::vector<std::vector<double> > one_vel(popsize, std::vector<double>(n));
+        std::vector<std::vector<double> > zero_vel(popsize, std::vector<double>(n));
+        std::vector<double> fx(popsize), pbest(popsize);
+        BinaryPSOResult res;
+        res.evaluations = res.screened = res.relaxed = 0;
+        res.retired = 0;
+        res.duplicates = res.reseeded = 0;
+        res.key_seconds = 0;
+        res.relaxed_gap = 0;
+        res.xbest.resize(n);
+        weight = params.weight;
+        double success = 1;
+        std::vector<int> dup;
+        bool tiered = params.fidelity > 0 && params.fidelity < 1 && f.Relaxes();
+        //! The surrogate remembers the last few iterations of the swarm
+        Surrogate* model = !tiered && params.screen > 0 && params.screen < 1 ? new Surrogate(n, 4 * popsize) : NULL;
+        std::vector<std::pair<double, int> > ranked;
+        long long compared = 0;
+        PackedSwarm packed(n);
+        //! The key of each particle, and the fitness of each key evaluated in the iteration
+        //! with whether it is exact or a lower bound
+        std::vector<uint64_t> keys(popsize);
+        std::unordered_map<uint64_t, std::pair<double, bool> > known;
+        //! A solution beaten on the fitness may still be on the front, so the front needs full evaluations
+        ParetoArchive* front = params.pareto > 0 ? new ParetoArchive(f.Objectives(), params.pareto) : NULL;
+        bool bounded = params.bounded && !front;
+
+        for (int i = 0; i < popsize; i++) {
+            for (int j = 0; j < n; j++) {
+                xpbest[i][j] = x[i][j] = rng() % 2;
+                vel[i][j] = Uniform() - 0.5;
+                one_vel[i][j] = Uniform() - 0.5;
+                zero_vel[i][j] = Uniform() - 0.5;
+            }
+        }
+        Start(x);
+        xpbest = x;
+        for (int i = 0; i < popsize; i++) {
+            pbest[i] = fx[i] = front ? Evaluate(f, x[i].data(), res, *front) : Evaluate(f, x[i].data(), res);
+            if (model) model->add(x[i].data(), fx[i]);
+        }
+
+        int l;
+        double gbest, gg;
+        minimum(l, gbest, popsize, fx.data());
+        res.xbest = x[l];
+        Improved(res, t0, gbest);
+        packed.assign(x);
+        res.diversity = packed.diversity();
+        if (trace) Record(1, t0, res, gbest, fx, pbest, packed, res.diversity, vel);
+
+        for (int iter = 1; iter <= params.iterations; iter++) {
+            //! The first iteration would only score the initial swarm again
+            if (iter > 1) {
+                //! A particle that cannot beat its personal best changes neither best, so its
+                //! evaluation may stop at any lower bound not below pbest
+                //! With a surrogate or relaxed scores only the particles ranked best are evaluated;
+                //! the others keep their personal best as fitness, so they change neither best. A
+                //! bounded evaluation teaches the surrogate its lower bound, which still ranks it
+                //! behind pbest
+                int exact = popsize, evaluated = 0, improved = 0;
+                packed.assign(x);
+                if (params.dedup != DEDUP_OFF) {
+                    std::chrono::steady_clock::time_point k0 = std::chrono::steady_clock::now();
+                    std::unordered_map<uint64_t, int> first;
+                    for (int i = 0; i < popsize; i++) {
+                        keys[i] = params.dedup == DEDUP_DECODED ? f.Key(x[i].data()) : packed.hash(i);
+                        //! With RESEED a duplicate of an earlier particle jumps to a random position
+                        if (params.reseed && !first.insert(std::make_pair(keys[i], i)).second) {
+                            for (int j = 0; j < n; j++) x[i][j] = rng() % 2;
+                            PackedSwarm::pack(x[i].data(), n, packed.row(i));
+                            keys[i] = params.dedup == DEDUP_DECODED ? f.Key(x[i].data()) : packed.hash(i);
+                            res.reseeded++;
+                        }
+                    }
+                    if (params.dedup == DEDUP_DECODED) {
+                        res.key_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - k0).count();
+                    }
+                    known.clear();
+                }
+                ranked.clear();
+                for (int i = 0; i < popsize; i++) {
+                    double key = tiered ? Relaxed(f, x[i].data(), res) : model ? model->predict(x[i].data()) : 0.0;
+                    ranked.push_back(std::make_pair(key, i));
+                }
+                if (tiered || model) {
+                    exact = std::max(1, (int) ceil((tiered ? params.fidelity : params.screen) * popsize));
+                    std::stable_sort(ranked.begin(), ranked.end());
+                }
+                for (int r = 0; r < popsize; r++) {
+                    int i = ranked[r].second;
+                    //! A relaxed score is a lower bound, so one not below pbest needs no exact score
+                    if (evaluated >= exact || (tiered && ranked[r].first >= pbest[i])) {
+                        fx[i] = std::max(ranked[r].first, pbest[i]);
+                        res.screened++;
+                        continue;
+                    }
+                    //! A duplicate reuses an exact fitness, or a lower bound that already rules it out
+                    std::unordered_map<uint64_t, std::pair<double, bool> >::iterator same =
+                            params.dedup != DEDUP_OFF ? known.find(keys[i]) : known.end();
+                    if (same != known.end() && (same->second.second || same->second.first >= pbest[i])) {
+                        fx[i] = same->second.first;
+                        res.duplicates++;
+                    } else {
+                        evaluated++;
+                        fx[i] = front ? Evaluate(f, x[i].data(), res, *front)
+                                : bounded ? Evaluate(f, x[i].data(), pbest[i], res) : Evaluate(f, x[i].data(), res);
+                        if (model) model->add(x[i].data(), fx[i]);
+                        if (tiered && (!bounded || fx[i] < pbest[i]) && fx[i] > 0) {
+                            res.relaxed_gap += (fx[i] - ranked[r].first) / fx[i];
+                            compared++;
+                        }
+                        if (params.dedup != DEDUP_OFF) {
+                            known[keys[i]] = std::make_pair(fx[i], !bounded || fx[i] < pbest[i]);
+                        }
+                    }
+                    if (fx[i] < pbest[i]) {
+                        pbest[i] = fx[i];
+                        xpbest[i] = x[i];
+                        improved++;
+                    }
+                }
+                success = (double) improved / popsize;
+                minimum(l, gg, popsize, fx.data());
+                if (gbest > gg) {
+                    gbest = gg;
+                    res.xbest = x[l];
+                    Improved(res, t0, gbest);
+                }
+                res.diversity = packed.diversity();
+                if (trace) Record(iter, t0, res, gbest, fx, pbest, packed, res.diversity, vel);
+                //! A swarm that has collapsed onto a few positions is better spent on a new restart
+                if (res.diversity < params.min_div) break;
+
+                //! Duplicates are retired from the back, so the earlier copy of each stays
+                if (params.min_pop > 0 && popsize > params.min_pop) {
+                    Duplicates(x, xpbest, dup);
+                    for (int d = (int) dup.size() - 1; d >= 0 && popsize > params.min_pop; d--) {
+                        int i = dup[d], last = --popsize;
+                        x[i].swap(x[last]);
+                        xpbest[i].swap(xpbest[last]);
+                        vel[i].swap(vel[last]);
+                        one_vel[i].swap(one_vel[last]);
+                        zero_vel[i].swap(zero_vel[last]);
+                        std::swap(fx[i], fx[last]);
+                        std::swap(pbest[i], pbest[last]);
+                        res.retired++;
+                    }
+                    x.resize(popsize);
+                    xpbest.resize(popsize);
+                    vel.resize(popsize);
+                    one_vel.resize(popsize);
+                    zero_vel.resize(popsize);
+                    fx.resize(popsize);
+                    pbest.resize(popsize);
+                }
+            }
+
+            weight = Inertia(iter, success);
+            double c3 = params.c1 * Uniform();
+            double dd3 = params.c2 * Uniform();
+
+            for (int i = 0; i < popsize; i++) {
+                Move(n, x[i].data(), xpbest[i].data(), res.xbest.data(), vel[i].data(),
+                        one_vel[i].data(), zero_vel[i].data(), c3, dd3);
+            }
+        }
+
+        res.best = gbest;
+        res.mean_pbest = 0;
+        for (int i = 0; i < popsize; i++) {
+            res.mean_pbest += pbest[i];
+        }
+        res.mean_pbest /= popsize;
+        if (compared) res.relaxed_gap /= compared;
+        res.swarm = xpbest;
+        if (front) res.front = front->front();
+        delete front;
+        delete model;
+        res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return res;
+    }
+};
+
+#endif /* BINARY_PSO_H */
@@ -0,0 +1,145 @@
+#ifndef BRANCH_AND_BOUND_H
+#define BRANCH_AND_BOUND_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "all_model.h"
+
+/**
+ * @brief Represents the outcome of an exact search.
+ */
+struct BranchAndBoundResult {
+    double best;             /**< The best makespan found, or the initial upper bound if none beat it. */
+    std::vector<char> xbest; /**< A genome of the best makespan, empty if none beat the upper bound. */
+    bool optimal;            /**< Whether the whole tree was searched, so `best` is optimal. */
+    long long nodes;         /**< The number of prefixes simulated. */
+    long long pruned;        /**< The prefixes cut because their bound reached the best makespan. */
+    long long transpositions; /**< The prefixes cut because an equal or earlier state was already searched. */
+    double seconds;          /**< The wall time of the search. */
+};
+
+/**
+ * @brief Finds the optimal schedule of a small `All_Model` instance by depth-first branch and bound.
+ *
+ * The search runs over the same decisions the genome encodes: which reserved container,
+ * export or import each move takes and which slot it is dropped on. Every prefix is
+ * simulated on a clone, and cut when the makespan so far plus the bound on the moves left
+ * (see `All_Model::remaining_bound()`) cannot beat the best schedule found. Children are
+ * searched best bound first. The result is returned as a genome, so any evaluator of the
+ * model scores it the same.
+ *
+ * For the short-span crane alone the moves left cost the same whatever the time, so a
+ * state reached again no earlier than before is cut through a table shared by all
+ * threads. The long-span crane waits on the short-span timeline, so its states are only
+ * merged when reached at the same time below the same short-span schedule.
+ *
+ * The tree is split near the root into subtrees that a thread pool searches in parallel,
+ * sharing the best makespan found so far.
+ */
+class BranchAndBound {
+public:
+    All_Model* model;      /**< The master model, only read. */
+    bool joint;            /**< `true` for the joint genome of both cranes, `false` for the short-span genome. */
+    int threads;           /**< The number of threads. */
+    double upper;          /**< Only schedules below this makespan are sought. */
+    long long node_limit;  /**< Stops after this many prefixes, 0 for no limit. */
+    double time_limit;     /**< Stops after this many seconds, 0 for no limit. */
+    size_t table_size;     /**< The number of states the transposition table holds. */
+
+    /**
+     * @brief Constructor that sets the model and the search.
+     * @param m The master model, not owned.
+     * @param j `true` to search the joint genome as `JointObjective`, `false` for the short-span genome as `ShortSpanObjective`.
+     * @param t The number of threads.
+     */
+    BranchAndBound(All_Model* m, bool j = true, int t = 1);
+
+    /**
+     * @brief Runs the search.
+     * @return The outcome.
+     */
+    BranchAndBoundResult Run();
+
+private:
+    static const int SHARDS = 64; /**< The number of independently locked parts of the table. */
+
+    /**
+     * @brief Represents one independently locked part of the transposition table.
+     */
+    struct Shard {
+        std::mutex lock;                          /**< Guards the entries. */
+        std::unordered_map<uint64_t, double> min; /**< The earliest time each state was reached. */
+    };
+
+    /**
+     * @brief Represents a prefix waiting to be searched.
+     */
+    struct Node {
+        std::vector<char> x; /**< The genome, valid up to the prefix. */
+        MovePrefix p;        /**< The simulated prefix. */
+        int depth;           /**< The number of moves in the prefix. */
+    };
+
+    int size;                          /**< The size of the genome. */
+    std::chrono::steady_clock::time_point t0; /**< The start of the search. */
+    std::atomic<double> best;          /**< The best makespan found so far. */
+    std::atomic<long long> nodes;      /**< The number of prefixes simulated. */
+    std::atomic<long long> pruned;     /**< The prefixes cut by the bound. */
+    std::atomic<long long> merged;     /**< The prefixes cut by the table. */
+    std::atomic<bool> stopped;         /**< Set once a limit is reached. */
+    std::mutex best_lock;              /**< Guards `xbest`. */
+    std::vector<char> xbest;           /**< The genome of the best makespan. */
+    std::vector<Shard> table;          /**< The transposition table of the short-span crane. */
+
+    /**
+     * @brief Simulates a prefix on a clone of the model.
+     * @param x The genome.
+     * @param depth The number of moves to simulate.
+     * @param p Receives the prefix.
+     */
+    void Simulate(char* x, int depth, MovePrefix& p);
+
+    /**
+     * @brief Lists the prefixes one move longer, best bound first.
+     * @param n The prefix.
+     * @param children Receives the longer prefixes.
+     */
+    void Expand(Node& n, std::vector<Node>& children);
+
+    /**
+     * @brief Checks a prefix against the best makespan and the table.
+     * @param p The prefix.
+     * @param seen The long-span states reached below the current short-span schedule.
+     * @return `true` if the prefix can be cut.
+     */
+    bool Cut(const MovePrefix& p, std::unordered_set<uint64_t>* seen);
+
+    /**
+     * @brief Records a complete schedule if it beats the best one.
+     * @param value The makespan.
+     * @param x The genome.
+     */
+    void Improve(double value, const std::vector<char>& x);
+
+    /**
+     * @brief Searches the subtree below a prefix depth first.
+     * @param n The prefix.
+     * @param seen The long-span states reached below the current short-span schedule, `NULL` before it is fixed.
+     */
+    void Search(Node& n, std::unordered_set<uint64_t>* seen);
+
+    /**
+     * @brief Checks the node and time limits.
+     * @return `true` once the search must stop.
+     */
+    bool Limited();
+};
+
+#endif /* BRANCH_AND_BOUND_H */
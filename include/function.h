@@ -64,4 +64,11 @@ int adjust(int curr, int max_curr, int max_n);
  */
 void read_configs(std::map<std::string, double>& configs);
 
+/**
+ * @brief Quotes a string for JSON output.
+ * @param s The string, such as a file path or an error message.
+ * @return The string in double quotes, with quotes, backslashes and control characters escaped.
+ */
+std::string json_quote(const std::string& s);
+
 #endif
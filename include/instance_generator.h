@@ -0,0 +1,49 @@
+#ifndef INSTANCE_GENERATOR_H
+#define INSTANCE_GENERATOR_H
+
+#include <string>
+
+/**
+ * @brief Represents the shape of a synthetic All_Model yard.
+ *
+ * The yard is W bays by L rows of stacks at most H high. Bays below W / 2 are on the
+ * short-span side and the others on the long-span side: short-span exports and their
+ * reserved containers are drawn from the first half, long-span ones from the second.
+ */
+struct YardSpec {
+    int W;           /**< The number of bays. */
+    int H;           /**< The maximum stack height. */
+    int L;           /**< The number of rows. */
+    double fill;     /**< The fraction of the W * H * L slots holding a container. */
+    int exp_ss;      /**< The number of short-span exports. */
+    int exp_ls;      /**< The number of long-span exports. */
+    int imp_ss;      /**< The number of short-span imports. */
+    int imp_ls;      /**< The number of long-span imports. */
+    int res_ss;      /**< The number of short-span reserved containers, -1 for whatever blocks the exports. */
+    int res_ls;      /**< The number of long-span reserved containers, -1 for whatever blocks the exports. */
+    unsigned seed;   /**< The seed of the generator. */
+
+    /**
+     * @brief Default constructor with a small yard.
+     */
+    YardSpec() : W(10), H(4), L(4), fill(0.5), exp_ss(5), exp_ls(5), imp_ss(5), imp_ls(5),
+        res_ss(-1), res_ls(-1), seed(1) {}
+};
+
+/**
+ * @brief Writes a random All_Model text instance.
+ *
+ * Stacks are filled from the ground up, every export sits in its own stack, and the
+ * containers stacked on an export are the reserved containers of that side. When a
+ * reserved count is given, export depths are drawn to use it up and any remainder is
+ * reserved from the tops of other stacks on the same side. Each stack with room left
+ * gets one area at its lowest free slot. The same spec and seed give the same file.
+ *
+ * @param spec The shape of the yard.
+ * @param file The path of the output file.
+ * @throws std::runtime_error If the spec is inconsistent, for example when the yard is
+ * too full to hold the requested moves, or the file cannot be written.
+ */
+void generate_instance(const YardSpec& spec, const char* file);
+
+#endif /* INSTANCE_GENERATOR_H */
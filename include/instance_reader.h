@@ -0,0 +1,78 @@
+#ifndef INSTANCE_READER_H
+#define INSTANCE_READER_H
+
+#include <stddef.h>
+
+#include <string>
+
+/**
+ * @brief Reads whitespace separated numbers from an instance file.
+ *
+ * The file is mapped into memory and scanned in place, so loading large instances does
+ * not go through `fscanf`. Every read is checked: a missing file, a truncated file, a
+ * malformed number or a count out of range throws `std::runtime_error` with the file
+ * name, the line and the name of the value that was being read.
+ */
+class InstanceReader {
+private:
+    std::string file; /**< The path of the file, for error messages. */
+    const char* begin; /**< The first byte of the file. */
+    const char* ptr;   /**< The current read position. */
+    const char* end;   /**< One past the last byte of the file. */
+    size_t length;     /**< The length of the mapping. */
+
+    /**
+     * @brief Skips whitespace and fails if the end of the file is reached.
+     * @param what The name of the value about to be read.
+     */
+    void skip_space(const char* what);
+
+public:
+    /**
+     * @brief Constructor that maps a file into memory.
+     * @param path The path to the input file.
+     */
+    explicit InstanceReader(const char* path);
+
+    /**
+     * @brief Destructor that unmaps the file.
+     */
+    ~InstanceReader();
+
+    /**
+     * @brief Reads a signed integer.
+     * @param what The name of the value, used in error messages.
+     * @return The integer.
+     */
+    int next_int(const char* what);
+
+    /**
+     * @brief Reads an integer and checks that it lies in a range.
+     * @param what The name of the value, used in error messages.
+     * @param lo The smallest accepted value.
+     * @param hi The largest accepted value.
+     * @return The integer.
+     */
+    int next_int(const char* what, int lo, int hi);
+
+    /**
+     * @brief Reads a decimal number such as `65.870` or `1e-3`.
+     * @param what The name of the value, used in error messages.
+     * @return The number.
+     */
+    double next_double(const char* what);
+
+    /**
+     * @brief Checks whether only whitespace is left.
+     * @return `true` if the end of the file has been reached.
+     */
+    bool at_end();
+
+    /**
+     * @brief Throws an error pointing at the current read position.
+     * @param message The description of the problem.
+     */
+    void fail(const std::string& message) const;
+};
+
+#endif /* INSTANCE_READER_H */
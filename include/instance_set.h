@@ -0,0 +1,73 @@
+#ifndef INSTANCE_SET_H
+#define INSTANCE_SET_H
+
+#include <string>
+#include <vector>
+
+#include "binary_pso.h"
+#include "model.h"
+
+/**
+ * @brief Represents one loaded instance of a multi-instance run.
+ *
+ * Owns the master model and the objective built over it.
+ */
+struct LoadedInstance {
+    std::string file;     /**< The path of the instance. */
+    std::string kind;     /**< The model used: matrix, all or ss. */
+    std::string error;    /**< The loading error, empty if loaded. */
+    Model* model;         /**< The master model. */
+    Objective* objective; /**< The objective over the master model. */
+
+    /**
+     * @brief Default constructor.
+     */
+    LoadedInstance() : model(NULL), objective(NULL) {}
+
+    /**
+     * @brief Destructor that frees the model and the objective.
+     */
+    ~LoadedInstance() {
+        delete objective;
+        delete model;
+    }
+
+    /**
+     * @brief Loads the model named by `file` and `kind`.
+     *
+     * Errors are kept in `error` rather than thrown, so this can run on a worker thread.
+     *
+     * @param cranes The number of cranes for All_Model instances.
+     */
+    void load(int cranes);
+
+private:
+    LoadedInstance(const LoadedInstance&);
+    LoadedInstance& operator=(const LoadedInstance&);
+};
+
+/**
+ * @brief Expands one command line argument into instance files.
+ *
+ * An argument is a path, a glob pattern such as `'data/data_1*_1.txt'` (quoted so the
+ * shell leaves it alone), or `@list` naming a file with one argument per line. Empty
+ * lines and lines starting with `#` in a list are skipped.
+ *
+ * @param arg The argument.
+ * @param files The list the files are appended to.
+ * @throws std::runtime_error If a list file cannot be opened.
+ */
+void expand_instance_arg(const std::string& arg, std::vector<std::string>& files);
+
+/**
+ * @brief Detects the model of an instance file.
+ *
+ * Travel-time matrix files start with a line of seven counts. Binary instances and
+ * everything else are read as All_Model instances.
+ *
+ * @param file The path of the instance.
+ * @return matrix or all.
+ */
+std::string detect_instance_kind(const std::string& file);
+
+#endif /* INSTANCE_SET_H */
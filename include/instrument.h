@@ -0,0 +1,165 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The hot-path events that are counted.
+ */
+enum InstrumentCounter {
+    COUNT_CLONE,             /**< Model clones. */
+    COUNT_EVALUATION,        /**< Objective evaluations made by `BinaryPSO`. */
+    COUNT_SS_SOLVE,          /**< Short-span simulations. */
+    COUNT_LS_SOLVE,          /**< Long-span simulations. */
+    COUNT_CHECK_SS,          /**< Calls of `All_Model::check_ss`. */
+    COUNT_CHECK_SS_STEP,     /**< Iterations of the `check_ss` scan. */
+    COUNT_FIXED_POINT_ROUND, /**< Rounds of the long-span waiting loops. */
+    COUNT_AREA_POP,          /**< Pops from the area pool. */
+    COUNT_RES_POP,           /**< Pops from the reserved pools. */
+    COUNT_POOL_POP,          /**< Pops from the import and export pools. */
+    COUNT_BOUND_ABORT,       /**< Bounded solves stopped early at their cutoff. */
+    COUNT_RELAXED,           /**< Interference-free evaluations made by `BinaryPSO`. */
+    COUNT_ALLOC,             /**< Calls of `operator new`. */
+    COUNT_ALLOC_BYTES,       /**< Bytes requested from `operator new`. */
+    COUNT_KINDS              /**< The number of counters. */
+};
+
+/**
+ * @brief The phases that are timed.
+ */
+enum InstrumentTimer {
+    TIME_CLONE,      /**< `All_Model::clone`. */
+    TIME_ANALYZE,    /**< `All_Model::analyze`. */
+    TIME_EVALUATION, /**< One objective evaluation in `BinaryPSO`. */
+    TIME_MOVE,       /**< The velocity update of one particle. */
+    TIME_SS_SOLVE,   /**< `All_Model::ss_solve`. */
+    TIME_LS_SOLVE,   /**< `All_Model::fx_function_solve_2`. */
+    TIME_CHECK_SS,   /**< `All_Model::check_ss`. */
+    TIME_KINDS       /**< The number of timers. */
+};
+
+/**
+ * @brief Represents the counters and timers of one thread, or their sum.
+ *
+ * Aligned to a cache line, so the blocks of threads counting side by side never share one.
+ */
+struct alignas(64) InstrumentCounts {
+    uint64_t counts[COUNT_KINDS]; /**< The value of each counter. */
+    uint64_t ticks[TIME_KINDS];   /**< The ticks spent in each timer. */
+    uint64_t calls[TIME_KINDS];   /**< The number of times each timer ran. */
+};
+
+/**
+ * @brief Checks whether the build counts anything.
+ * @return `true` if built with `-DPSO_INSTRUMENT`.
+ */
+bool instrument_enabled();
+
+/**
+ * @brief Gets the number of threads that were not counted.
+ *
+ * Only the first 256 threads that touch a counter get one; later threads count into a
+ * block of their own that is never summed.
+ *
+ * @return The number of threads past the last counter block.
+ */
+int instrument_uncounted();
+
+/**
+ * @brief Sums the counters of all threads.
+ *
+ * Threads write their own counters without locking, so the sum is exact once the
+ * threads being measured are idle, for example after `ThreadPool::wait()`.
+ *
+ * @param total The sum.
+ * @return The number of threads that counted anything, at most 256.
+ */
+int instrument_snapshot(InstrumentCounts& total);
+
+/**
+ * @brief Zeroes the counters of all threads.
+ */
+void instrument_reset();
+
+/**
+ * @brief Converts timer ticks to seconds.
+ * @param ticks The ticks.
+ * @return The seconds.
+ */
+double instrument_seconds(uint64_t ticks);
+
+/**
+ * @brief Writes the summed counters and timers.
+ * @param out The stream to write to.
+ * @param json `true` for JSON, `false` for a table.
+ */
+void instrument_report(FILE* out, bool json = false);
+
+#ifdef PSO_INSTRUMENT
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * @brief Gets the counters of the calling thread.
+ * @return The counters, which live as long as the process.
+ */
+InstrumentCounts& instrument_local();
+
+/**
+ * @brief Reads the timestamp counter, or a nanosecond clock where there is none.
+ * @return The ticks.
+ */
+inline uint64_t instrument_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Adds the time of a scope to a timer.
+ */
+class InstrumentScope {
+private:
+    InstrumentTimer timer; /**< The timer. */
+    uint64_t start;        /**< The ticks at the start of the scope. */
+
+public:
+    /**
+     * @brief Constructor that starts the timer.
+     * @param t The timer.
+     */
+    explicit InstrumentScope(InstrumentTimer t) : timer(t), start(instrument_ticks()) {}
+
+    /**
+     * @brief Destructor that stops the timer.
+     */
+    ~InstrumentScope() {
+        InstrumentCounts& c = instrument_local();
+        c.ticks[timer] += instrument_ticks() - start;
+        c.calls[timer]++;
+    }
+};
+
+#define PSO_COUNT(c) (instrument_local().counts[c]++)
+#define PSO_COUNT_N(c, n) (instrument_local().counts[c] += (n))
+#define PSO_TIME_CAT(a, b) a##b
+#define PSO_TIME_NAME(line) PSO_TIME_CAT(pso_scope_, line)
+#define PSO_TIME(t) InstrumentScope PSO_TIME_NAME(__LINE__)(t)
+
+#else
+
+#define PSO_COUNT(c) ((void) 0)
+#define PSO_COUNT_N(c, n) ((void) (n))
+#define PSO_TIME(t) ((void) 0)
+
+#endif /* PSO_INSTRUMENT */
+
+#endif /* INSTRUMENT_H */
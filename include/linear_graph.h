@@ -42,6 +42,12 @@ public:
      */
     virtual void get_mode();
 
+    /**
+     * @brief Appends the mode of the graph, as printed by `get_mode()`, to a string.
+     * @param out The string to append to.
+     */
+    void get_mode(std::string& out) const;
+
     /**
      * @brief Gets the type of the graph.
      * @return The type of the graph.
@@ -75,6 +81,46 @@ public:
      */
     bool outer(int x);
 
+    /**
+     * @brief Gets the time the graph starts at.
+     * @return The minimum x-value.
+     */
+    int get_start() const {
+        return min_x;
+    }
+
+    /**
+     * @brief Gets the time the graph ends at.
+     * @return The maximum x-value.
+     */
+    int get_end() const {
+        return max_x;
+    }
+
+    /**
+     * @brief Gets the position at the start.
+     * @return The y-value at `get_start()`.
+     */
+    int get_from() const {
+        return min_y;
+    }
+
+    /**
+     * @brief Gets the position at the end.
+     * @return The y-value at `get_end()`.
+     */
+    int get_to() const {
+        return max_y;
+    }
+
+    /**
+     * @brief Checks whether the graph is a wait for the other crane.
+     * @return The waiting flag given to `set_mode()`.
+     */
+    bool get_wait() const {
+        return is_wait;
+    }
+
     /**
      * @brief Compares two time graphs.
      * @param a The first time graph.
@@ -0,0 +1,97 @@
+#ifndef MATRIX_MODEL_H
+#define MATRIX_MODEL_H
+
+#include <vector>
+#include "model.h"
+
+/**
+ * @brief Represents a travel-time matrix model for the Particle Swarm Optimization (PSO) algorithm.
+ *
+ * This class extends the base `Model` class for the `data/data_*` instances: each
+ * short-span and long-span move takes an export container to a free area, and its cost
+ * is read from precomputed travel-time matrices between the working sides, the areas
+ * and the containers.
+ */
+class Matrix_Model : public Model {
+private:
+    int side_of_working;  /**< Number of working sides. */
+    int ss, ls;           /**< Number of short-span and long-span moves. */
+    int import_container; /**< Number of import containers. */
+    int free_area;        /**< Number of free areas. */
+    int export_container; /**< Number of export containers. */
+    int movement;         /**< Number of movements. */
+    int allocate_size;    /**< Total allocated size for the model. */
+
+    std::vector<std::vector<double>> time_side_to_a; /**< Travel time from each side to each area. */
+    std::vector<std::vector<double>> time_side_to_c; /**< Travel time from each side to each container. */
+    std::vector<std::vector<double>> time_a_to_c;    /**< Travel time from each area to each container. */
+
+    std::vector<int> upper;     /**< Upper bound of each decoded value. */
+    std::vector<int> lower;     /**< Lower bound of each decoded value. */
+    std::vector<int> start_bit; /**< First bit of each decoded value. */
+    std::vector<int> bitnum;    /**< Number of bits of each decoded value. */
+
+    /**
+     * @brief Loads data from a file.
+     * @param file The path to the input file.
+     */
+    void load_data(const char* file);
+
+    /**
+     * @brief Calculates the required memory allocation size.
+     * @return The calculated allocation size.
+     */
+    int calculate_malloc_size();
+
+public:
+    /**
+     * @brief Default constructor.
+     */
+    Matrix_Model();
+
+    /**
+     * @brief Constructor that loads data from a file.
+     * @param input The path to the input file.
+     * @throws std::runtime_error If the file is missing or malformed.
+     */
+    Matrix_Model(const char*& input);
+
+    /**
+     * @brief Destructor.
+     */
+    ~Matrix_Model();
+
+    /**
+     * @brief Clones the model.
+     * @return A new instance of the `Matrix_Model` class.
+     */
+    Matrix_Model* clone();
+
+    /**
+     * @brief Solves the fitness function for the model.
+     *
+     * The model is not changed by solving, so the same instance can be shared by
+     * several threads.
+     *
+     * @param x_size The size of the input vector.
+     * @param x The input vector.
+     * @param display A flag indicating whether to display the results.
+     * @return The fitness value.
+     */
+    double fx_function_solve(int x_size, char* x, bool display);
+
+    /**
+     * @brief Gets the bit size of the model.
+     * @return The bit size.
+     */
+    inline int get_bit_size() const {
+        return allocate_size;
+    }
+
+    /**
+     * @brief Displays the model's state.
+     */
+    void display();
+};
+
+#endif /* MATRIX_MODEL_H */
@@ -60,13 +60,11 @@ public:
      * @param input The path to the input file.
      */
     Model(const char*& input);
-    virtual ~Model();
-    
 
     /**
      * @brief Destructor.
      */
-    ~Model();
+    virtual ~Model();
 
     /**
      * @brief Clones the model.
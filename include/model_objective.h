@@ -0,0 +1,252 @@
+#ifndef MODEL_OBJECTIVE_H
+#define MODEL_OBJECTIVE_H
+
+#include "binary_pso.h"
+#include "all_model.h"
+#include "matrix_model.h"
+#include "ss_model.h"
+
+/**
+ * @brief Represents the objective of a `Matrix_Model`.
+ *
+ * Solving does not change the model, so one objective can be shared by all threads.
+ */
+class MatrixObjective : public Objective {
+public:
+    Matrix_Model* model; /**< The model, not owned. */
+
+    /**
+     * @brief Constructor that wraps a model.
+     * @param m The model.
+     */
+    MatrixObjective(Matrix_Model* m) : model(m) {}
+
+    int Size() const {
+        return model->get_bit_size();
+    }
+
+    double Evaluate(char* x) {
+        return model->fx_function_solve(Size(), x, false);
+    }
+};
+
+/**
+ * @brief Represents the objective of an `SS_Model`.
+ *
+ * Solving consumes the model, so every evaluation runs on a clone as in `test_2`. The
+ * master model is only read and can be shared by all threads.
+ */
+class SSObjective : public Objective {
+public:
+    SS_Model* model; /**< The master model, not owned. */
+
+    /**
+     * @brief Constructor that wraps a model.
+     * @param m The master model.
+     */
+    SSObjective(SS_Model* m) : model(m) {}
+
+    int Size() const {
+        return model->get_bit_size();
+    }
+
+    double Evaluate(char* x) {
+        SS_Model* m = model->clone();
+        double y = m->fx_function_solve(Size(), x, false);
+        delete m;
+        return y;
+    }
+};
+
+/**
+ * @brief Represents the short-span phase of an `All_Model`, as in `test_3`.
+ *
+ * Every evaluation runs on a clone of the master model, which is only read.
+ */
+class ShortSpanObjective : public Objective {
+public:
+    All_Model* model; /**< The master model, not owned. */
+
+    /**
+     * @brief Constructor that wraps a model.
+     * @param m The master model.
+     */
+    ShortSpanObjective(All_Model* m) : model(m) {}
+
+    int Size() const {
+        return model->get_bit_size();
+    }
+
+    double Evaluate(char* x) {
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve(Size(), x, false);
+        delete m;
+        return y;
+    }
+
+    double EvaluateBounded(char* x, double cutoff) {
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve_bounded(x, cutoff);
+        delete m;
+        return y;
+    }
+
+    uint64_t Key(char* x) {
+        return model->phase_key(x, false);
+    }
+};
+
+/**
+ * @brief Represents the long-span phase of an `All_Model`, as in `test_3`.
+ *
+ * The master model must already hold the chosen short-span schedule: solve it in edited
+ * mode (with a `NullScheduleSink` to keep it quiet) and call `ls_analyze()`. Every
+ * evaluation then runs on a clone, so the long-span crane is scored against that schedule.
+ */
+class LongSpanObjective : public Objective {
+public:
+    All_Model* model; /**< The master model, not owned. */
+
+    /**
+     * @brief Constructor that wraps a model.
+     * @param m The master model with a recorded short-span schedule.
+     */
+    LongSpanObjective(All_Model* m) : model(m), keyed(m->clone()) {}
+
+    /**
+     * @brief Destructor.
+     */
+    ~LongSpanObjective() {
+        delete keyed;
+    }
+
+    int Size() const {
+        return model->get_bit_size();
+    }
+
+    double Evaluate(char* x) {
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve_2(Size(), x, false);
+        delete m;
+        return y;
+    }
+
+    double EvaluateBounded(char* x, double cutoff) {
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve_2_bounded(x, cutoff);
+        delete m;
+        return y;
+    }
+
+    double EvaluateRelaxed(char* x) {
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve_2_relaxed(x);
+        delete m;
+        return y;
+    }
+
+    bool Relaxes() const {
+        return true;
+    }
+
+    //! A clone starts from freshly analyzed pools, not from those the recorded
+    //! short-span schedule left on the master, so the key is read off one made once
+    uint64_t Key(char* x) {
+        return keyed->phase_key(x, true);
+    }
+
+    //! The makespan, the waits for the short-span crane and the travel
+    int Objectives() const {
+        return 3;
+    }
+
+    double EvaluateVector(char* x, double* f) {
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve_2_objectives(x, f);
+        delete m;
+        return y;
+    }
+
+private:
+    All_Model* keyed; /**< A clone of the master, only read by `Key()`. */
+
+    LongSpanObjective(const LongSpanObjective&);
+    LongSpanObjective& operator=(const LongSpanObjective&);
+};
+
+/**
+ * @brief Represents the joint objective of an `All_Model`.
+ *
+ * Both cranes are optimized over one genome as in `test_4`, on the rail engine when more
+ * than two cranes are used. Every evaluation runs on a clone of the shared master model.
+ */
+class JointObjective : public Objective {
+public:
+    All_Model* model; /**< The master model, not owned. */
+    int cranes;       /**< The number of cranes on the rail. */
+
+    /**
+     * @brief Constructor that wraps a model.
+     * @param m The master model.
+     * @param k The number of cranes.
+     */
+    JointObjective(All_Model* m, int k = 2) : model(m), cranes(k) {}
+
+    int Size() const {
+        return model->get_joint_bit_size();
+    }
+
+    double Evaluate(char* x) {
+        All_Model* m = model->clone();
+        double y = (cranes > 2) ? m->fx_function_solve_rail(x, cranes)
+                : m->fx_function_solve_joint(Size(), x, false);
+        delete m;
+        return y;
+    }
+
+    //! The rail engine has no bound yet and always runs to the end
+    double EvaluateBounded(char* x, double cutoff) {
+        All_Model* m = model->clone();
+        double y = (cranes > 2) ? m->fx_function_solve_rail(x, cranes)
+                : m->fx_function_solve_joint_bounded(x, cutoff);
+        delete m;
+        return y;
+    }
+
+    double EvaluateRelaxed(char* x) {
+        All_Model* m = model->clone();
+        double y = (cranes > 2) ? m->fx_function_solve_rail(x, cranes)
+                : m->fx_function_solve_joint_relaxed(x);
+        delete m;
+        return y;
+    }
+
+    //! The rail engine has no relaxation
+    bool Relaxes() const {
+        return cranes <= 2;
+    }
+
+    //! The rail engine decodes the same moves, so the key holds for any number of cranes
+    uint64_t Key(char* x) {
+        All_Model* m = model->clone();
+        uint64_t k = m->decoded_key(x, true, true);
+        delete m;
+        return k;
+    }
+
+    //! The makespan, the waits of the long-span crane and the travel of both; the rail
+    //! engine only has the makespan
+    int Objectives() const {
+        return (cranes > 2) ? 1 : 3;
+    }
+
+    double EvaluateVector(char* x, double* f) {
+        if (cranes > 2) return f[0] = Evaluate(x);
+        All_Model* m = model->clone();
+        double y = m->fx_function_solve_joint_objectives(x, f);
+        delete m;
+        return y;
+    }
+};
+
+#endif /* MODEL_OBJECTIVE_H */
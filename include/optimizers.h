@@ -0,0 +1,55 @@
+#ifndef OPTIMIZERS_H
+#define OPTIMIZERS_H
+
+#include <stdexcept>
+#include <string>
+
+#include "annealing.h"
+#include "binary_pso.h"
+#include "tabu_search.h"
+
+/**
+ * @brief Lists the optimizers the METHOD key picks from.
+ */
+enum OptimizerMethod {
+    METHOD_PSO,       /**< The binary PSO. */
+    METHOD_ANNEALING, /**< Simulated annealing, with parallel tempering for several replicas. */
+    METHOD_TABU,      /**< Tabu search. */
+    METHODS           /**< The number of methods. */
+};
+
+static const char* const method_names[METHODS] = {"pso", "sa", "tabu"};
+
+/**
+ * @brief Finds a method by its short name.
+ * @param name The name, as in `method_names`.
+ * @return The method, or -1 if there is none of that name.
+ */
+inline int parse_method(const std::string& name) {
+    for (int m = 0; m < METHODS; m++) {
+        if (name == method_names[m]) return m;
+    }
+    return -1;
+}
+
+/**
+ * @brief Creates the optimizer `params.method` picks.
+ * @param params The parameters.
+ * @param seed The seed of the run.
+ * @param threads The number of threads an optimizer may use within one run.
+ * @return The optimizer, owned by the caller.
+ */
+inline Optimizer* make_optimizer(const BinaryPSOParams& params, unsigned seed, int threads = 1) {
+    switch (params.method) {
+    case METHOD_PSO:
+        return new BinaryPSO(params, seed);
+    case METHOD_ANNEALING:
+        return new Annealing(params, seed, threads);
+    case METHOD_TABU:
+        return new TabuSearch(params, seed);
+    default:
+        throw std::runtime_error("unknown METHOD " + std::to_string(params.method));
+    }
+}
+
+#endif /* OPTIMIZERS_H */
@@ -0,0 +1,157 @@
+#ifndef PACKED_SWARM_H
+#define PACKED_SWARM_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Represents the positions of a binary swarm packed 64 bits to a word.
+ *
+ * Distances between genomes are then a popcount per word instead of a comparison per
+ * bit, which makes it cheap to watch the diversity of the swarm every iteration.
+ */
+class PackedSwarm {
+public:
+    /**
+     * @brief Constructor for genomes of a given size.
+     * @param n The number of bits of a genome.
+     */
+    explicit PackedSwarm(int n) : bits(n), words((n + 63) / 64), count(0) {}
+
+    /**
+     * @brief Packs one genome.
+     * @param x The bits, one byte each holding 0 or 1.
+     * @param n The number of bits.
+     * @param w Receives `(n + 63) / 64` words.
+     */
+    static void pack(const char* x, int n, uint64_t* w) {
+        std::fill(w, w + (n + 63) / 64, 0);
+        for (int j = 0; j < n; j++) {
+            if (x[j]) w[j / 64] |= (uint64_t) 1 << (j % 64);
+        }
+    }
+
+    /**
+     * @brief Counts the bits in which two packed genomes differ.
+     * @param a The first genome.
+     * @param b The second genome.
+     * @param words The number of words of a genome.
+     * @return The Hamming distance.
+     */
+    static int distance(const uint64_t* a, const uint64_t* b, int words) {
+        int d = 0;
+        for (int i = 0; i < words; i++) d += __builtin_popcountll(a[i] ^ b[i]);
+        return d;
+    }
+
+    /**
+     * @brief Hashes a packed genome.
+     * @param w The genome.
+     * @param words The number of words of a genome.
+     * @return The hash.
+     */
+    static uint64_t hash(const uint64_t* w, int words) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (int i = 0; i < words; i++) {
+            h ^= w[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h *= 0xff51afd7ed558ccdULL;
+        }
+        return h;
+    }
+
+    /**
+     * @brief Packs the positions of a swarm, replacing the previous ones.
+     * @param x The positions.
+     */
+    void assign(const std::vector<std::vector<char> >& x) {
+        count = x.size();
+        packed.resize((size_t) count * words);
+        for (int i = 0; i < count; i++) pack(x[i].data(), bits, row(i));
+    }
+
+    /**
+     * @brief Gets the number of packed genomes.
+     * @return The number of genomes.
+     */
+    int size() const {
+        return count;
+    }
+
+    /**
+     * @brief Gets the words of a packed genome.
+     * @param i The genome.
+     * @return Its words.
+     */
+    uint64_t* row(int i) {
+        return &packed[(size_t) i * words];
+    }
+
+    /**
+     * @brief Gets the words of a packed genome.
+     * @param i The genome.
+     * @return Its words.
+     */
+    const uint64_t* row(int i) const {
+        return &packed[(size_t) i * words];
+    }
+
+    /**
+     * @brief Hashes a packed genome.
+     * @param i The genome.
+     * @return The hash.
+     */
+    uint64_t hash(int i) const {
+        return hash(row(i), words);
+    }
+
+    /**
+     * @brief Gets the mean fraction of bits differing from a genome, the binary `Swarm::Dispersion`.
+     * @param x The genome, unpacked.
+     * @return The dispersion in [0, 1].
+     */
+    double dispersion(const char* x) const {
+        if (count == 0 || bits == 0) return 0;
+        std::vector<uint64_t> w(words);
+        pack(x, bits, w.data());
+        long long d = 0;
+        for (int i = 0; i < count; i++) d += distance(row(i), w.data(), words);
+        return (double) d / count / bits;
+    }
+
+    /**
+     * @brief Gets the mean fraction of bits in which two genomes of the swarm differ.
+     *
+     * 0 means every particle sits on the same genome, 0.5 is what random genomes give.
+     *
+     * @return The diversity in [0, 1].
+     */
+    double diversity() const {
+        if (count < 2 || bits == 0) return 0;
+        long long d = 0;
+        for (int a = 0; a < count; a++) {
+            for (int b = a + 1; b < count; b++) d += distance(row(a), row(b), words);
+        }
+        return 2.0 * d / ((double) count * (count - 1)) / bits;
+    }
+
+    /**
+     * @brief Counts the distinct genomes of the swarm.
+     * @return The number of distinct genomes.
+     */
+    int unique() const {
+        std::unordered_set<uint64_t> seen;
+        for (int i = 0; i < count; i++) seen.insert(hash(i));
+        return seen.size();
+    }
+
+private:
+    int bits;                     /**< The number of bits of a genome. */
+    int words;                    /**< The number of words of a packed genome. */
+    int count;                    /**< The number of packed genomes. */
+    std::vector<uint64_t> packed; /**< The genomes, `words` words each. */
+};
+
+#endif /* PACKED_SWARM_H */
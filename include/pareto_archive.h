@@ -0,0 +1,178 @@
+#ifndef PARETO_ARCHIVE_H
+#define PARETO_ARCHIVE_H
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Represents one solution of a Pareto front.
+ */
+struct ParetoPoint {
+    std::vector<double> f; /**< The objectives, lower is better. */
+    std::vector<char> x;   /**< The bits of the solution. */
+};
+
+/**
+ * @brief Represents a bounded set of mutually non-dominated solutions.
+ *
+ * The points are kept sorted by their first objective. A point can only be dominated
+ * by points not after it in that order and can only dominate points not before it, so
+ * an insertion binary searches its place and compares against one side each way; with
+ * two objectives the front is also sorted by the second one and both scans stop at the
+ * first point that does not dominate, or is not dominated. Once the archive is over
+ * capacity the point with the smallest crowding distance is dropped, which keeps the
+ * ends of the front and spreads the rest along it.
+ */
+class ParetoArchive {
+public:
+    /**
+     * @brief Constructor that sets the number of objectives and the capacity.
+     * @param m The number of objectives.
+     * @param capacity The most points kept.
+     */
+    ParetoArchive(int m, int capacity) : m(m), capacity(capacity) {}
+
+    /**
+     * @brief Checks whether one vector of objectives dominates another.
+     * @param a The first vector.
+     * @param b The second vector.
+     * @param m The number of objectives.
+     * @return `true` if `a` is nowhere worse than `b` and better somewhere.
+     */
+    static bool dominates(const double* a, const double* b, int m) {
+        bool better = false;
+        for (int k = 0; k < m; k++) {
+            if (a[k] > b[k]) return false;
+            if (a[k] < b[k]) better = true;
+        }
+        return better;
+    }
+
+    /**
+     * @brief Offers a solution to the archive.
+     *
+     * A solution equal on every objective to a point already kept is not added.
+     *
+     * @param f The objectives of the solution.
+     * @param x The bits of the solution.
+     * @param n The number of bits.
+     * @return `true` if the solution was kept.
+     */
+    bool insert(const double* f, const char* x, int n) {
+        size_t lo = std::lower_bound(points.begin(), points.end(), f[0], First()) - points.begin();
+        size_t hi = std::upper_bound(points.begin(), points.end(), f[0], First()) - points.begin();
+        for (size_t i = hi; i-- > 0;) {
+            if (Covers(points[i].f.data(), f)) return false;
+            if (m == 2 && i < lo) break;
+        }
+        size_t kept = lo;
+        for (size_t i = lo; i < points.size(); i++) {
+            if (dominates(f, points[i].f.data(), m)) continue;
+            if (m == 2 && i >= hi && points[i].f[1] < f[1]) {
+                //! The rest of a two-objective front is better on the second objective
+                if (kept != i) std::move(points.begin() + i, points.end(), points.begin() + kept);
+                kept += points.size() - i;
+                break;
+            }
+            if (kept != i) points[kept] = std::move(points[i]);
+            kept++;
+        }
+        points.resize(kept);
+        ParetoPoint p;
+        p.f.assign(f, f + m);
+        p.x.assign(x, x + n);
+        size_t at = std::upper_bound(points.begin(), points.end(), f[0], First()) - points.begin();
+        points.insert(points.begin() + at, std::move(p));
+        if ((int) points.size() <= capacity) return true;
+        size_t drop = Crowded();
+        points.erase(points.begin() + drop);
+        return drop != at;
+    }
+
+    /**
+     * @brief Offers every point of a front to the archive.
+     * @param front The points.
+     */
+    void merge(const std::vector<ParetoPoint>& front) {
+        for (const ParetoPoint& p : front) insert(p.f.data(), p.x.data(), p.x.size());
+    }
+
+    /**
+     * @brief Gets the points kept.
+     * @return The points, by increasing first objective.
+     */
+    const std::vector<ParetoPoint>& front() const {
+        return points;
+    }
+
+    /**
+     * @brief Gets the number of objectives.
+     * @return The number of objectives.
+     */
+    int objectives() const {
+        return m;
+    }
+
+private:
+    int m;                           /**< The number of objectives. */
+    int capacity;                    /**< The most points kept. */
+    std::vector<ParetoPoint> points; /**< The points, by increasing first objective. */
+
+    /**
+     * @brief Compares a point and a value by the first objective, for the binary searches.
+     */
+    struct First {
+        bool operator()(const ParetoPoint& p, double v) const {
+            return p.f[0] < v;
+        }
+        bool operator()(double v, const ParetoPoint& p) const {
+            return v < p.f[0];
+        }
+    };
+
+    /**
+     * @brief Checks whether a kept point makes a new one useless.
+     * @param a The objectives of the kept point.
+     * @param b The objectives of the new point.
+     * @return `true` if `a` is nowhere worse than `b`.
+     */
+    bool Covers(const double* a, const double* b) const {
+        for (int k = 0; k < m; k++) {
+            if (a[k] > b[k]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Finds the point with the smallest crowding distance.
+     *
+     * The crowding distance of a point sums, over the objectives, the gap between its
+     * neighbours in that objective divided by the range of the objective. The points at
+     * either end of an objective are never the most crowded.
+     *
+     * @return The index of the point.
+     */
+    size_t Crowded() const {
+        size_t size = points.size();
+        std::vector<double> distance(size, 0);
+        std::vector<size_t> order(size);
+        for (int k = 0; k < m; k++) {
+            for (size_t i = 0; i < size; i++) order[i] = i;
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return points[a].f[k] < points[b].f[k];
+            });
+            double range = points[order.back()].f[k] - points[order.front()].f[k];
+            distance[order.front()] = distance[order.back()] = std::numeric_limits<double>::infinity();
+            if (range <= 0) continue;
+            for (size_t i = 1; i + 1 < size; i++) {
+                distance[order[i]] += (points[order[i + 1]].f[k] - points[order[i - 1]].f[k]) / range;
+            }
+        }
+        return std::min_element(distance.begin(), distance.end()) - distance.begin();
+    }
+};
+
+#endif /* PARETO_ARCHIVE_H */
@@ -0,0 +1,140 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#include <string>
+
+/**
+ * @brief The hardware events that are counted.
+ */
+enum PerfEvent {
+    PERF_CYCLES,        /**< CPU cycles. */
+    PERF_INSTRUCTIONS,  /**< Retired instructions. */
+    PERF_CACHE_MISSES,  /**< Last-level cache misses. */
+    PERF_BRANCH_MISSES, /**< Mispredicted branches. */
+    PERF_EVENTS         /**< The number of events. */
+};
+
+/**
+ * @brief Represents the counts of each event, or their difference between two reads.
+ */
+struct PerfSample {
+    uint64_t counts[PERF_EVENTS]; /**< The count of each event, 0 for events that are not counted. */
+};
+
+/**
+ * @brief Reads hardware counters of the calling thread through Linux `perf_event_open`.
+ *
+ * Each event is opened on its own, so a machine that lacks one event still counts the
+ * others. Where counting is not permitted, as in most containers, or on other systems, the
+ * constructor still succeeds: `available()` is `false`, `error()` says why and every read
+ * returns zeros, so callers need no special case. Counts are scaled up when the kernel
+ * multiplexes the counters. Only user-space work of the thread that created the object is
+ * counted.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Constructor that opens and starts the counters.
+     */
+    PerfCounters();
+
+    /**
+     * @brief Destructor that closes the counters.
+     */
+    ~PerfCounters();
+
+    /**
+     * @brief Checks whether any event is counted.
+     * @return `true` if at least one counter could be opened.
+     */
+    bool available() const;
+
+    /**
+     * @brief Checks whether one event is counted.
+     * @param e The event.
+     * @return `true` if its counter could be opened.
+     */
+    bool available(PerfEvent e) const {
+        return fds[e] >= 0;
+    }
+
+    /**
+     * @brief Gets why counters are missing.
+     * @return The reason the first counter failed to open, empty if all opened.
+     */
+    const std::string& error() const {
+        return why;
+    }
+
+    /**
+     * @brief Reads the counters.
+     * @param s The counts since the counters were opened.
+     */
+    void read(PerfSample& s) const;
+
+    /**
+     * @brief Gets the name of an event.
+     * @param e The event.
+     * @return The name, such as `cycles`.
+     */
+    static const char* name(PerfEvent e);
+
+private:
+    int fds[PERF_EVENTS]; /**< The file descriptor of each counter, -1 if not open. */
+    std::string why;      /**< Why counters are missing. */
+
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+};
+
+/**
+ * @brief Represents the counts accumulated over every run of one region of code.
+ */
+struct PerfRegion {
+    std::string name;   /**< The name of the region. */
+    uint64_t calls;     /**< The number of times the region ran. */
+    PerfSample total;   /**< The counts summed over all runs. */
+
+    /**
+     * @brief Constructor that starts a region with no runs.
+     * @param n The name of the region.
+     */
+    explicit PerfRegion(const std::string& n = "") : name(n), calls(0) {
+        for (int i = 0; i < PERF_EVENTS; i++) total.counts[i] = 0;
+    }
+};
+
+/**
+ * @brief Adds the counts of a scope to a region.
+ */
+class PerfScope {
+private:
+    const PerfCounters* counters; /**< The counters, or `NULL` to only count calls. */
+    PerfRegion& region;           /**< The region. */
+    PerfSample start;             /**< The counts at the start of the scope. */
+
+public:
+    /**
+     * @brief Constructor that reads the counters at the start of the scope.
+     * @param c The counters, or `NULL`.
+     * @param r The region the scope adds to.
+     */
+    PerfScope(const PerfCounters* c, PerfRegion& r) : counters(c), region(r) {
+        if (counters) counters->read(start);
+    }
+
+    /**
+     * @brief Destructor that adds the counts of the scope to the region.
+     */
+    ~PerfScope() {
+        region.calls++;
+        if (!counters) return;
+        PerfSample end;
+        counters->read(end);
+        for (int i = 0; i < PERF_EVENTS; i++) region.total.counts[i] += end.counts[i] - start.counts[i];
+    }
+};
+
+#endif /* PERF_COUNTERS_H */
@@ -3,7 +3,11 @@
 
 #include <math.h>
 #include <stdio.h>
+
+#include <chrono>
+
 #include "swarm.h"
+#include "trace_recorder.h"
 
 /**
  * @brief Represents the Particle Swarm Optimization (PSO) algorithm.
@@ -25,6 +29,7 @@ public:
     int NB;      /**< The number of neighbors. */
 
     Swarm* sSwarm; /**< A pointer to the swarm of particles. */
+    TraceRecorder* trace; /**< Where the convergence trace goes, `NULL` for none. */
 
     /**
      * @brief Constructor that initializes the PSO algorithm with the given parameters.
@@ -46,6 +51,7 @@ public:
         cg = dcg;
         cl = dcl;
         cn = dcn;
+        trace = NULL;
     }
 
     /**
@@ -84,6 +90,7 @@ public:
         //PSO algorithm
         double w = wmax;
         double decr = (wmax - wmin) / Iter;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
 
         sSwarm = new Swarm(nPar, nDim);
         InitSwarm();
@@ -115,6 +122,7 @@ public:
             sSwarm->Move(w, cp, cg, cl, cn, u1, u2, u3, u4);
             Evaluate();
             sSwarm->UpdateBest(NB);
+            if (trace) Record(i, t0);
             if (debug) {
                 sSwarm->EvalDispersion();
                 sSwarm->EvalStatObj();
@@ -136,6 +144,37 @@ public:
         u1 = u2 = u3 = u4 = NULL;
     }
 
+    /**
+     * @brief Sends the state of the swarm after an iteration to the trace.
+     * @param iter The iteration.
+     * @param t0 The start of the run.
+     */
+    void Record(int iter, std::chrono::steady_clock::time_point t0) {
+        sSwarm->EvalDispersion();
+        sSwarm->EvalVelIndex();
+        sSwarm->EvalStatObj();
+        TraceRecord r;
+        r.run = r.restart = r.island = 0;
+        r.iteration = iter;
+        r.gbest = sSwarm->pParticle[sSwarm->posBest]->ObjectiveP;
+        r.mean_pbest = 0;
+        for (int j = 0; j < sSwarm->Member; j++) {
+            r.mean_pbest += sSwarm->pParticle[j]->ObjectiveP;
+        }
+        r.mean_pbest /= sSwarm->Member;
+        r.dispersion = sSwarm->Dispersion;
+        r.vel_index = sSwarm->VelIndex;
+        r.min_obj = sSwarm->MinObj;
+        r.avg_obj = sSwarm->AvgObj;
+        r.max_obj = sSwarm->MaxObj;
+        r.evaluations = (int64_t) (iter + 1) * sSwarm->Member;
+        //! Positions are continuous, so the bit diversity is not measured
+        r.diversity = 0;
+        r.unique = 0;
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        trace->record(r);
+    }
+
     /**
      * @brief Evaluates the objective function for each particle in the swarm.
      */
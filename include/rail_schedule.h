@@ -0,0 +1,278 @@
+#ifndef RAIL_SCHEDULE_H
+#define RAIL_SCHEDULE_H
+
+#include <vector>
+
+#include "linear_graph.h"
+#include "schedule_sink.h"
+
+/**
+ * @brief Represents one segment of a crane timeline on the shared rail.
+ *
+ * This is a value-typed counterpart of `SlopeTimeGraph`/`StableTimeGraph`: x is the time
+ * and y is the bay. A stable segment has `min_y == max_y`.
+ */
+struct RailSegment {
+    int min_x, max_x; /**< The start and end time. */
+    int min_y, max_y; /**< The start and end bay. */
+    int mode;         /**< The mode of the segment (0 RES, 1 IMP, 2 EXP, 3 BACK, 4 YIELD). */
+    int counter;      /**< The index of the move the segment belongs to, -1 for a yield. */
+    bool is_wait;     /**< A flag indicating whether the segment is a waiting segment. */
+
+    /**
+     * @brief Constructor that sets the dimensions of the segment.
+     * @param _min_x The start time.
+     * @param _max_x The end time.
+     * @param _min_y The start bay.
+     * @param _max_y The end bay.
+     * @param _mode The mode of the segment.
+     * @param _counter The index of the move.
+     * @param _is_wait A flag indicating whether the segment is a waiting segment.
+     */
+    RailSegment(int _min_x, int _max_x, int _min_y, int _max_y, int _mode = 0, int _counter = 0, bool _is_wait = false)
+        : min_x(_min_x), max_x(_max_x), min_y(_min_y), max_y(_max_y), mode(_mode), counter(_counter), is_wait(_is_wait) {}
+
+    /**
+     * @brief Gets the bay of the crane at a given time.
+     *
+     * Uses the same integer stepping as `SlopeTimeGraph::get_value()` so that schedules
+     * built on the rail match the `TimeGraph` based ones exactly.
+     *
+     * @param x The time.
+     * @return The bay at the given time.
+     */
+    inline int get_value(int x) const {
+        int x_diff = (max_x - min_x) / const_travel_time;
+        if (x_diff == 0) return min_y;
+        return ((x - min_x) / const_travel_time) * (max_y - min_y) / x_diff + min_y;
+    }
+
+    /**
+     * @brief Checks if a given time is within the segment's range.
+     * @param x The time to check.
+     * @return `true` if the time is within the range, `false` otherwise.
+     */
+    inline bool inner(int x) const {
+        return x >= min_x && x <= max_x;
+    }
+
+    /**
+     * @brief Checks if a given time is past the segment's range.
+     * @param x The time to check.
+     * @return `true` if the time is past the range, `false` otherwise.
+     */
+    inline bool outer(int x) const {
+        return x > max_x;
+    }
+};
+
+/**
+ * @brief Represents a decoded container move assigned to a crane.
+ */
+struct CraneTask {
+    int mode;      /**< The mode of the move (0 RES, 1 IMP, 2 EXP). */
+    int container; /**< The container (or import index) being moved. */
+    int area;      /**< The destination area, or -1 for exports. */
+    int from_w;    /**< The bay the container is picked from. */
+    int from_l;    /**< The row the container is picked from. */
+    int to_w;      /**< The bay the container is dropped at. */
+    int to_l;      /**< The row the container is dropped at. */
+};
+
+/**
+ * @brief Represents the timelines of k cranes sharing one rail.
+ *
+ * Cranes are ordered along the rail: crane 0 sits on the short-span side (bay -1) and
+ * crane k-1 on the long-span side (bay W). Crane i must always stay strictly left of
+ * crane i+1. A crane occupies its home bay before its first move, the bay it waits at
+ * while it waits and its last bay once it is done, so ordering with the neighbours is
+ * all that has to be kept; ordering with the others follows by transitivity.
+ *
+ * Two cranes follow the rule of `All_Model`: the short-span crane moves freely and the
+ * long-span crane returns to its end of the rail after every move, delayed until it
+ * no longer crosses. More cranes share the rail leg by leg, see `run()`.
+ */
+class RailSchedule {
+private:
+    int W;                                        /**< The number of bays. */
+    std::vector<int> homes;                       /**< The home bay of each crane. */
+    std::vector<int> last_bay;                    /**< The bay of each crane at its finishing time. */
+    std::vector<double> ends;                     /**< The finishing time of each crane. */
+    std::vector<std::vector<RailSegment> > lines; /**< The timeline of each crane. */
+
+    const static int CONTROL_TIME = 28; /**< Time required for control operations. */
+
+    /**
+     * @brief Computes the delay a segment needs to stay right of the left neighbour.
+     *
+     * This is the sweep of `All_Model::check_ss()` over value-typed segments.
+     *
+     * @param crane The crane the segment belongs to.
+     * @param src The segment to check.
+     * @param cursor The index into the neighbour's timeline, advanced by the sweep.
+     * @return The delay in time units.
+     */
+    int check(int crane, const RailSegment& src, int& cursor) const;
+
+    /**
+     * @brief Finds the first time a leg keeps clear of both neighbours.
+     *
+     * The crane then stays at the end of the leg, so that bay must also stay clear for
+     * the rest of the neighbours' timelines. A neighbour whose timeline ends in the way
+     * is pushed aside first with `yield()`.
+     *
+     * @param crane The crane of the leg.
+     * @param lo The lowest bay of the leg.
+     * @param hi The highest bay of the leg.
+     * @param to The bay at the end of the leg.
+     * @param s The earliest start.
+     * @param d The duration of the leg.
+     * @return The start time.
+     */
+    int clear(int crane, int lo, int hi, int to, int s, int d);
+
+    /**
+     * @brief Appends a leg to a crane, after waiting for as long as `clear()` asks.
+     * @param crane The crane.
+     * @param to The bay at the end of the leg; the leg starts where the crane is.
+     * @param d The duration.
+     * @param mode The mode of the leg.
+     * @param counter The index of the move.
+     */
+    void place(int crane, int to, int d, int mode, int counter);
+
+    /**
+     * @brief Moves a crane that is done or idle out of the way of a neighbour.
+     * @param crane The crane.
+     * @param to The bay to leave it at.
+     */
+    void yield(int crane, int to);
+
+public:
+    /**
+     * @brief Constructor for an empty schedule, to be filled by `All_Model::fx_function_solve_rail()`.
+     */
+    RailSchedule() : W(0) {}
+
+    /**
+     * @brief Constructor that places the cranes at their home bays.
+     *
+     * Crane 0 is homed at bay -1, crane k-1 at bay W and the cranes in between at the
+     * centre of equal zones of the yard.
+     *
+     * @param cranes The number of cranes, at least 2 and at most W + 2.
+     * @param bays The number of bays W.
+     */
+    RailSchedule(int cranes, int bays);
+
+    /**
+     * @brief Gets the number of cranes.
+     * @return The number of cranes.
+     */
+    inline int size() const {
+        return homes.size();
+    }
+
+    /**
+     * @brief Gets the home bay of a crane.
+     * @param crane The crane.
+     * @return The home bay.
+     */
+    inline int home(int crane) const {
+        return homes[crane];
+    }
+
+    /**
+     * @brief Gets the zone of a bay among the intermediate cranes.
+     * @param bay The bay.
+     * @return The intermediate crane owning the bay, or -1 when there is none.
+     */
+    int zone(int bay) const;
+
+    /**
+     * @brief Gets the timeline of a crane.
+     * @param crane The crane.
+     * @return The segments of the crane, ordered by time.
+     */
+    inline const std::vector<RailSegment>& timeline(int crane) const {
+        return lines[crane];
+    }
+
+    /**
+     * @brief Gets the finishing time of a crane.
+     * @param crane The crane.
+     * @return The finishing time.
+     */
+    inline double finish(int crane) const {
+        return ends[crane];
+    }
+
+    /**
+     * @brief Schedules tasks on a crane that moves freely between them.
+     *
+     * The crane travels from one task straight to the next and returns home at the end,
+     * the way the short-span crane works in `All_Model::fx_function_solve()`. No delays
+     * are inserted, so this is meant for crane 0.
+     *
+     * @param crane The crane.
+     * @param tasks The tasks in execution order.
+     * @return The finishing time of the crane.
+     */
+    double run_free(int crane, const std::vector<CraneTask>& tasks);
+
+    /**
+     * @brief Schedules tasks on a crane that returns home after every task.
+     *
+     * This is the long-span crane of `All_Model::fx_function_solve_2()`: every task is
+     * delayed until it no longer crosses the left neighbour's timeline.
+     *
+     * @param crane The crane.
+     * @param tasks The tasks in execution order.
+     * @return The finishing time of the crane.
+     */
+    double run_anchored(int crane, const std::vector<CraneTask>& tasks);
+
+    /**
+     * @brief Schedules the tasks of every crane.
+     *
+     * Two cranes run `run_free()` and `run_anchored()`. With more, the cranes travel
+     * from task to task and back home at the end, and every leg (a travel or a control)
+     * goes to the crane that has been busy the shortest. A leg waits until both
+     * neighbours stay clear of the bays it spans, and a neighbour that is done or idle
+     * in those bays is first moved one bay past them (mode 4, YIELD), pushing its own
+     * neighbour the same way. The rail extends past both ends of the yard for this.
+     *
+     * This is not one sweep over the cranes. Each leg binary searches the neighbours'
+     * timelines for the first segment ending after its earliest start and scans on from
+     * there, restarting whenever it has to wait. A neighbour still working has only its
+     * last leg and yields there, since the crane busy the shortest always goes next, but
+     * one that is done can be ahead by a long tail, so a leg costs up to the number of
+     * segments of its neighbours. A yield can push at most the k - 2 cranes beyond the
+     * neighbour, so the recursion is at most k deep. On random genomes of a 100-bay yard
+     * with 3 to 8 cranes a leg scans about two segments on average, and at most a few
+     * hundred.
+     *
+     * @param lists The tasks of each crane, in execution order.
+     * @return The makespan.
+     */
+    double run(const std::vector<std::vector<CraneTask> >& lists);
+
+    /**
+     * @brief Converts the timelines into schedule events, for `validate_schedule()`.
+     * @param out Receives one event per segment.
+     */
+    void events(std::vector<ScheduleEvent>& out) const;
+
+    /**
+     * @brief Gets the makespan over all cranes.
+     * @return The makespan.
+     */
+    double makespan() const;
+
+    /**
+     * @brief Displays the timelines.
+     */
+    void display() const;
+};
+
+#endif /* RAIL_SCHEDULE_H */
@@ -0,0 +1,160 @@
+#ifndef ROLLING_HORIZON_H
+#define ROLLING_HORIZON_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "all_model.h"
+#include "binary_pso.h"
+
+class ScheduleSink;
+
+/**
+ * @brief Represents one job of a stream of crane requests.
+ */
+struct StreamJob {
+    bool ls;       /**< `true` for the long-span crane, `false` for the short-span crane. */
+    bool import;   /**< `true` for an import, `false` for an export. */
+    int container; /**< The container an export takes, -1 for imports. */
+};
+
+/**
+ * @brief Parses one line of a job stream.
+ *
+ * A job is `imp ss`, `imp ls`, `exp ss <container>` or `exp ls <container>`. Blank
+ * lines and lines starting with `#` hold no job.
+ *
+ * @param line The line.
+ * @param job Receives the job.
+ * @return `true` if the line holds a job.
+ * @throws std::runtime_error If the line is malformed.
+ */
+bool parse_stream_job(const std::string& line, StreamJob& job);
+
+/**
+ * @brief Represents one committed window of a rolling-horizon run.
+ */
+struct RollingWindow {
+    int jobs;              /**< The number of jobs the window served. */
+    int moves;             /**< The number of crane moves, reserved moves included. */
+    double start;          /**< The time the window starts at. */
+    double makespan;       /**< The length of the window. */
+    long long evaluations; /**< The number of fitness evaluations spent on it. */
+    double seconds;        /**< The wall time spent planning it. */
+    int dropped;           /**< The number of jobs dropped because the yard can never take them. */
+};
+
+/**
+ * @brief Schedules a stream of import and export jobs one bounded window at a time.
+ *
+ * Jobs are queued as they arrive. Each window takes up to `window` of the oldest jobs,
+ * builds an `All_Model` instance of the current yard with only those jobs, optimizes its
+ * joint genome with one restart of the optimizer of the parameters, and commits the whole
+ * schedule: its events go to the sink shifted to the current time, and its moves are
+ * applied to the yard, which is all the next window sees of it. The work of a window is
+ * bounded by POPSIZE times ITERATION evaluations of an instance of at most `window` jobs,
+ * however long the stream is.
+ *
+ * The containers above an export are reserved for its crane. A window takes at most one
+ * export per stack, drops nothing on a stack it exports from and only takes jobs the free
+ * slots can hold; jobs it cannot take wait for a later window in their order. When none
+ * of the queued jobs fits, the yard cannot change until one does, so the window drops the
+ * oldest job instead of waiting forever.
+ */
+class RollingHorizon {
+public:
+    /**
+     * @brief Constructor that loads the yard and queues the jobs of its instance.
+     * @param yard The path to an `All_Model` instance; its stacks with an area take containers.
+     * @param params The parameters of the optimizer of each window.
+     * @param window The most jobs a window takes.
+     * @param seed The seed of the first window, the next ones counting up.
+     * @throws std::runtime_error If the instance cannot be loaded, imports more containers than
+     * its yard holds, or the window is not positive.
+     */
+    RollingHorizon(const char* yard, const BinaryPSOParams& params, int window, unsigned seed = 1);
+
+    /**
+     * @brief Sends the events of the committed windows to a sink.
+     * @param s The sink, not owned, or `NULL` for none.
+     */
+    void set_schedule_sink(ScheduleSink* s) {
+        sink = s;
+    }
+
+    /**
+     * @brief Queues a job.
+     * @param job The job.
+     * @throws std::runtime_error If an export takes a container not in the yard or already queued,
+     * or an import finds no slot: the free slots of the yard and those the queued exports free
+     * all go to the imports already queued.
+     */
+    void add(const StreamJob& job);
+
+    /**
+     * @brief Gets the number of queued jobs.
+     * @return The number of jobs.
+     */
+    int pending() const {
+        return queue.size();
+    }
+
+    /**
+     * @brief Checks whether a full window is queued.
+     * @return `true` once `window` jobs wait.
+     */
+    bool ready() const {
+        return (int) queue.size() >= window;
+    }
+
+    /**
+     * @brief Plans and commits the next window.
+     * @return The window; if none of the queued jobs fits in the yard, it serves no job and
+     * drops the oldest one.
+     * @throws std::runtime_error If no job is queued.
+     */
+    RollingWindow step();
+
+    /**
+     * @brief Gets the time the committed moves end at.
+     * @return The time.
+     */
+    double clock() const {
+        return now;
+    }
+
+    /**
+     * @brief Gets the containers of the yard.
+     * @return The containers by id, at (h, w, l); imports get ids past the largest so far.
+     */
+    std::map<int, dat> containers() const;
+
+private:
+    BinaryPSOParams params;              /**< The parameters of the optimizer. */
+    int window;                          /**< The most jobs a window takes. */
+    unsigned seed;                       /**< The seed of the next window. */
+    ScheduleSink* sink;                  /**< Where committed events go, not owned. */
+    int H, W, L;                         /**< The dimensions of the yard. */
+    std::vector<std::vector<int> > stacks; /**< The containers of each stack `w * L + l`, bottom first. */
+    std::vector<bool> open;              /**< Whether each stack takes containers. */
+    std::map<int, int> where;            /**< The stack of each container. */
+    std::deque<StreamJob> queue;         /**< The jobs not yet committed, oldest first. */
+    int last_container;                  /**< The largest container id so far. */
+    double now;                          /**< The time the committed moves end at. */
+
+    /**
+     * @brief Counts the slots left for imports.
+     * @return The free slots of the stacks that take containers, plus one for each queued export
+     * from such a stack, minus the queued imports.
+     */
+    long long Room() const;
+
+    /**
+     * @brief Applies committed moves to the yard.
+     * @param tasks The moves, in execution order.
+     */
+    void Apply(const std::vector<CraneTask>& tasks);
+};
+
+#endif /* ROLLING_HORIZON_H */
@@ -0,0 +1,235 @@
+#ifndef SCHEDULE_SINK_H
+#define SCHEDULE_SINK_H
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The kinds of schedule events.
+ */
+enum ScheduleEventType {
+    EVENT_MOVE = 0, /**< The crane travels, empty or carrying a container. */
+    EVENT_PICK = 1, /**< The crane picks up a container. */
+    EVENT_DROP = 2, /**< The crane drops a container. */
+    EVENT_WAIT = 3  /**< The crane waits for the other crane. */
+};
+
+/**
+ * @brief Represents one step of a crane schedule.
+ *
+ * Positions are (height, bay, row) slots of the yard. A position that is not a slot,
+ * such as the crane's last stop on an empty move, has a height of -1. The mode uses the
+ * numbering of the time graphs: 0 RES, 1 IMP, 2 EXP, 3 BACK, and 4 YIELD for a crane on a
+ * shared rail moving out of a neighbour's way (`RailSchedule`). The sinks name cranes SS
+ * and LS, then C2, C3 and so on along the rail.
+ */
+struct ScheduleEvent {
+    int type;       /**< The kind of event, a `ScheduleEventType`. */
+    int crane;      /**< The crane, 0 for short-span and 1 for long-span, or its place on a rail of more cranes. */
+    int mode;       /**< The mode of the move the event belongs to. */
+    bool loaded;    /**< A flag indicating whether a move carries a container. */
+    int container;  /**< The container or import index, -1 if none. */
+    int area;       /**< The destination area, -1 if none. */
+    int from_h, from_w, from_l; /**< The start position. */
+    int to_h, to_w, to_l;       /**< The end position. */
+    double start;    /**< The start time. */
+    double duration; /**< The duration. */
+};
+
+/**
+ * @brief Receives the events of a schedule replay.
+ *
+ * `All_Model` sends its events here when asked to show a schedule, instead of printing
+ * them one by one. Backends buffer the events and write them on `flush()`.
+ */
+class ScheduleSink {
+public:
+    /**
+     * @brief Destructor.
+     */
+    virtual ~ScheduleSink() {}
+
+    /**
+     * @brief Receives one event.
+     * @param e The event.
+     */
+    virtual void emit(const ScheduleEvent& e) = 0;
+
+    /**
+     * @brief Writes out the buffered events.
+     */
+    virtual void flush() {}
+};
+
+/**
+ * @brief Drops the events, for recording a schedule without writing it.
+ */
+class NullScheduleSink : public ScheduleSink {
+public:
+    void emit(const ScheduleEvent&) {}
+};
+
+/**
+ * @brief Shifts the events by a start time and passes them on, for schedules solved piece by piece.
+ */
+class OffsetScheduleSink : public ScheduleSink {
+public:
+    ScheduleSink* out; /**< The receiver, not owned. */
+    double offset;     /**< The time added to every start. */
+
+    /**
+     * @brief Constructor that sets the receiver and the shift.
+     * @param o The receiver.
+     * @param t The time added to every start.
+     */
+    OffsetScheduleSink(ScheduleSink* o, double t) : out(o), offset(t) {}
+
+    void emit(const ScheduleEvent& e) {
+        ScheduleEvent shifted = e;
+        shifted.start += offset;
+        out->emit(shifted);
+    }
+
+    void flush() {
+        out->flush();
+    }
+};
+
+/**
+ * @brief Keeps the events in memory.
+ */
+class VectorScheduleSink : public ScheduleSink {
+public:
+    std::vector<ScheduleEvent> events; /**< The events received so far. */
+
+    void emit(const ScheduleEvent& e) {
+        events.push_back(e);
+    }
+};
+
+/**
+ * @brief Base of the sinks writing into a `FILE`.
+ *
+ * Formatted events are collected in one buffer which is written with a single `fwrite`
+ * once it grows large, on `flush()` and on destruction.
+ */
+class BufferedScheduleSink : public ScheduleSink {
+protected:
+    FILE* out;       /**< The output, not owned. */
+    std::string buf; /**< The bytes not written yet. */
+
+    /**
+     * @brief Appends formatted text to the buffer.
+     * @param format The `printf` format.
+     */
+    void append(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * @brief Writes the buffer if it has grown large.
+     */
+    void spill();
+
+public:
+    /**
+     * @brief Constructor that sets the output.
+     * @param f The output.
+     */
+    explicit BufferedScheduleSink(FILE* f) : out(f) {}
+
+    /**
+     * @brief Destructor that writes the rest of the buffer.
+     */
+    ~BufferedScheduleSink();
+
+    void flush();
+};
+
+/**
+ * @brief Writes events as the human-readable lines the evaluators used to print.
+ */
+class TextScheduleSink : public BufferedScheduleSink {
+public:
+    explicit TextScheduleSink(FILE* f) : BufferedScheduleSink(f) {}
+
+    void emit(const ScheduleEvent& e);
+};
+
+/**
+ * @brief Writes events as CSV, one header line and one row per event.
+ */
+class CsvScheduleSink : public BufferedScheduleSink {
+private:
+    bool header; /**< A flag indicating whether the header has been written. */
+
+public:
+    explicit CsvScheduleSink(FILE* f) : BufferedScheduleSink(f), header(false) {}
+
+    void emit(const ScheduleEvent& e);
+};
+
+/**
+ * @brief Writes events as a JSON array of objects.
+ *
+ * The array is closed on destruction.
+ */
+class JsonScheduleSink : public BufferedScheduleSink {
+private:
+    int count; /**< The number of events written. */
+
+public:
+    explicit JsonScheduleSink(FILE* f) : BufferedScheduleSink(f), count(0) {}
+
+    /**
+     * @brief Destructor that closes the array.
+     */
+    ~JsonScheduleSink();
+
+    void emit(const ScheduleEvent& e);
+};
+
+/**
+ * @brief Writes events as fixed-size records in host byte order.
+ *
+ * The stream starts with the magic "PSOE" and a 32-bit version. Each record holds the
+ * type, crane, mode and loaded flag as bytes, the container, area and both positions as
+ * 32-bit integers, then the start and duration as doubles (52 bytes).
+ */
+class BinaryScheduleSink : public BufferedScheduleSink {
+private:
+    bool header; /**< A flag indicating whether the header has been written. */
+
+public:
+    static const int VERSION = 1;     /**< The version of the record layout. */
+    static const int RECORD_SIZE = 52; /**< The size of a record in bytes. */
+
+    explicit BinaryScheduleSink(FILE* f) : BufferedScheduleSink(f), header(false) {}
+
+    void emit(const ScheduleEvent& e);
+
+    /**
+     * @brief Reads a stream written by this sink.
+     * @param file The path of the stream.
+     * @param events The events read.
+     * @throws std::runtime_error If the file is missing or malformed.
+     */
+    static void read(const char* file, std::vector<ScheduleEvent>& events);
+};
+
+/**
+ * @brief Creates a sink by format name.
+ * @param format One of text, csv, json or bin.
+ * @param out The output.
+ * @return A new sink, or `NULL` if the format is unknown.
+ */
+ScheduleSink* make_schedule_sink(const std::string& format, FILE* out);
+
+/**
+ * @brief Gets the format name matching the extension of a file.
+ * @param file The path of the file.
+ * @return csv, json or bin for those extensions, text otherwise.
+ */
+std::string schedule_format(const std::string& file);
+
+#endif /* SCHEDULE_SINK_H */
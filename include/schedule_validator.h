@@ -0,0 +1,62 @@
+#ifndef SCHEDULE_VALIDATOR_H
+#define SCHEDULE_VALIDATOR_H
+
+#include <string>
+#include <vector>
+
+#include "schedule_sink.h"
+
+/**
+ * @brief The kinds of schedule violations.
+ */
+enum ScheduleViolationType {
+    VIOLATION_CROSSING = 0, /**< A crane is not strictly below the bay of the next crane. */
+    VIOLATION_ORDER = 1,    /**< An event of a crane starts before its previous event did. */
+    VIOLATION_OVERLAP = 2,  /**< An event of a crane starts before its previous event ends. */
+    VIOLATION_JUMP = 3,     /**< A crane starts an event away from where its previous one ended. */
+    VIOLATION_DURATION = 4  /**< An event has a negative duration, or a move crosses bays in no time. */
+};
+
+/**
+ * @brief Represents one broken invariant of a schedule.
+ */
+struct ScheduleViolation {
+    int type;    /**< The kind of violation, a `ScheduleViolationType`. */
+    int crane;   /**< The crane of `event`. */
+    int event;   /**< The index of the offending event. */
+    int other;   /**< The index of the event it conflicts with: the next crane's for a crossing, the previous one of the same crane otherwise; -1 if none. */
+    double time; /**< The first time the invariant is broken. */
+    int bay;     /**< The bay of the crane of `event` at that time. */
+    int other_bay; /**< The bay of the crane of `other` at that time, or where `other` ended. */
+};
+
+/**
+ * @brief Checks the non-crossing and ordering invariants of a schedule.
+ *
+ * Each crane is checked on its own for events in time order, back to back or with idle
+ * gaps, each starting at the bay the previous one ended at. Then every pair of cranes
+ * `k` and `k + 1` is swept together: crane `k` must stay strictly below the bay of crane
+ * `k + 1` at every time, with a move stepping one bay per `duration / bays` as the time
+ * graphs of `All_Model` do. A crane waits at its first bay before its first event and at
+ * its last bay after its last event.
+ *
+ * The sweep compares one pair of events at a time. A pair is decided in constant time
+ * when the cranes move apart, towards each other, or the same way at the same speed;
+ * when they move the same way at different speeds every bay either crane reaches during
+ * the pair is visited. The check costs O(n log n) in the number of events plus the bays
+ * travelled in such pairs, so it grows with the distance travelled and not with idle
+ * time. At most one crossing is reported per pair of events, at its first time.
+ *
+ * @param events The events, as sent to a `ScheduleSink`, in the order of each crane.
+ * @return The violations, empty for a valid schedule.
+ */
+std::vector<ScheduleViolation> validate_schedule(const std::vector<ScheduleEvent>& events);
+
+/**
+ * @brief Describes a violation in one line.
+ * @param v The violation.
+ * @return The description.
+ */
+std::string describe_violation(const ScheduleViolation& v);
+
+#endif /* SCHEDULE_VALIDATOR_H */
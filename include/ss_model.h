@@ -71,6 +71,7 @@ public:
     /**
      * @brief Constructor that loads data from a file.
      * @param input The path to the input file.
+     * @throws std::runtime_error If the file is missing or malformed.
      */
     SS_Model(const char*& input);
 
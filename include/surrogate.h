@@ -0,0 +1,86 @@
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "packed_swarm.h"
+
+/**
+ * @brief Represents a k-nearest-neighbour estimate of the fitness of bit strings, trained online.
+ *
+ * The last `capacity` evaluated solutions are kept packed 64 bits to a word, and a
+ * prediction is the mean fitness of the `k` stored solutions closest in Hamming
+ * distance, weighted by 1 / (1 + distance). A prediction costs a popcount per word of
+ * every stored solution, far less than simulating a schedule.
+ */
+class Surrogate {
+public:
+    /**
+     * @brief Constructor that sets the size of the memory and the neighbourhood.
+     * @param n The number of bits of a solution.
+     * @param capacity The number of solutions kept, the oldest being replaced first.
+     * @param k The number of neighbours a prediction averages.
+     */
+    Surrogate(int n, int capacity, int k = 5) : bits(n), words((n + 63) / 64), capacity(capacity), k(k), next(0) {}
+
+    /**
+     * @brief Learns the fitness of a solution.
+     * @param x The bits of the solution.
+     * @param fx Its fitness.
+     */
+    void add(const char* x, double fx) {
+        if ((int) values.size() < capacity) {
+            packed.resize(packed.size() + words);
+            values.push_back(0);
+        }
+        PackedSwarm::pack(x, bits, &packed[(size_t) next * words]);
+        values[next] = fx;
+        next = (next + 1) % capacity;
+    }
+
+    /**
+     * @brief Checks whether enough solutions were learnt to predict.
+     * @return `true` once `k` solutions are stored.
+     */
+    bool ready() const {
+        return (int) values.size() >= k;
+    }
+
+    /**
+     * @brief Predicts the fitness of a solution.
+     * @param x The bits of the solution.
+     * @return The estimate, only meaningful once `ready()`.
+     */
+    double predict(const char* x) const {
+        std::vector<uint64_t> q(words);
+        PackedSwarm::pack(x, bits, q.data());
+        std::vector<std::pair<int, double> > near;
+        near.reserve(values.size());
+        for (size_t s = 0; s < values.size(); s++) {
+            near.push_back(std::make_pair(PackedSwarm::distance(&packed[s * words], q.data(), words), values[s]));
+        }
+        int m = std::min<int>(k, near.size());
+        std::partial_sort(near.begin(), near.begin() + m, near.end());
+        double sum = 0, weight = 0;
+        for (int i = 0; i < m; i++) {
+            sum += near[i].second / (1 + near[i].first);
+            weight += 1.0 / (1 + near[i].first);
+        }
+        return weight > 0 ? sum / weight : 0;
+    }
+
+private:
+    int bits;                     /**< The number of bits of a solution. */
+    int words;                    /**< The number of words of a packed solution. */
+    int capacity;                 /**< The number of solutions kept. */
+    int k;                        /**< The number of neighbours a prediction averages. */
+    int next;                     /**< The slot the next solution goes to. */
+    std::vector<uint64_t> packed; /**< The stored solutions, `words` words each. */
+    std::vector<double> values;   /**< The fitness of each stored solution. */
+};
+
+#endif /* SURROGATE_H */
@@ -0,0 +1,122 @@
+#ifndef TABU_SEARCH_H
+#define TABU_SEARCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "binary_pso.h"
+
+/**
+ * @brief Represents tabu search over bit strings.
+ *
+ * Every iteration tries `neighbors` distinct single bit flips of the current solution
+ * and moves to the best of them even if it is worse, so the search walks out of local
+ * minima. A flipped bit stays tabu for `tenure` iterations, so the walk does not undo
+ * itself; a tabu flip is only taken if it beats the best solution found (aspiration).
+ * With `params.bounded` each flip is scored only as far as needed to show it cannot beat
+ * the best flip of the iteration so far.
+ */
+class TabuSearch : public Optimizer {
+public:
+    BinaryPSOParams params; /**< The parameters of the run. */
+    std::mt19937 rng;       /**< The random generator of the run. */
+
+    /**
+     * @brief Constructor that sets the parameters and the seed.
+     * @param p The parameters.
+     * @param seed The seed of the random generator.
+     */
+    TabuSearch(const BinaryPSOParams& p, unsigned seed) : params(p), rng(seed) {}
+
+    BinaryPSOResult Run(Objective& f) {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        int n = f.Size();
+        long long budget = std::max<long long>((long long) params.popsize * params.iterations, 1);
+        int tenure = params.tenure > 0 ? params.tenure : std::max(1, std::min(n - 1, 5 + n / 10));
+        int neighbors = std::min(n, params.neighbors > 0 ? params.neighbors : params.popsize);
+        BinaryPSOResult res;
+        res.evaluations = res.screened = res.relaxed = 0;
+        res.relaxed_gap = 0;
+        res.retired = 0;
+        res.duplicates = res.reseeded = 0;
+        res.key_seconds = 0;
+        res.diversity = 0;
+
+        std::vector<std::vector<char> > first(1, std::vector<char>(n));
+        for (int j = 0; j < n; j++) first[0][j] = rng() % 2;
+        Start(first);
+        std::vector<char> x = first[0];
+        double fx = BinaryPSO::Evaluate(f, x.data(), res);
+        res.best = fx;
+        res.xbest = x;
+        BinaryPSO::Improved(res, t0, res.best);
+
+        std::vector<long long> tabu(n, 0);
+        std::vector<int> order(n);
+        for (int j = 0; j < n; j++) order[j] = j;
+        for (long long iter = 1; res.evaluations < budget && neighbors > 0; iter++) {
+            int move = -1;
+            double best_y = std::numeric_limits<double>::infinity();
+            for (int k = 0; k < neighbors && res.evaluations < budget; k++) {
+                //! A partial shuffle draws distinct bits
+                std::swap(order[k], order[k + rng() % (n - k)]);
+                int j = order[k];
+                double cutoff = tabu[j] >= iter ? std::min(best_y, res.best) : best_y;
+                x[j] = !x[j];
+                double y = params.bounded ? BinaryPSO::Evaluate(f, x.data(), cutoff, res)
+                        : BinaryPSO::Evaluate(f, x.data(), res);
+                x[j] = !x[j];
+                if (y < cutoff) {
+                    best_y = y;
+                    move = j;
+                }
+            }
+            if (move >= 0) {
+                x[move] = !x[move];
+                fx = best_y;
+                tabu[move] = iter + tenure;
+                if (fx < res.best) {
+                    res.best = fx;
+                    res.xbest = x;
+                    BinaryPSO::Improved(res, t0, res.best);
+                }
+            }
+            if (trace) Record(iter, t0, res, fx, x);
+        }
+
+        res.mean_pbest = res.best;
+        res.swarm.assign(1, res.xbest);
+        res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return res;
+    }
+
+private:
+    /**
+     * @brief Sends the state after an iteration to the trace.
+     *
+     * There is one solution, so the objective columns hold the current fitness, the
+     * dispersion is the fraction of bits differing from the best solution, the velocity
+     * index and the diversity are 0 and there is one unique solution.
+     */
+    void Record(long long iter, std::chrono::steady_clock::time_point t0, const BinaryPSOResult& res, double fx,
+            const std::vector<char>& x) {
+        TraceRecord r = tag;
+        int n = x.size();
+        long long differ = 0;
+        for (int j = 0; j < n; j++) differ += x[j] != res.xbest[j];
+        r.iteration = (int32_t) iter;
+        r.gbest = r.mean_pbest = res.best;
+        r.min_obj = r.avg_obj = r.max_obj = fx;
+        r.dispersion = n ? (double) differ / n : 0;
+        r.vel_index = r.diversity = 0;
+        r.unique = 1;
+        r.evaluations = res.evaluations;
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        trace->record(r);
+    }
+};
+
+#endif /* TABU_SEARCH_H */
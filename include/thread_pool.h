@@ -0,0 +1,106 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Represents a fixed set of worker threads fed from one job queue.
+ *
+ * Jobs run in the order they were submitted. The workers live as long as the pool, so a
+ * driver can push any number of jobs without starting a thread per job.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;         /**< The worker threads. */
+    std::deque<std::function<void()> > jobs;  /**< The jobs not started yet. */
+    std::mutex lock;                          /**< Guards the queue and the counters. */
+    std::condition_variable has_job;          /**< Signalled when a job is queued or on shutdown. */
+    std::condition_variable idle;             /**< Signalled when the last running job ends. */
+    int running;                              /**< The number of jobs being run. */
+    bool stopping;                            /**< A flag telling the workers to exit. */
+
+    /**
+     * @brief Runs jobs until the pool is destroyed.
+     */
+    void work() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                has_job.wait(guard, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                running++;
+            }
+            job();
+            std::lock_guard<std::mutex> guard(lock);
+            if (--running == 0 && jobs.empty()) idle.notify_all();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor that starts the workers.
+     * @param threads The number of workers, or 0 for one per hardware thread.
+     */
+    explicit ThreadPool(int threads = 0) : running(0), stopping(false) {
+        if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < threads; i++) {
+            workers.push_back(std::thread(&ThreadPool::work, this));
+        }
+    }
+
+    /**
+     * @brief Destructor that finishes the queued jobs and joins the workers.
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        has_job.notify_all();
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Gets the number of workers.
+     * @return The number of workers.
+     */
+    int size() const {
+        return workers.size();
+    }
+
+    /**
+     * @brief Queues a job.
+     *
+     * A job must not throw; catch errors inside the job and record them.
+     *
+     * @param job The job.
+     */
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            jobs.push_back(std::move(job));
+        }
+        has_job.notify_one();
+    }
+
+    /**
+     * @brief Waits until every queued job has ended.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this] { return running == 0 && jobs.empty(); });
+    }
+};
+
+#endif /* THREAD_POOL_H */
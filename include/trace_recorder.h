@@ -0,0 +1,132 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Represents the state of a swarm after one iteration.
+ */
+struct TraceRecord {
+    int32_t run;           /**< The run, such as the instance of a batch. */
+    int32_t restart;       /**< The restart within the run. */
+    int32_t island;        /**< The island of an island-model run, 0 for a single swarm. */
+    int32_t iteration;     /**< The iteration, counting the initial evaluation as 1. */
+    double gbest;          /**< The best fitness so far. */
+    double mean_pbest;     /**< The mean of the personal bests. */
+    double dispersion;     /**< The mean distance of the positions to the global best. */
+    double vel_index;      /**< The mean absolute velocity. */
+    double min_obj;        /**< The best fitness of this iteration. */
+    double avg_obj;        /**< The mean fitness of this iteration. */
+    double max_obj;        /**< The worst fitness of this iteration. */
+    int64_t evaluations;   /**< The evaluations since the start of the restart. */
+    double seconds;        /**< The wall time since the start of the restart. */
+    double diversity;      /**< The mean fraction of bits in which two positions differ, 0 if not measured. */
+    int32_t unique;        /**< The number of distinct positions, 0 if not measured. */
+};
+
+/**
+ * @brief Records convergence traces without slowing the runs that produce them.
+ *
+ * Any number of threads call `record()`, which only claims a slot of a fixed ring buffer
+ * and copies the record into it: no lock, no allocation and no I/O. A background thread
+ * drains the ring and writes CSV, or fixed-size binary records when the file name ends in
+ * `.bin`. If the writer falls behind and the ring is full, records are dropped and
+ * counted rather than making the caller wait.
+ */
+class TraceRecorder {
+public:
+    static const int VERSION = 2;       /**< The version of the binary format. */
+    static const int RECORD_SIZE = 104; /**< The size of a binary record in bytes. */
+
+    /**
+     * @brief Constructor that opens the output and starts the writer.
+     * @param file The path of the output, CSV unless it ends in `.bin`.
+     * @param capacity The number of records the ring holds, rounded up to a power of two.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    explicit TraceRecorder(const std::string& file, size_t capacity = 1 << 16);
+
+    /**
+     * @brief Destructor that writes the remaining records and closes the output.
+     */
+    ~TraceRecorder();
+
+    /**
+     * @brief Queues a record.
+     * @param r The record.
+     * @return `false` if the ring was full and the record was dropped.
+     */
+    bool record(const TraceRecord& r);
+
+    /**
+     * @brief Stops the writer after it has written every queued record.
+     */
+    void close();
+
+    /**
+     * @brief Gets the number of records dropped because the ring was full.
+     * @return The number of dropped records.
+     */
+    long long dropped() const {
+        return lost.load();
+    }
+
+    /**
+     * @brief Reads a binary trace back.
+     * @param file The path of the trace.
+     * @param records The list the records are appended to.
+     * @throws std::runtime_error If the file is not a complete binary trace.
+     */
+    static void read(const char* file, std::vector<TraceRecord>& records);
+
+private:
+    /**
+     * @brief Represents one slot of the ring.
+     */
+    struct Cell {
+        std::atomic<size_t> seq; /**< The position the slot is ready for. */
+        TraceRecord rec;         /**< The record. */
+    };
+
+    Cell* cells;                     /**< The ring. */
+    size_t mask;                     /**< The capacity minus one. */
+    char pad0[64];                   /**< Keeps the producers' position off the writer's cache line. */
+    std::atomic<size_t> head;        /**< The next position to write, shared by the producers. */
+    char pad1[64];                   /**< Keeps the writer's position off the producers' cache line. */
+    size_t tail;                     /**< The next position to read, owned by the writer. */
+    std::atomic<long long> lost;     /**< The number of dropped records. */
+    std::atomic<bool> stopping;      /**< Tells the writer to finish. */
+    FILE* out;                       /**< The output. */
+    bool binary;                     /**< Whether the output is binary. */
+    std::string buf;                 /**< The bytes not written yet. */
+    std::thread writer;              /**< The background writer. */
+
+    /**
+     * @brief Takes the next record off the ring.
+     * @param r The record.
+     * @return `false` if the ring is empty.
+     */
+    bool pop(TraceRecord& r);
+
+    /**
+     * @brief Formats one record into the output buffer.
+     * @param r The record.
+     */
+    void format(const TraceRecord& r);
+
+    /**
+     * @brief Drains the ring until the recorder is closed.
+     */
+    void drain();
+
+    TraceRecorder(const TraceRecorder&);
+    TraceRecorder& operator=(const TraceRecorder&);
+};
+
+#endif /* TRACE_RECORDER_H */
@@ -0,0 +1,43 @@
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include <set>
+#include <vector>
+
+#include "all_model.h"
+#include "binary_pso.h"
+
+/**
+ * @brief Carries the outcome of a run over to a slightly changed instance of the same yard.
+ *
+ * The best solution and the final swarm are remapped with `All_Model::remap_genome()`,
+ * the best first, and solutions that remap to the same genome are kept once. Set the
+ * result as `Optimizer::start` of the run on the new instance: it starts from the old
+ * decisions instead of random genomes, so far fewer iterations reach the same quality.
+ *
+ * @param from The master model of the old instance, only read.
+ * @param to The master model of the new instance, only read.
+ * @param joint `true` for joint genomes, otherwise short-span genomes.
+ * @param res The outcome of the run on the old instance.
+ * @return The starting solutions on the new instance.
+ */
+inline std::vector<std::vector<char> > warm_start(All_Model& from, All_Model& to, bool joint, const BinaryPSOResult& res) {
+    std::vector<const std::vector<char>*> old(1, &res.xbest);
+    for (const std::vector<char>& x : res.swarm) old.push_back(&x);
+    int n = joint ? to.get_joint_bit_size() : to.get_bit_size();
+    std::vector<std::vector<char> > start;
+    std::set<std::vector<char> > seen;
+    for (const std::vector<char>* x : old) {
+        std::vector<char> y(n, 0);
+        std::vector<char> copy(*x);
+        All_Model* a = from.clone();
+        All_Model* b = to.clone();
+        b->remap_genome(*a, copy.data(), joint, y.data());
+        delete a;
+        delete b;
+        if (seen.insert(y).second) start.push_back(y);
+    }
+    return start;
+}
+
+#endif /* WARM_START_H */
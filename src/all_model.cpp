@@ -1,29 +1,112 @@
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <limits.h>
 
 #include <string>
 #include <stack>
 #include <limits>
 #include <iostream>
 #include <algorithm>
+#include <stdexcept>
 
 #include "function.h"
+#include "instance_reader.h"
+#include "binary_instance.h"
 #include "all_model.h"
+#include "instrument.h"
 
 #include "linear_graph.h"
+#include "rail_schedule.h"
+#include "schedule_sink.h"
+#include "schedule_validator.h"
+
+static ScheduleEvent make_event(int type, int crane, int mode, bool loaded, int container, int area,
+        int from_h, int from_w, int from_l, int to_h, int to_w, int to_l, double start, double duration) {
+    ScheduleEvent e = {type, crane, mode, loaded, container, area, from_h, from_w, from_l, to_h, to_w, to_l, start, duration};
+    return e;
+}
+
+static void appendf(std::string& buf, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string& buf, const char* format, ...) {
+    char line[128];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof line, format, args);
+    va_end(args);
+    if (n > 0) buf.append(line, std::min(n, (int) sizeof line - 1));
+}
 
 All_Model::All_Model() {
 }
 
 All_Model::All_Model(const char*& input) {
-    load_data(input);
+    try {
+        if (is_binary_instance(input)) {
+            load_binary(input);
+            return;
+        }
+        load_data(input);
+    } catch (...) {
+        //! The destructor does not run when a constructor throws
+        for (auto& it : cc_containers) delete it.second;
+        for (auto& it : areas) delete it.second;
+        throw;
+    }
+    analyze();
+    calculate_malloc_size();
+}
+
+All_Model::All_Model(const AllModelData& data) {
+    H = data.H;
+    W = data.W;
+    L = data.L;
+    table.resize(W);
+    for (int i = 0; i < W; i++) {
+        table[i].resize(L);
+    }
+    last_cc_container = -1;
+    for (auto& it : data.containers) {
+        cc_containers.insert(std::make_pair(it.first, new dat(it.second._h, it.second._w, it.second._l)));
+        last_cc_container = it.first;
+    }
+    for (size_t i = 0; i < data.areas.size(); i++) {
+        areas.insert(std::make_pair((int) i, new dat(data.areas[i]._h, data.areas[i]._w, data.areas[i]._l)));
+    }
+    res_ss = data.res_ss;
+    imp_ss = data.imp_ss;
+    exp_ss = data.exp_ss;
+    res_ls = data.res_ls;
+    imp_ls = data.imp_ls;
+    exp_ls = data.exp_ls;
     analyze();
     calculate_malloc_size();
 }
 
+AllModelData All_Model::get_data() const {
+    AllModelData d;
+    d.H = H;
+    d.W = W;
+    d.L = L;
+    for (auto& it : cc_containers) {
+        d.containers.insert(std::make_pair(it.first, *it.second));
+    }
+    for (auto& it : areas) {
+        d.areas.push_back(*it.second);
+    }
+    d.res_ss = res_ss;
+    d.imp_ss = imp_ss;
+    d.exp_ss = exp_ss;
+    d.res_ls = res_ls;
+    d.imp_ls = imp_ls;
+    d.exp_ls = exp_ls;
+    return d;
+}
+
 All_Model::~All_Model() {
     for (auto& it : cc_containers) {
         if (it.second) {
@@ -54,66 +137,261 @@ All_Model::~All_Model() {
 }
 
 void All_Model::load_data(const char* file) {
-    FILE *ptr = NULL;
-    ptr = fopen(file, "r");
-    if (ptr) {
-        int n;
-        int x, y, z;
-        //! Read H W L
-        fscanf(ptr, "%d %d %d", &H, &W, &L);
-        table.resize(W);
-        for (int i = 0; i < W; i++) {
-            table[i].resize(L);
-        }
-        //! Read Containers
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d %d %d", &x, &y, &z);
-            dat* _a = new dat(x, y, z);
-            cc_containers.insert(std::make_pair(i, _a));
-            last_cc_container = i;
-        }
-        //! Read Areas
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d %d %d", &x, &y, &z);
-            dat* _a = new dat(x, y, z);
-            areas.insert(std::make_pair(i, _a));
-        }
-        int t;
-        //! Read Res SS
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d", &t);
-            res_ss.insert(t);
-        }
-        //! Number of IMP SS
-        fscanf(ptr, "%d", &imp_ss);
-        //! Number of EXP SS
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d", &t);
-            exp_ss.insert(t);
-        }
-        //! Read Res LS
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d", &t);
-            res_ls.insert(t);
-        }
-        //! Number of IMP LS
-        fscanf(ptr, "%d", &imp_ls);
-        //! Number of EXP LS
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d", &t);
-            exp_ls.insert(t);
-        }
-    }
-    fclose(ptr);
-}
-
-void All_Model::analyze() {
+    InstanceReader in(file);
+    int n;
+    int x, y, z;
+    //! Read H W L
+    H = in.next_int("H", 1, INT_MAX);
+    W = in.next_int("W", 1, INT_MAX);
+    L = in.next_int("L", 1, INT_MAX);
+    table.resize(W);
+    for (int i = 0; i < W; i++) {
+        table[i].resize(L);
+    }
+    //! Read Containers
+    n = in.next_int("container count", 0, INT_MAX);
+    for (int i = 0; i < n; i++) {
+        x = in.next_int("container h", 0, H - 1);
+        y = in.next_int("container w", -1, W - 1);
+        z = in.next_int("container l", -1, L - 1);
+        dat* _a = new dat(x, y, z);
+        cc_containers.insert(std::make_pair(i, _a));
+        last_cc_container = i;
+    }
+    int containers = n;
+    //! Read Areas
+    n = in.next_int("area count", 0, INT_MAX);
+    for (int i = 0; i < n; i++) {
+        x = in.next_int("area h", 0, H - 1);
+        y = in.next_int("area w", 0, W - 1);
+        z = in.next_int("area l", 0, L - 1);
+        dat* _a = new dat(x, y, z);
+        areas.insert(std::make_pair(i, _a));
+    }
+    //! Read Res SS
+    n = in.next_int("res ss count", 0, containers);
+    for (int i = 0; i < n; i++) {
+        res_ss.insert(in.next_int("res ss container", 0, containers - 1));
+    }
+    //! Number of IMP SS
+    imp_ss = in.next_int("imp ss count", 0, INT_MAX);
+    //! Number of EXP SS
+    n = in.next_int("exp ss count", 0, containers);
+    for (int i = 0; i < n; i++) {
+        exp_ss.insert(in.next_int("exp ss container", 0, containers - 1));
+    }
+    //! Read Res LS
+    n = in.next_int("res ls count", 0, containers);
+    for (int i = 0; i < n; i++) {
+        res_ls.insert(in.next_int("res ls container", 0, containers - 1));
+    }
+    //! Number of IMP LS
+    imp_ls = in.next_int("imp ls count", 0, INT_MAX);
+    //! Number of EXP LS
+    n = in.next_int("exp ls count", 0, containers);
+    for (int i = 0; i < n; i++) {
+        exp_ls.insert(in.next_int("exp ls container", 0, containers - 1));
+    }
+}
+
+void All_Model::save_binary(const char* file) const {
+    BinaryInstanceWriter out;
+    out.put(H);
+    out.put(W);
+    out.put(L);
+    out.put(last_cc_container);
+    out.put(imp_ss);
+    out.put(imp_ls);
+    //! Bit layout
+    out.put(res_ss_steps);
+    out.put(res_ls_steps);
+    out.put(imp_ss_steps);
+    out.put(exp_ss_steps);
+    out.put(max_ss_steps);
+    out.put(total_ss_steps);
+    out.put(imp_ls_steps);
+    out.put(exp_ls_steps);
+    out.put(max_ls_steps);
+    out.put(total_ls_steps);
+    out.put(res_ss_bits);
+    out.put(res_ls_bits);
+    out.put(ss_bits);
+    out.put(ls_bits);
+    out.put(ss_allocate_size);
+    out.put(ls_allocate_size);
+    out.put(allocate_size);
+    //! Raw data
+    std::vector<int> v;
+    for (auto& it : cc_containers) {
+        v.push_back(it.second->_h);
+        v.push_back(it.second->_w);
+        v.push_back(it.second->_l);
+    }
+    out.put(v);
+    v.clear();
+    for (auto& it : areas) {
+        v.push_back(it.second->_h);
+        v.push_back(it.second->_w);
+        v.push_back(it.second->_l);
+    }
+    out.put(v);
+    out.put(std::vector<int>(res_ss.begin(), res_ss.end()));
+    out.put(std::vector<int>(exp_ss.begin(), exp_ss.end()));
+    out.put(std::vector<int>(res_ls.begin(), res_ls.end()));
+    out.put(std::vector<int>(exp_ls.begin(), exp_ls.end()));
+    //! Stack table as W*L heights followed by the stacked containers
+    std::vector<int> heights, stacks;
+    for (int i = 0; i < W; i++) {
+        for (int j = 0; j < L; j++) {
+            heights.push_back(table[i][j].size());
+            stacks.insert(stacks.end(), table[i][j].begin(), table[i][j].end());
+        }
+    }
+    out.put(heights);
+    out.put(stacks);
+    //! Pools
+    out.put(area_pool);
+    out.put(imp_ss_pool);
+    out.put(imp_ls_pool);
+    out.put(exp_ss_pool);
+    out.put(exp_ls_pool);
+    out.put(res_ss_pool);
+    out.put(res_ls_pool);
+    out.save(file);
+}
+
+void All_Model::load_binary(const char* file) {
+    BinaryInstanceReader in(file);
+    size_t at = in.offset();
+    H = in.next();
+    W = in.next();
+    L = in.next();
+    if (H <= 0 || W <= 0 || L <= 0) {
+        in.fail("invalid dimensions in binary instance", at);
+    }
+    size_t last_at = in.offset();
+    last_cc_container = in.next();
+    at = in.offset();
+    imp_ss = in.next();
+    imp_ls = in.next();
+    if (imp_ss < 0 || imp_ls < 0) {
+        in.fail("negative import count in binary instance", at);
+    }
+    //! The genome layout is stored for completeness but recomputed below, the evaluators index by it
+    size_t layout_at = in.offset();
+    int layout[17];
+    for (int& v : layout) v = in.next();
+
+    //! Every id and coordinate is checked here, later lookups trust them
+    int n;
+    const int32_t* p;
+    auto check = [&](const char* what, int i, int lo, int hi) {
+        if (p[i] < lo || p[i] > hi) {
+            in.fail(std::string(what) + " = " + std::to_string(p[i]) + " is out of range [" +
+                    std::to_string(lo) + ", " + std::to_string(hi) + "]", at + (i + 1) * sizeof(int32_t));
+        }
+    };
+    at = in.offset();
+    p = in.next_array(n);
+    if (n % 3 != 0) {
+        in.fail("container array of " + std::to_string(n) + " values is not a list of (h, w, l)", at);
+    }
+    for (int i = 0; i < n; i += 3) {
+        check("container h", i, 0, H - 1);
+        check("container w", i + 1, -1, W - 1);
+        check("container l", i + 2, -1, L - 1);
+        cc_containers.insert(std::make_pair(i / 3, new dat(p[i], p[i + 1], p[i + 2])));
+    }
+    int containers = n / 3;
+    at = in.offset();
+    p = in.next_array(n);
+    if (n % 3 != 0) {
+        in.fail("area array of " + std::to_string(n) + " values is not a list of (h, w, l)", at);
+    }
+    for (int i = 0; i < n; i += 3) {
+        check("area h", i, 0, H - 1);
+        check("area w", i + 1, 0, W - 1);
+        check("area l", i + 2, 0, L - 1);
+        areas.insert(std::make_pair(i / 3, new dat(p[i], p[i + 1], p[i + 2])));
+    }
+    int area_count = n / 3;
+    std::set<int>* sets[] = {&res_ss, &exp_ss, &res_ls, &exp_ls};
+    const char* names[] = {"res ss container", "exp ss container", "res ls container", "exp ls container"};
+    for (int k = 0; k < 4; k++) {
+        at = in.offset();
+        p = in.next_array(n);
+        for (int i = 0; i < n; i++) check(names[k], i, 0, containers - 1);
+        sets[k]->insert(p, p + n);
+    }
+    int* fields[] = {&res_ss_steps, &res_ls_steps, &imp_ss_steps, &exp_ss_steps, &max_ss_steps, &total_ss_steps,
+            &imp_ls_steps, &exp_ls_steps, &max_ls_steps, &total_ls_steps, &res_ss_bits, &res_ls_bits, &ss_bits,
+            &ls_bits, &ss_allocate_size, &ls_allocate_size, &allocate_size};
+    const char* field_names[] = {"res_ss_steps", "res_ls_steps", "imp_ss_steps", "exp_ss_steps", "max_ss_steps",
+            "total_ss_steps", "imp_ls_steps", "exp_ls_steps", "max_ls_steps", "total_ls_steps", "res_ss_bits",
+            "res_ls_bits", "ss_bits", "ls_bits", "ss_allocate_size", "ls_allocate_size", "allocate_size"};
+    calculate_malloc_size();
+    for (int k = 0; k < 17; k++) {
+        if (*fields[k] != layout[k]) {
+            in.fail(std::string(field_names[k]) + " = " + std::to_string(layout[k]) + " does not match the instance, which needs "
+                    + std::to_string(*fields[k]), layout_at + k * sizeof(int32_t));
+        }
+    }
+    if (last_cc_container != containers - 1) {
+        in.fail("last container id " + std::to_string(last_cc_container) + " does not match the " +
+                std::to_string(containers) + " containers", last_at);
+    }
+
+    int cells, total;
+    size_t heights_at = in.offset();
+    const int32_t* heights = in.next_array(cells);
+    at = in.offset();
+    const int32_t* stacks = in.next_array(total);
+    if (cells != W * L) {
+        in.fail("stack table does not match W*L", heights_at);
+    }
+    p = stacks;
+    std::vector<char> stacked(containers, 0);
+    table.resize(W);
+    for (int i = 0, k = 0; i < W; i++) {
+        table[i].resize(L);
+        for (int j = 0; j < L; j++) {
+            int h = heights[i * L + j];
+            if (h < 0 || h > H || h > total - k) {
+                in.fail("stack height " + std::to_string(h) + " is out of bounds", heights_at + (i * L + j + 1) * sizeof(int32_t));
+            }
+            //! A stack lists its containers by height, with -1 below the top where one was taken out
+            for (int z = 0; z < h; z++, k++) {
+                if (stacks[k] == -1 && z + 1 < h) continue;
+                check("stacked container", k, 0, containers - 1);
+                const dat* c = cc_containers[stacks[k]];
+                if (stacked[stacks[k]] || c->_h != z || c->_w != i || c->_l != j) {
+                    in.fail("stacked container " + std::to_string(stacks[k]) + " is not at (" + std::to_string(z) + ", " +
+                            std::to_string(i) + ", " + std::to_string(j) + ")", at + (k + 1) * sizeof(int32_t));
+                }
+                stacked[stacks[k]] = 1;
+            }
+            table[i][j].assign(stacks + k - h, stacks + k);
+        }
+    }
+    for (auto& it : cc_containers) {
+        if (it.second->_w >= 0 && !stacked[it.first]) {
+            in.fail("container " + std::to_string(it.first) + " is in the yard but on no stack", heights_at);
+        }
+    }
+    std::vector<int>* pools[] = {&area_pool, &imp_ss_pool, &imp_ls_pool, &exp_ss_pool, &exp_ls_pool, &res_ss_pool, &res_ls_pool};
+    const char* pool_names[] = {"area pool id", "imp ss pool id", "imp ls pool id", "exp ss pool id", "exp ls pool id",
+            "res ss pool id", "res ls pool id"};
+    int limits[] = {area_count, imp_ss, imp_ls, containers, containers, containers, containers};
+    for (int k = 0; k < 7; k++) {
+        at = in.offset();
+        in.next_array(*pools[k]);
+        p = pools[k]->data();
+        for (int i = 0; i < (int) pools[k]->size(); i++) check(pool_names[k], i, 0, limits[k] - 1);
+    }
+}
+
+void All_Model::analyze(bool solved) {
+    PSO_TIME(TIME_ANALYZE);
     std::vector<std::pair<int, dat*> > pairs;
     for (auto itr = cc_containers.begin(); itr != cc_containers.end(); ++itr) {
         pairs.push_back(*itr);
@@ -122,8 +400,16 @@ void All_Model::analyze() {
         return a.second->_h < b.second->_h;
     });
     for (auto& it : pairs) {
-        if (it.second->_w >= 0 && it.second->_l >= 0) {
-            table[it.second->_w][it.second->_l].push_back(it.first);
+        dat* c = it.second;
+        if (c->_w >= 0 && c->_l >= 0) {
+            std::vector<int>& stack = table[c->_w][c->_l];
+            if (!solved) {
+                stack.push_back(it.first);
+                continue;
+            }
+            //! A solved yard has holes where exports were taken out
+            if ((int) stack.size() <= c->_h) stack.resize(c->_h + 1, -1);
+            stack[c->_h] = it.first;
         }
     }
     for (int i = 0; i < imp_ss; i++) {
@@ -139,6 +425,9 @@ void All_Model::analyze() {
         exp_ls_pool.push_back(it);
     }
     for (auto& it : areas) {
+        //! A slot that has been filled since it was listed is no longer free
+        const std::vector<int>& stack = table[it.second->_w][it.second->_l];
+        if (solved && it.second->_h < (int) stack.size() && stack[it.second->_h] >= 0) continue;
         area_pool.push_back(it.first);
     }
     for (int i = 0; i < W; i++) {
@@ -163,13 +452,27 @@ void All_Model::ls_analyze() {
     std::vector<int>::iterator it = area_pool.begin();
     while (it != area_pool.end()) {
         if (mark[areas[*it]->_w][areas[*it]->_l]) {
-            area_pool.erase(it);
+            it = area_pool.erase(it);
         } else {
             ++it;
         }
     }
 }
 
+void All_Model::reanalyze() {
+    for (auto& row : table) {
+        for (auto& stack : row) stack.clear();
+    }
+    imp_ss_pool.clear();
+    imp_ls_pool.clear();
+    exp_ss_pool.clear();
+    exp_ls_pool.clear();
+    area_pool.clear();
+    res_ss_pool.clear();
+    res_ls_pool.clear();
+    analyze(true);
+}
+
 int All_Model::calculate_malloc_size() {
     int sbit = 0;
     int all = W*L;
@@ -195,8 +498,8 @@ int All_Model::calculate_malloc_size() {
     exp_ls_steps = exp_ls.size();
     max_ls_steps = std::max(imp_ls_steps, exp_ls_steps);
     total_ls_steps = imp_ls_steps + exp_ls_steps;
-    ss_bits = (1 + decimal_2_binary_size(max_ls_steps) + decimal_2_binary_size(all)) * (total_ls_steps);
-    sbit += ss_bits;
+    ls_bits = (1 + decimal_2_binary_size(max_ls_steps) + decimal_2_binary_size(all)) * (total_ls_steps);
+    sbit += ls_bits;
     ls_allocate_size = sbit;
 
     if( ss_allocate_size > ls_allocate_size ){
@@ -208,6 +511,8 @@ int All_Model::calculate_malloc_size() {
 }
 
 All_Model* All_Model::clone() {
+    PSO_COUNT(COUNT_CLONE);
+    PSO_TIME(TIME_CLONE);
     All_Model *m = new All_Model();
 
     m->W = this->W;
@@ -261,6 +566,7 @@ All_Model* All_Model::clone() {
 }
 
 int All_Model::pop_area_pool(int idx) {
+    PSO_COUNT(COUNT_AREA_POP);
     int a = area_pool[idx];
     if (areas[a]->_h + 1 < H) {
         int n = areas.size();
@@ -274,9 +580,12 @@ int All_Model::pop_area_pool(int idx) {
 }
 
 int All_Model::pop_res_ss_pool(int idx) {
+    PSO_COUNT(COUNT_RES_POP);
     int r = res_ss_pool[idx];
-    int nt = table[cc_containers[r]->_w][cc_containers[r]->_l][cc_containers[r]->_h - 1];
-    if (cc_containers[r]->_h - 1 >= 0 && res_ss.find(nt) != res_ss.end()) {
+    int h = cc_containers[r]->_h;
+    //! The container below becomes the top of the stack, if there is one
+    int nt = h > 0 ? table[cc_containers[r]->_w][cc_containers[r]->_l][h - 1] : -1;
+    if (nt >= 0 && res_ss.find(nt) != res_ss.end()) {
         res_ss_pool[idx] = nt;
     } else {
         if(res_ss_pool.size() > 0) res_ss_pool[idx] = res_ss_pool[res_ss_pool.size() - 1];
@@ -286,9 +595,12 @@ int All_Model::pop_res_ss_pool(int idx) {
 }
 
 int All_Model::pop_res_ls_pool(int idx) {
+    PSO_COUNT(COUNT_RES_POP);
     int r = res_ls_pool[idx];
-    int nt = table[cc_containers[r]->_w][cc_containers[r]->_l][cc_containers[r]->_h - 1];
-    if (cc_containers[r]->_h - 1 >= 0 && res_ls.find(nt) != res_ls.end()) {
+    int h = cc_containers[r]->_h;
+    //! The container below becomes the top of the stack, if there is one
+    int nt = h > 0 ? table[cc_containers[r]->_w][cc_containers[r]->_l][h - 1] : -1;
+    if (nt >= 0 && res_ls.find(nt) != res_ls.end()) {
         res_ls_pool[idx] = nt;
     } else {
         if(res_ls_pool.size() > 0) res_ls_pool[idx] = res_ls_pool[res_ls_pool.size() - 1];
@@ -298,6 +610,7 @@ int All_Model::pop_res_ls_pool(int idx) {
 }
 
 int All_Model::pop_pool(std::vector<int>& pool, int idx) {
+    PSO_COUNT(COUNT_POOL_POP);
     int r = pool[idx];
     pool[idx] = pool[pool.size() - 1];
     pool.pop_back();
@@ -310,7 +623,7 @@ void All_Model::find_res() {
             for (int k = 0; k < table[i][j].size(); k++) {
                 if (exp_ss.find(table[i][j][k]) != exp_ss.end()) {
                     for (int l = k + 1; l < table[i][j].size(); l++) {
-                        res_ss.insert(table[i][j][l]);
+                        if (table[i][j][l] >= 0) res_ss.insert(table[i][j][l]);
                     }
                     break;
                 }
@@ -320,14 +633,29 @@ void All_Model::find_res() {
 }
 
 double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
+    return ss_solve(x, edited, edited, std::numeric_limits<double>::infinity());
+}
+
+double All_Model::fx_function_solve_bounded(char* x, double cutoff) {
+    return ss_solve(x, false, false, cutoff);
+}
+
+double All_Model::ss_solve(char* x, bool record, bool verbose, double cutoff, int steps, MovePrefix* prefix) {
+    PSO_COUNT(COUNT_SS_SOLVE);
+    PSO_TIME(TIME_SS_SOLVE);
     int counter = 0;
     double y = 0;
+    ss_travel = 0;
     int start = 0;
     int all = W*L;
     int last_x = -1;
     int last_y = -1;
 
-    if (edited) {
+    //! Without a sink the schedule goes to stdout as text, as it always has
+    TextScheduleSink text(stdout);
+    ScheduleSink* out = (record && verbose) ? (sink ? sink : &text) : NULL;
+
+    if (record) {
         mark.resize(W);
         for (int i = 0; i < W; i++) {
             mark[i].resize(L);
@@ -341,7 +669,17 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
     int all_bit = decimal_2_binary_size(all);
     int front_num = (int) pow(2, res_ss_bit);
     int last_num = (int) pow(2, all_bit);
+    int total_ss_steps = imp_ss_steps + exp_ss_steps;
     for (int i = 0; i < res_ss_steps; i++) {
+        if (i == steps) {
+            describe_prefix(*prefix, false, i, start, y, last_x);
+            return y;
+        }
+        double bound = y + remaining_bound(false, res_ss_steps - i, total_ss_steps);
+        if (bound >= cutoff) {
+            PSO_COUNT(COUNT_BOUND_ABORT);
+            return bound;
+        }
         int res_it = binary_2_decimal(res_ss_bit, x + start);
         start += res_ss_bit;
         int area_it = binary_2_decimal(all_bit, x + start);
@@ -355,30 +693,32 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
         double duration = 0;
         if (last_x != _x || last_y != _y) {
             duration = (abs(last_x - _x) * TRAVEL_TIME);
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, last_x, _x));
                 ss_graph.back()->set_mode(0, counter);
-                printf("MOVE FROM %d, %d TO %d, %d (%lf + %lf -> %lf)\n", last_x, last_y, _x, _y, y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_MOVE, 0, 0, false, r, a, -1, last_x, last_y,
+                        cc_containers[r]->_h, _x, _y, y, duration));
             }
             y += duration;
+            ss_travel += duration;
             last_x = _x;
             last_y = _y;
         }
         duration = CONTROL_TIME;
-        if (edited) {
+        if (record) {
             ss_graph.push_back(new StableTimeGraph((int) y, (int) y + duration, _x));
             ss_graph.back()->set_mode(0, counter);
-            printf("PICK %d (%lf + %lf -> %lf)\n", r + 1, y, duration, y + duration);
+            if (out) out->emit(make_event(EVENT_PICK, 0, 0, false, r, a, cc_containers[r]->_h, _x, _y,
+                    cc_containers[r]->_h, _x, _y, y, duration));
         }
         y += duration;
         duration = (abs(areas[a]->_w - cc_containers[r]->_w) * TRAVEL_TIME);
-         if (edited){
+         if (record) {
             ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, _x, areas[a]->_w));
             ss_graph.back()->set_mode(0, counter);
-            printf("Move %d( %d, %d, %d ) to ( %d, %d, %d ) (%lf + %lf -> %f)\n", r + 1,
-                cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
-                areas[a]->_h, areas[a]->_w, areas[a]->_l,
-                y, duration, y + duration);
+            if (out) out->emit(make_event(EVENT_MOVE, 0, 0, true, r, a,
+                    cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
+                    areas[a]->_h, areas[a]->_w, areas[a]->_l, y, duration));
             mark[cc_containers[r]->_w][cc_containers[r]->_l] = true;
             mark[areas[a]->_w][areas[a]->_l] = true;
         }
@@ -386,11 +726,13 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
         cc_containers[r]->_w = areas[a]->_w;
         cc_containers[r]->_l = areas[a]->_l;
         y += duration;
+        ss_travel += duration;
         duration = CONTROL_TIME;
-        if (edited) {
+        if (record) {
             ss_graph.push_back(new StableTimeGraph((int) y, (int) y + duration, areas[a]->_w));
             ss_graph.back()->set_mode(0, counter++);
-            printf("DROP %d (%lf + %lf -> %lf)\n", r + 1, y, duration, y + duration);
+            if (out) out->emit(make_event(EVENT_DROP, 0, 0, false, r, a, areas[a]->_h, areas[a]->_w, areas[a]->_l,
+                    areas[a]->_h, areas[a]->_w, areas[a]->_l, y, duration));
         }
         y += duration;
         last_x = areas[a]->_w;
@@ -404,8 +746,16 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
     int last_bit = decimal_2_binary_size(all);
     front_num = (int) pow(2, front_bit);
     last_num = (int) pow(2, last_bit);
-    int total_ss_steps = imp_ss_steps + exp_ss_steps;
     for (int i = 0; i < total_ss_steps; i++) {
+        if (res_ss_steps + i == steps) {
+            describe_prefix(*prefix, false, res_ss_steps + i, start, y, last_x);
+            return y;
+        }
+        double bound = y + remaining_bound(false, 0, total_ss_steps - i);
+        if (bound >= cutoff) {
+            PSO_COUNT(COUNT_BOUND_ABORT);
+            return bound;
+        }
         int it, area_it;
         char opd = x[start++];
         it = binary_2_decimal(front_bit, x + start);
@@ -421,38 +771,39 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
             double duration = 0;
             if (last_x != -1) {
                 duration = ((last_x + 1) * TRAVEL_TIME);
-                if (edited) {
+                if (record) {
                     ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, last_x, -1));
                     ss_graph.back()->set_mode(1, counter);
-                    printf("IMP MOVE FROM %d, %d TO SS (%lf + %lf -> %lf)\n", last_x, last_y, y, duration, y + duration);
+                    if (out) out->emit(make_event(EVENT_MOVE, 0, 1, false, r, a, -1, last_x, last_y, -1, -1, -1, y, duration));
                 }
                 y += duration;
+                ss_travel += duration;
             }
             duration = CONTROL_TIME;
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new StableTimeGraph((int) y, (int) y + duration, -1));
                 ss_graph.back()->set_mode(1, counter);
-                printf("PICK IMP-%d (%lf + %lf -> %lf)\n", r + 1, y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_PICK, 0, 1, false, r, a, -1, -1, -1, -1, -1, -1, y, duration));
             }
             y += duration;
             duration = ((areas[a]->_w + 1) * TRAVEL_TIME);
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, -1, areas[a]->_w));
                 ss_graph.back()->set_mode(1, counter);
-                printf("IMP MOVE IMP-%d TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n",
-                        r + 1, a + 1, areas[a]->_h, areas[a]->_w, areas[a]->_l,
-                        y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_MOVE, 0, 1, true, r, a, -1, -1, -1,
+                        areas[a]->_h, areas[a]->_w, areas[a]->_l, y, duration));
                 mark[areas[a]->_w][areas[a]->_l] = true;
                 dat* _a = new dat(areas[a]->_h, areas[a]->_w, areas[a]->_l);
                 cc_containers.insert(std::make_pair(++last_cc_container, _a));
             }
             y += duration;
+            ss_travel += duration;
             duration = CONTROL_TIME;
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new StableTimeGraph((int) y, (int) y + duration, areas[a]->_w));
                 ss_graph.back()->set_mode(1, counter++);
-                printf("DROP IMP-%d (%lf + %lf -> %lf)\n", r + 1,
-                        y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_DROP, 0, 1, false, r, a, areas[a]->_h, areas[a]->_w, areas[a]->_l,
+                        areas[a]->_h, areas[a]->_w, areas[a]->_l, y, duration));
             }
             y += duration;
             last_x = areas[a]->_w;
@@ -464,38 +815,42 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
             double duration = 0;
             if (last_x != cc_containers[r]->_w || last_y != cc_containers[r]->_l){
                 duration = (abs(cc_containers[r]->_w - last_x) * TRAVEL_TIME);
-                 if (edited){
+                 if (record) {
                     ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, last_x, cc_containers[r]->_w));
                     ss_graph.back()->set_mode(2, counter);
-                    printf("EXP MOVE FROM %d, %d TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n",
-                            last_x, last_y, r + 1, cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, y, duration, y + duration);
+                    if (out) out->emit(make_event(EVENT_MOVE, 0, 2, false, r, -1, -1, last_x, last_y,
+                            cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, y, duration));
                  }
                 y += duration;
+                ss_travel += duration;
             }
             duration = CONTROL_TIME;
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new StableTimeGraph((int) y, (int) y + duration, cc_containers[r]->_w));
                 ss_graph.back()->set_mode(2, counter);
-                printf("PICK %d (%lf + %lf -> %lf)\n", r + 1, y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_PICK, 0, 2, false, r, -1,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, y, duration));
             }
             y += duration;
             duration = ((cc_containers[r]->_w + 1) * TRAVEL_TIME);
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, cc_containers[r]->_w, -1));
                 ss_graph.back()->set_mode(2, counter);
-                printf("EXP MOVE %d (%d, %d, %d) TO SS (%lf + %lf -> %lf)\n",
-                        r + 1, cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_MOVE, 0, 2, true, r, -1,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, -1, -1, -1, y, duration));
                 mark[cc_containers[r]->_w][cc_containers[r]->_l] = true;
                 cc_containers[r]->_h = 0;
                 cc_containers[r]->_w = -1;
                 cc_containers[r]->_l = -1;
             }
             y += duration;
+            ss_travel += duration;
             duration = CONTROL_TIME;
-            if (edited) {
+            if (record) {
                 ss_graph.push_back(new StableTimeGraph((int) y, (int) y + duration, -1));
                 ss_graph.back()->set_mode(2, counter++);
-                printf("DROP %d (%lf + %lf -> %lf)\n", r + 1, y, duration, y + duration);
+                if (out) out->emit(make_event(EVENT_DROP, 0, 2, false, r, -1, -1, -1, -1, -1, -1, -1, y, duration));
             }
             y += duration;
             last_x = -1;
@@ -504,19 +859,221 @@ double All_Model::fx_function_solve(int x_size, char* x, bool edited) {
     }
     if (last_x != -1 || last_y != -1) {
         double duration = (last_x + 1) * TRAVEL_TIME;
-        if (edited) {
+        if (record) {
             ss_graph.push_back(new SlopeTimeGraph((int) y, (int) y + duration, last_x, -1));
             ss_graph.back()->set_mode(3, counter);
-            printf("TRAVEL BACK %d, %d (%lf + %lf -> %lf)\n", last_x, last_y, y, duration, y + duration);
+            if (out) out->emit(make_event(EVENT_MOVE, 0, 3, false, -1, -1, -1, last_x, last_y, -1, -1, -1, y, duration));
         }
         y += duration;
+        ss_travel += duration;
     }
+    if (out) out->flush();
+    if (prefix) describe_prefix(*prefix, false, res_ss_steps + total_ss_steps, start, y, -1);
     return y;
 }
 
+double All_Model::fx_function_solve_joint(int x_size, char* x, bool edited) {
+    //! SS part drives the shared timeline, LS part is scored against it
+    double ss_y = ss_solve(x, true, edited, std::numeric_limits<double>::infinity());
+    reanalyze();
+    double ls_y = fx_function_solve_2(x_size - ss_allocate_size, x + ss_allocate_size, edited);
+    return std::max(ss_y, ls_y);
+}
+
+double All_Model::fx_function_solve_joint_objectives(char* x, double* f) {
+    double ss_y = ss_solve(x, true, false, std::numeric_limits<double>::infinity());
+    reanalyze();
+    double ls_y = ls_solve(x + ss_allocate_size, false, std::numeric_limits<double>::infinity());
+    f[0] = std::max(ss_y, ls_y);
+    f[1] = ls_wait;
+    f[2] = ss_travel + ls_travel;
+    return f[0];
+}
+
+double All_Model::fx_function_solve_joint_bounded(char* x, double cutoff) {
+    //! The timeline must be recorded for the long-span part, but a stopped one is never used
+    double ss_y = ss_solve(x, true, false, cutoff);
+    if (ss_y >= cutoff) return ss_y;
+    reanalyze();
+    double ls_y = ls_solve(x + ss_allocate_size, false, cutoff);
+    return std::max(ss_y, ls_y);
+}
+
+double All_Model::fx_function_solve_2_relaxed(char* x) {
+    //! Against an empty timeline the short-span crane never makes the long-span one wait
+    std::vector<TimeGraph*> timeline;
+    timeline.swap(ss_graph);
+    double y = ls_solve(x, false, std::numeric_limits<double>::infinity());
+    timeline.swap(ss_graph);
+    return y;
+}
+
+double All_Model::fx_function_solve_joint_relaxed(char* x) {
+    double ss_y = ss_solve(x, true, false, std::numeric_limits<double>::infinity());
+    reanalyze();
+    double ls_y = fx_function_solve_2_relaxed(x + ss_allocate_size);
+    return std::max(ss_y, ls_y);
+}
+
+void All_Model::decode_ss_tasks(char* x, std::vector<CraneTask>& tasks) {
+    int start = 0;
+    int all = W*L;
+
+    mark.resize(W);
+    for (int i = 0; i < W; i++) {
+        mark[i].assign(L, false);
+    }
+
+    int res_ss_bit = decimal_2_binary_size(res_ss_steps);
+    int all_bit = decimal_2_binary_size(all);
+    int front_num = (int) pow(2, res_ss_bit);
+    int last_num = (int) pow(2, all_bit);
+    for (int i = 0; i < res_ss_steps; i++) {
+        int res_it = binary_2_decimal(res_ss_bit, x + start);
+        start += res_ss_bit;
+        int area_it = binary_2_decimal(all_bit, x + start);
+        start += all_bit;
+        int idx_r = adjust(res_it, front_num - 1, res_ss_pool.size() - 1);
+        int r = pop_res_ss_pool(idx_r);
+        int des = adjust(area_it, last_num - 1, area_pool.size() - 1);
+        int a = pop_area_pool(des);
+        dat* c = cc_containers[r];
+        tasks.push_back({0, r, a, c->_w, c->_l, areas[a]->_w, areas[a]->_l});
+        mark[c->_w][c->_l] = true;
+        mark[areas[a]->_w][areas[a]->_l] = true;
+        c->_h = areas[a]->_h;
+        c->_w = areas[a]->_w;
+        c->_l = areas[a]->_l;
+    }
+    int front_bit = decimal_2_binary_size(max_ss_steps);
+    int last_bit = decimal_2_binary_size(all);
+    front_num = (int) pow(2, front_bit);
+    last_num = (int) pow(2, last_bit);
+    for (int i = 0; i < total_ss_steps; i++) {
+        char opd = x[start++];
+        int it = binary_2_decimal(front_bit, x + start);
+        start += front_bit;
+        int area_it = binary_2_decimal(last_bit, x + start);
+        start += last_bit;
+        if ((opd == 0 && !imp_ss_pool.empty()) || exp_ss_pool.empty()) {
+            //! IMPORT
+            int idx_a = adjust(area_it, last_num - 1, area_pool.size() - 1);
+            int a = pop_area_pool(idx_a);
+            int idx_r = adjust(it, front_num - 1, imp_ss_pool.size() - 1);
+            int r = pop_pool(imp_ss_pool, idx_r);
+            tasks.push_back({1, r, a, -1, -1, areas[a]->_w, areas[a]->_l});
+            mark[areas[a]->_w][areas[a]->_l] = true;
+            dat* _a = new dat(areas[a]->_h, areas[a]->_w, areas[a]->_l);
+            cc_containers.insert(std::make_pair(++last_cc_container, _a));
+        } else {
+            //! EXPORT
+            int idx_r = adjust(it, front_num - 1, exp_ss_pool.size() - 1);
+            int r = pop_pool(exp_ss_pool, idx_r);
+            dat* c = cc_containers[r];
+            tasks.push_back({2, r, -1, c->_w, c->_l, -1, -1});
+            mark[c->_w][c->_l] = true;
+            c->_h = 0;
+            c->_w = -1;
+            c->_l = -1;
+        }
+    }
+}
+
+void All_Model::decode_ls_tasks(char* x, std::vector<CraneTask>& tasks) {
+    int start = 0;
+    int all = W*L;
+
+    int res_ls_bit = decimal_2_binary_size(res_ls_steps);
+    int all_bit = decimal_2_binary_size(all);
+    int front_num = (int) pow(2, res_ls_bit);
+    int last_num = (int) pow(2, all_bit);
+    for (int i = 0; i < res_ls_steps; i++) {
+        int res_it = binary_2_decimal(res_ls_bit, x + start);
+        start += res_ls_bit;
+        int area_it = binary_2_decimal(all_bit, x + start);
+        start += all_bit;
+        //! The short-span crane may already have moved or exported the reserved containers left
+        if (res_ls_pool.empty()) continue;
+        int idx_r = adjust(res_it, front_num - 1, res_ls_pool.size() - 1);
+        int r = pop_res_ls_pool(idx_r);
+        int des = adjust(area_it, last_num - 1, area_pool.size() - 1);
+        int a = pop_area_pool(des);
+        dat* c = cc_containers[r];
+        tasks.push_back({0, r, a, c->_w, c->_l, areas[a]->_w, areas[a]->_l});
+    }
+    int front_bit = decimal_2_binary_size(max_ls_steps);
+    int last_bit = decimal_2_binary_size(all);
+    front_num = (int) pow(2, front_bit);
+    last_num = (int) pow(2, last_bit);
+    for (int i = 0; i < total_ls_steps; i++) {
+        char opd = x[start++];
+        int it = binary_2_decimal(front_bit, x + start);
+        start += front_bit;
+        int area_it = binary_2_decimal(last_bit, x + start);
+        start += last_bit;
+        if ((opd == 0 && !imp_ls_pool.empty()) || exp_ls_pool.empty()) {
+            //! IMPORT
+            int idx_a = adjust(area_it, last_num - 1, area_pool.size() - 1);
+            int a = pop_area_pool(idx_a);
+            int idx_r = adjust(it, front_num - 1, imp_ls_pool.size() - 1);
+            int r = pop_pool(imp_ls_pool, idx_r);
+            tasks.push_back({1, r, a, -1, -1, areas[a]->_w, areas[a]->_l});
+        } else {
+            //! EXPORT
+            int idx_r = adjust(it, front_num - 1, exp_ls_pool.size() - 1);
+            int r = pop_pool(exp_ls_pool, idx_r);
+            dat* c = cc_containers[r];
+            tasks.push_back({2, r, -1, c->_w, c->_l, -1, -1});
+        }
+    }
+}
+
+double All_Model::fx_function_solve_rail(char* x, int cranes, RailSchedule* schedule) {
+    std::vector<CraneTask> ss_tasks, ls_tasks;
+    decode_ss_tasks(x, ss_tasks);
+    reanalyze();
+    decode_ls_tasks(x + ss_allocate_size, ls_tasks);
+
+    RailSchedule rail(cranes, W);
+    int k = rail.size();
+    std::vector<std::vector<CraneTask> > lists(k);
+    for (auto& t : ss_tasks) {
+        lists[(k > 2 && t.mode == 0) ? rail.zone(t.from_w) : 0].push_back(t);
+    }
+    for (auto& t : ls_tasks) {
+        lists[(k > 2 && t.mode == 0) ? rail.zone(t.from_w) : k - 1].push_back(t);
+    }
+    rail.run(lists);
+    if (schedule) {
+        *schedule = rail;
+    }
+    return rail.makespan();
+}
+
 double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
+    return ls_solve(x, edited, std::numeric_limits<double>::infinity());
+}
+
+double All_Model::fx_function_solve_2_bounded(char* x, double cutoff) {
+    return ls_solve(x, false, cutoff);
+}
+
+double All_Model::fx_function_solve_2_objectives(char* x, double* f) {
+    f[0] = ls_solve(x, false, std::numeric_limits<double>::infinity());
+    f[1] = ls_wait;
+    f[2] = ls_travel;
+    return f[0];
+}
+
+double All_Model::ls_solve(char* x, bool edited, double cutoff, int steps, MovePrefix* prefix) {
+    PSO_COUNT(COUNT_LS_SOLVE);
+    PSO_TIME(TIME_LS_SOLVE);
     int counter = 0;
     int time_counter = 0;
+    ls_travel = ls_wait = 0;
+
+    TextScheduleSink text(stdout);
+    ScheduleSink* out = edited ? (sink ? sink : &text) : NULL;
 
     double y = 0;
     int start = 0;
@@ -526,12 +1083,24 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
     int all_bit = decimal_2_binary_size(all);
     int front_num = (int) pow(2, res_ls_bit);
     int last_num = (int) pow(2, all_bit);
+    int total_ls_steps = imp_ls_steps + exp_ls_steps;
     for (int i = 0; i < res_ls_steps; i++) {
+        if (i == steps) {
+            describe_prefix(*prefix, true, i, start, y, time_counter);
+            return y;
+        }
+        double bound = y + remaining_bound(true, res_ls_steps - i, total_ls_steps);
+        if (bound >= cutoff) {
+            PSO_COUNT(COUNT_BOUND_ABORT);
+            return bound;
+        }
         std::vector<TimeGraph*> temp_graph;
         int res_it = binary_2_decimal(res_ls_bit, x + start);
         start += res_ls_bit;
         int area_it = binary_2_decimal(all_bit, x + start);
         start += all_bit;
+        //! The short-span crane may already have moved or exported the reserved containers left
+        if (res_ls_pool.empty()) continue;
         int idx_r = adjust(res_it, front_num - 1, res_ls_pool.size() - 1);
         int r = pop_res_ls_pool(idx_r);
         int des = adjust(area_it, last_num - 1, area_pool.size() - 1);
@@ -549,6 +1118,7 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
         double shift = 0, total_shift = 0, prev_total_shift = 0;
 
         do{
+            PSO_COUNT(COUNT_FIXED_POINT_ROUND);
             time_counter = prev_time_counter;
             prev_total_shift = total_shift;
             t_y = t_y_start + total_shift;
@@ -585,40 +1155,40 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
             t_y += shift;
             t_y += t_duration_4;
         }while(prev_total_shift != total_shift);
+        ls_wait += total_shift;
+        ls_travel += t_duration_0 + t_duration_2 + t_duration_4;
 
         if (edited) {
             if (total_shift > 0) {
-                printf("WAIT %lf (%f + %f -> %f)\n", total_shift, y, total_shift, y + total_shift);
+                out->emit(make_event(EVENT_WAIT, 1, 0, false, r, a, -1, W, -1, -1, W, -1, y, total_shift));
                 ls_graph.push_back(new StableTimeGraph((int) y, (int) y + total_shift, W));
                 ls_graph.back()->set_mode(0, counter, true);
             };
             y += total_shift;
-            printf("MOVE FROM LS TO %d, %d (%lf + %lf -> %lf)\n", _x, _y,
-                    y, t_duration_0, y + t_duration_0);
+            out->emit(make_event(EVENT_MOVE, 1, 0, false, r, a, -1, W, -1, cc_containers[r]->_h, _x, _y, y, t_duration_0));
             ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_0, W, _x));
             ls_graph.back()->set_mode(0, counter);
             y += t_duration_0;
-            printf("PICK %d (%lf + %lf -> %lf)\n", r + 1, y, t_duration_1, y + t_duration_1);
+            out->emit(make_event(EVENT_PICK, 1, 0, false, r, a, cc_containers[r]->_h, _x, _y,
+                    cc_containers[r]->_h, _x, _y, y, t_duration_1));
             ls_graph.push_back(new StableTimeGraph((int) y, (int) y + t_duration_1, _x));
             ls_graph.back()->set_mode(0, counter);
             y += t_duration_1;
-            printf("Move %d( %d, %d, %d ) to ( %d, %d, %d ) (%lf +%lf -> %f)\n", r + 1,
+            out->emit(make_event(EVENT_MOVE, 1, 0, true, r, a,
                     cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
-                    areas[a]->_h, areas[a]->_w, areas[a]->_l,
-                    y, t_duration_2, y + t_duration_2);
+                    areas[a]->_h, areas[a]->_w, areas[a]->_l, y, t_duration_2));
             if( t_duration_2 > 0){
                 ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_2, _x, areas[a]->_w));
                 ls_graph.back()->set_mode(0, counter);
                 y += t_duration_2;
             }
-            printf("DROP %d (%lf + %lf -> %lf)\n", r + 1,
-                    y, t_duration_3, y + t_duration_3);
+            out->emit(make_event(EVENT_DROP, 1, 0, false, r, a, areas[a]->_h, areas[a]->_w, areas[a]->_l,
+                    areas[a]->_h, areas[a]->_w, areas[a]->_l, y, t_duration_3));
             ls_graph.push_back(new StableTimeGraph((int) y, (int) y + t_duration_3, areas[a]->_w));
             ls_graph.back()->set_mode(0, counter);
             y += t_duration_3;
-            printf("Move ( %d, %d, %d ) to LS (%lf + %lf -> %lf)\n",
-                    areas[a]->_h, areas[a]->_w, areas[a]->_l,
-                    y, t_duration_4, y + t_duration_4);
+            out->emit(make_event(EVENT_MOVE, 1, 0, false, r, a, areas[a]->_h, areas[a]->_w, areas[a]->_l,
+                    -1, W, -1, y, t_duration_4));
             ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_4, areas[a]->_w, W));
             ls_graph.back()->set_mode(0, counter++);
             y += t_duration_4;
@@ -639,8 +1209,16 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
     int last_bit = decimal_2_binary_size(all);
     front_num = (int) pow(2, front_bit);
     last_num = (int) pow(2, last_bit);
-    int total_ls_steps = imp_ls_steps + exp_ls_steps;
     for (int i = 0; i < total_ls_steps; i++) {
+        if (res_ls_steps + i == steps) {
+            describe_prefix(*prefix, true, res_ls_steps + i, start, y, time_counter);
+            return y;
+        }
+        double bound = y + remaining_bound(true, 0, total_ls_steps - i);
+        if (bound >= cutoff) {
+            PSO_COUNT(COUNT_BOUND_ABORT);
+            return bound;
+        }
         int it, area_it;
         char opd = x[start++];
         it = binary_2_decimal(front_bit, x + start);
@@ -663,6 +1241,7 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
             double shift = 0, total_shift = 0, prev_total_shift = 0;
 
             do{
+                PSO_COUNT(COUNT_FIXED_POINT_ROUND);
                 time_counter = prev_time_counter;
                 prev_total_shift = total_shift;
                 t_y = t_y_start + total_shift;
@@ -691,33 +1270,32 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
                 t_y += shift;
                 t_y += t_duration_3;
             }while(prev_total_shift != total_shift);
+            ls_wait += total_shift;
+            ls_travel += t_duration_1 + t_duration_3;
 
             if (edited) {
                 if (total_shift > 0) {
-                    printf("WAIT %lf (%lf + %lf -> %lf)\n", total_shift, y, total_shift, y + total_shift);
+                    out->emit(make_event(EVENT_WAIT, 1, 1, false, r, a, -1, W, -1, -1, W, -1, y, total_shift));
                     ls_graph.push_back(new StableTimeGraph((int) y, (int) y + total_shift, W));
                     ls_graph.back()->set_mode(1, counter, true);
                 }
                 y += total_shift;
-                printf("PICK IMP-%d (%lf + %lf -> %lf)\n", r + 1,
-                        y, t_duration_0, y + t_duration_0);
+                out->emit(make_event(EVENT_PICK, 1, 1, false, r, a, -1, W, -1, -1, W, -1, y, t_duration_0));
                 ls_graph.push_back(new StableTimeGraph((int) y, (int) y + t_duration_0, W));
                 ls_graph.back()->set_mode(1, counter);
                 y += t_duration_0;
-                printf("IMP MOVE IMP-%d TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n",
-                        r + 1, a + 1, areas[a]->_h, areas[a]->_w, areas[a]->_l,
-                        y, t_duration_1, y + t_duration_1);
+                out->emit(make_event(EVENT_MOVE, 1, 1, true, r, a, -1, W, -1,
+                        areas[a]->_h, areas[a]->_w, areas[a]->_l, y, t_duration_1));
                 ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_1, W, areas[a]->_w));
                 ls_graph.back()->set_mode(1, counter);
                 y += t_duration_1;
-                printf("DROP IMP-%d (%lf + %lf -> %lf)\n", r + 1,
-                        y, t_duration_2, y + t_duration_2);
+                out->emit(make_event(EVENT_DROP, 1, 1, false, r, a, areas[a]->_h, areas[a]->_w, areas[a]->_l,
+                        areas[a]->_h, areas[a]->_w, areas[a]->_l, y, t_duration_2));
                 ls_graph.push_back(new StableTimeGraph((int) y, (int) y + t_duration_2, areas[a]->_w));
                 ls_graph.back()->set_mode(1, counter);
                 y += t_duration_2;
-                printf("Move ( %d, %d, %d ) to LS (%lf + %lf -> %lf)\n",
-                        areas[a]->_h, areas[a]->_w, areas[a]->_l,
-                        y, t_duration_3, y + t_duration_3);
+                out->emit(make_event(EVENT_MOVE, 1, 1, false, r, a, areas[a]->_h, areas[a]->_w, areas[a]->_l,
+                        -1, W, -1, y, t_duration_3));
                 ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_3, areas[a]->_w, W));
                 ls_graph.back()->set_mode(1, counter++);
                 y += t_duration_3;
@@ -742,6 +1320,7 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
             double shift = 0, total_shift = 0, prev_total_shift = 0;
 
             do{
+                PSO_COUNT(COUNT_FIXED_POINT_ROUND);
                 time_counter = prev_time_counter;
                 prev_total_shift = total_shift;
                 t_y = t_y_start + total_shift;
@@ -770,33 +1349,33 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
                 t_y += shift;
                 t_y += t_duration_3;
             }while(prev_total_shift != total_shift);
+            ls_wait += total_shift;
+            ls_travel += t_duration_0 + t_duration_2;
 
             if (edited) {
                 if (total_shift > 0) {
-                    printf("WAIT %lf (%lf + %lf -> %lf)\n", total_shift, y, total_shift, y + total_shift);
+                    out->emit(make_event(EVENT_WAIT, 1, 2, false, r, -1, -1, W, -1, -1, W, -1, y, total_shift));
                     ls_graph.push_back(new StableTimeGraph((int) y, (int) y + total_shift, W));
                     ls_graph.back()->set_mode(2, counter, true);
                 }
                 y += total_shift;
-                printf("EXP MOVE FROM LS TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n",
-                        r + 1, cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
-                        y, t_duration_0, y + t_duration_0);
+                out->emit(make_event(EVENT_MOVE, 1, 2, false, r, -1, -1, W, -1,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, y, t_duration_0));
                 ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_0, W, cc_containers[r]->_w));
                 ls_graph.back()->set_mode(2, counter);
                 y += t_duration_0;
-                printf("PICK %d (%lf + %lf -> %lf)\n", r + 1,
-                        y, t_duration_1, y + t_duration_1);
+                out->emit(make_event(EVENT_PICK, 1, 2, false, r, -1,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, y, t_duration_1));
                 ls_graph.push_back(new StableTimeGraph((int) y, (int) y + t_duration_1, cc_containers[r]->_w));
                 ls_graph.back()->set_mode(2, counter);
                 y += t_duration_1;
-                printf("EXP MOVE %d (%d, %d, %d) TO LS (%lf + %lf -> %lf)\n",
-                        r + 1, cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l,
-                        y, t_duration_2, y + t_duration_2);
+                out->emit(make_event(EVENT_MOVE, 1, 2, true, r, -1,
+                        cc_containers[r]->_h, cc_containers[r]->_w, cc_containers[r]->_l, -1, W, -1, y, t_duration_2));
                 ls_graph.push_back(new SlopeTimeGraph((int) y, (int) y + t_duration_2, cc_containers[r]->_w, W));
                 ls_graph.back()->set_mode(2, counter);
                 y += t_duration_2;
-                printf("DROP %d (%lf + %lf -> %lf)\n", r + 1,
-                        y, t_duration_3, y + t_duration_3);
+                out->emit(make_event(EVENT_DROP, 1, 2, false, r, -1, -1, W, -1, -1, W, -1, y, t_duration_3));
                 ls_graph.push_back(new StableTimeGraph((int) y, (int) y + t_duration_3, W));
                 ls_graph.back()->set_mode(2, counter++);
                 y += t_duration_3;
@@ -809,85 +1388,423 @@ double All_Model::fx_function_solve_2(int x_size, char* x, bool edited) {
             }
         }
     }
+    if (out) out->flush();
+    if (prefix) describe_prefix(*prefix, true, res_ls_steps + total_ls_steps, start, y, time_counter);
     return y;
 }
 
+//! Folds one value into a state hash
+static inline uint64_t hash_mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h * 0xff51afd7ed558ccdULL;
+}
+
+static uint64_t hash_sorted(uint64_t h, std::vector<int> v) {
+    std::sort(v.begin(), v.end());
+    h = hash_mix(h, v.size());
+    for (int it : v) h = hash_mix(h, it);
+    return h;
+}
+
+void All_Model::describe_prefix(MovePrefix& p, bool ls, int step, int start, double y, int pos) {
+    int res_steps = ls ? res_ls_steps : res_ss_steps;
+    int total = res_steps + (ls ? total_ls_steps : total_ss_steps);
+    p.ls = ls;
+    p.step = step;
+    p.start = start;
+    p.done = step >= total;
+    p.reserved = step < res_steps;
+    p.res = p.reserved ? (ls ? res_ls_pool.size() : res_ss_pool.size()) : 0;
+    p.imp = ls ? imp_ls_pool.size() : imp_ss_pool.size();
+    p.exp = ls ? exp_ls_pool.size() : exp_ss_pool.size();
+    p.areas = area_pool.size();
+    p.time = y;
+    p.floor = 0;
+    //! Reserved moves may be left over when a pool ran dry, so only the moves still to come count
+    int res_left = std::max(0, res_steps - step);
+    int io_left = std::min(total - step, total - res_steps);
+    p.bound = y + remaining_bound(ls, res_left, std::max(0, io_left));
+
+    uint64_t h = hash_mix(ls, step);
+    h = hash_mix(h, pos);
+    if (p.reserved) h = hash_sorted(h, ls ? res_ls_pool : res_ss_pool);
+    h = hash_mix(h, p.imp);
+    h = hash_sorted(h, ls ? exp_ls_pool : exp_ss_pool);
+    std::vector<int> slots;
+    for (int a : area_pool) slots.push_back(areas[a]->_h * W + areas[a]->_w);
+    p.state = hash_sorted(h, slots);
+}
+
+void All_Model::fx_function_solve_prefix(char* x, bool joint, int steps, MovePrefix& p) {
+    double inf = std::numeric_limits<double>::infinity();
+    int ss_steps = get_ss_steps();
+    if (!joint || steps < ss_steps) {
+        ss_solve(x, false, false, inf, steps, &p);
+        //! The long-span crane has all its moves ahead of it, whatever the short-span schedule
+        if (joint) {
+            p.done = false;
+            p.bound = std::max(p.bound, remaining_bound(true, res_ls_steps, total_ls_steps));
+        }
+        return;
+    }
+    double ss_y = ss_solve(x, true, false, inf);
+    reanalyze();
+    ls_solve(x + ss_allocate_size, false, inf, steps - ss_steps, &p);
+    p.start += ss_allocate_size;
+    p.floor = ss_y;
+    p.bound = std::max(p.bound, ss_y);
+}
+
+uint64_t All_Model::decoded_key(char* x, bool ss, bool ls) {
+    std::vector<CraneTask> tasks;
+    if (ss) decode_ss_tasks(x, tasks);
+    if (ss && ls) reanalyze();
+    if (ls) decode_ls_tasks(ss ? x + ss_allocate_size : x, tasks);
+    uint64_t h = hash_mix(ss, ls);
+    for (const CraneTask& t : tasks) {
+        //! Which import is taken changes no time, and the slot is known by its position
+        h = hash_mix(h, t.mode);
+        h = hash_mix(h, t.mode == 1 ? -1 : t.container);
+        h = hash_mix(h, t.from_w * L + t.from_l);
+        h = hash_mix(h, t.to_w * L + t.to_l);
+    }
+    return h;
+}
+
+uint64_t All_Model::phase_key(char* x, bool ls) const {
+    //! The pools are walked on copies; a slot is kept as its stack and height, so a filled
+    //! one moves up without a new area, and an import pool only needs its size
+    std::vector<std::pair<int, int> > slots;
+    for (int a : area_pool) {
+        const dat* d = areas.at(a);
+        slots.push_back(std::make_pair(d->_w * L + d->_l, d->_h));
+    }
+    std::vector<int> res(ls ? res_ls_pool : res_ss_pool), exp(ls ? exp_ls_pool : exp_ss_pool);
+    const std::set<int>& reserved = ls ? res_ls : res_ss;
+    int imp = (ls ? imp_ls_pool : imp_ss_pool).size();
+    int all_bit = decimal_2_binary_size(W * L);
+    int res_bit = decimal_2_binary_size(ls ? res_ls_steps : res_ss_steps);
+    int front_bit = decimal_2_binary_size(ls ? max_ls_steps : max_ss_steps);
+    int steps = ls ? total_ls_steps : total_ss_steps;
+    //! A short-span export may be a reserved container moved before, as `decode_ss_tasks()`
+    //! records; the long-span decoder keeps the old stack
+    std::map<int, int> moved;
+    uint64_t h = hash_mix(!ls, ls);
+    int start = 0;
+    auto take_slot = [&](int bits) {
+        int idx = adjust(binary_2_decimal(all_bit, x + bits), (1 << all_bit) - 1, slots.size() - 1);
+        int to = slots[idx].first;
+        if (slots[idx].second + 1 < H) {
+            slots[idx].second++;
+        } else {
+            slots[idx] = slots.back();
+            slots.pop_back();
+        }
+        return to;
+    };
+    for (int i = 0; i < (ls ? res_ls_steps : res_ss_steps); i++, start += res_bit + all_bit) {
+        if (ls && res.empty()) continue;
+        int idx = adjust(binary_2_decimal(res_bit, x + start), (1 << res_bit) - 1, res.size() - 1);
+        int r = res[idx];
+        const dat* c = cc_containers.at(r);
+        int below = c->_h > 0 ? table[c->_w][c->_l][c->_h - 1] : -1;
+        if (below >= 0 && reserved.count(below)) {
+            res[idx] = below;
+        } else {
+            res[idx] = res.back();
+            res.pop_back();
+        }
+        int to = take_slot(start + res_bit);
+        if (!ls) moved[r] = to;
+        h = hash_mix(h, 0);
+        h = hash_mix(h, r);
+        h = hash_mix(h, c->_w * L + c->_l);
+        h = hash_mix(h, to);
+    }
+    for (int i = 0; i < steps; i++, start += 1 + front_bit + all_bit) {
+        if ((x[start] == 0 && imp > 0) || exp.empty()) {
+            int to = take_slot(start + 1 + front_bit);
+            imp--;
+            h = hash_mix(h, 1);
+            h = hash_mix(h, -1);
+            h = hash_mix(h, -L - 1);
+            h = hash_mix(h, to);
+        } else {
+            int idx = adjust(binary_2_decimal(front_bit, x + start + 1), (1 << front_bit) - 1, exp.size() - 1);
+            int r = exp[idx];
+            exp[idx] = exp.back();
+            exp.pop_back();
+            const dat* c = cc_containers.at(r);
+            std::map<int, int>::const_iterator m = moved.find(r);
+            h = hash_mix(h, 2);
+            h = hash_mix(h, r);
+            h = hash_mix(h, m != moved.end() ? m->second : c->_w * L + c->_l);
+            h = hash_mix(h, -L - 1);
+        }
+    }
+    return h;
+}
+
+//! The smallest value that `adjust()` maps to `index`
+static int unadjust(int index, int max_curr, int max_n) {
+    if (max_n <= 0) return 0;
+    return (int) (((long long) index * max_curr + max_n - 1) / max_n);
+}
+
+//! Writes a value as `bsize` bits, lowest first, as `binary_2_decimal()` reads them
+static void decimal_2_binary(int value, int bsize, char* bits) {
+    for (int i = 0; i < bsize; i++) {
+        bits[i] = (value >> i) & 1;
+    }
+}
+
+void All_Model::encode_move(const MovePrefix& p, bool import, int pick, int area, char* x) const {
+    int all_bit = decimal_2_binary_size(W * L);
+    char* field = x + p.start;
+    if (p.reserved) {
+        int res_bit = decimal_2_binary_size(p.ls ? res_ls_steps : res_ss_steps);
+        decimal_2_binary(unadjust(pick, (1 << res_bit) - 1, p.res - 1), res_bit, field);
+        decimal_2_binary(unadjust(area, (1 << all_bit) - 1, p.areas - 1), all_bit, field + res_bit);
+        return;
+    }
+    int front_bit = decimal_2_binary_size(p.ls ? max_ls_steps : max_ss_steps);
+    field[0] = import ? 0 : 1;
+    decimal_2_binary(unadjust(pick, (1 << front_bit) - 1, (import ? p.imp : p.exp) - 1), front_bit, field + 1);
+    decimal_2_binary(import ? unadjust(area, (1 << all_bit) - 1, p.areas - 1) : 0, all_bit, field + 1 + front_bit);
+}
+
+void All_Model::list_moves(const MovePrefix& p, std::vector<MoveChoice>& moves) {
+    moves.clear();
+    if (p.reserved) {
+        for (int r = 0; r < p.res; r++) {
+            for (int a = 0; a < p.areas; a++) {
+                moves.push_back({false, r, a});
+            }
+        }
+        return;
+    }
+    //! Which import is taken does not change any time, so only the first one is listed
+    for (int a = 0; p.imp > 0 && a < p.areas; a++) {
+        moves.push_back({true, 0, a});
+    }
+    for (int r = 0; r < p.exp; r++) {
+        moves.push_back({false, r, 0});
+    }
+}
+
+int All_Model::nearest_area(int w, int l) const {
+    int best = 0, dist = INT_MAX;
+    for (size_t k = 0; w >= 0 && k < area_pool.size(); k++) {
+        const dat* a = areas.at(area_pool[k]);
+        int d = abs(a->_w - w) + abs(a->_l - l);
+        if (d < dist) {
+            dist = d;
+            best = k;
+        }
+    }
+    return best;
+}
+
+void All_Model::remap_tasks(bool ls, const std::vector<CraneTask>& old, char* x) {
+    int start = 0;
+    int all = W*L;
+    int all_bit = decimal_2_binary_size(all);
+    int all_max = (int) pow(2, all_bit) - 1;
+    std::vector<int>& res_pool = ls ? res_ls_pool : res_ss_pool;
+    std::vector<int>& imp_pool = ls ? imp_ls_pool : imp_ss_pool;
+    std::vector<int>& exp_pool = ls ? exp_ls_pool : exp_ss_pool;
+    if (!ls) {
+        mark.resize(W);
+        for (int i = 0; i < W; i++) {
+            mark[i].assign(L, false);
+        }
+    }
+
+    int res_steps = ls ? res_ls_steps : res_ss_steps;
+    int res_bit = decimal_2_binary_size(res_steps);
+    int res_max = (int) pow(2, res_bit) - 1;
+    size_t next = 0;
+    for (int i = 0; i < res_steps; i++) {
+        int pick = 0, area = 0;
+        while (next < old.size() && old[next].mode == 0) {
+            const CraneTask& t = old[next++];
+            std::vector<int>::iterator it = std::find(res_pool.begin(), res_pool.end(), t.container);
+            if (it != res_pool.end()) {
+                pick = it - res_pool.begin();
+                area = nearest_area(t.to_w, t.to_l);
+                break;
+            }
+        }
+        if (res_pool.empty()) {
+            start += res_bit + all_bit;
+            continue;
+        }
+        decimal_2_binary(unadjust(pick, res_max, (int) res_pool.size() - 1), res_bit, x + start);
+        start += res_bit;
+        decimal_2_binary(unadjust(area, all_max, (int) area_pool.size() - 1), all_bit, x + start);
+        start += all_bit;
+        int r = ls ? pop_res_ls_pool(pick) : pop_res_ss_pool(pick);
+        int a = pop_area_pool(area);
+        if (!ls) {
+            dat* c = cc_containers[r];
+            mark[c->_w][c->_l] = true;
+            mark[areas[a]->_w][areas[a]->_l] = true;
+            c->_h = areas[a]->_h;
+            c->_w = areas[a]->_w;
+            c->_l = areas[a]->_l;
+        }
+    }
+    while (next < old.size() && old[next].mode == 0) next++;
+
+    int total_steps = ls ? total_ls_steps : total_ss_steps;
+    int front_bit = decimal_2_binary_size(ls ? max_ls_steps : max_ss_steps);
+    int front_max = (int) pow(2, front_bit) - 1;
+    for (int i = 0; i < total_steps; i++) {
+        bool import = !imp_pool.empty();
+        int pick = 0, area = 0;
+        while (next < old.size()) {
+            const CraneTask& t = old[next++];
+            if (t.mode == 1 && !imp_pool.empty()) {
+                import = true;
+                area = nearest_area(t.to_w, t.to_l);
+                break;
+            }
+            std::vector<int>::iterator it = std::find(exp_pool.begin(), exp_pool.end(), t.container);
+            if (t.mode == 2 && it != exp_pool.end()) {
+                import = false;
+                pick = it - exp_pool.begin();
+                break;
+            }
+        }
+        x[start++] = import ? 0 : 1;
+        decimal_2_binary(unadjust(pick, front_max, (int) (import ? imp_pool : exp_pool).size() - 1), front_bit, x + start);
+        start += front_bit;
+        decimal_2_binary(import ? unadjust(area, all_max, (int) area_pool.size() - 1) : 0, all_bit, x + start);
+        start += all_bit;
+        if (import) {
+            int a = pop_area_pool(area);
+            pop_pool(imp_pool, pick);
+            if (!ls) {
+                mark[areas[a]->_w][areas[a]->_l] = true;
+                dat* _a = new dat(areas[a]->_h, areas[a]->_w, areas[a]->_l);
+                cc_containers.insert(std::make_pair(++last_cc_container, _a));
+            }
+        } else {
+            int r = pop_pool(exp_pool, pick);
+            if (!ls) {
+                dat* c = cc_containers[r];
+                mark[c->_w][c->_l] = true;
+                c->_h = 0;
+                c->_w = -1;
+                c->_l = -1;
+            }
+        }
+    }
+}
+
+void All_Model::remap_genome(All_Model& from, char* from_x, bool joint, char* x) {
+    std::vector<CraneTask> ss_tasks, ls_tasks;
+    from.decode_ss_tasks(from_x, ss_tasks);
+    if (joint) {
+        from.reanalyze();
+        from.decode_ls_tasks(from_x + from.ss_allocate_size, ls_tasks);
+    }
+    remap_tasks(false, ss_tasks, x);
+    if (joint) {
+        reanalyze();
+        remap_tasks(true, ls_tasks, x + ss_allocate_size);
+    }
+}
+
+void All_Model::decode_tasks(char* x, std::vector<CraneTask>& ss, std::vector<CraneTask>& ls) {
+    decode_ss_tasks(x, ss);
+    reanalyze();
+    decode_ls_tasks(x + ss_allocate_size, ls);
+}
+
+std::vector<ScheduleViolation> All_Model::validate() {
+    std::vector<ScheduleEvent> events;
+    for (int crane = 0; crane < 2; crane++) {
+        for (TimeGraph* g : crane ? ls_graph : ss_graph) {
+            int type = g->get_type() == 1 ? EVENT_MOVE : g->get_wait() ? EVENT_WAIT : EVENT_PICK;
+            events.push_back(make_event(type, crane, 0, false, -1, -1, -1, g->get_from(), -1, -1, g->get_to(), -1,
+                    g->get_start(), g->get_end() - g->get_start()));
+        }
+    }
+    return validate_schedule(events);
+}
+
 void All_Model::display() {
-    printf("===============================================\n");
-    printf("----- Containers -----\n");
+    //! The timeline has one line per time unit, so it is built in memory and written once
+    std::string buf;
+    appendf(buf, "===============================================\n");
+    appendf(buf, "----- Containers -----\n");
     for (auto& it : cc_containers) {
-        printf("%d: %d %d %d\n", it.first, it.second->_h, it.second->_w, it.second->_l);
+        appendf(buf, "%d: %d %d %d\n", it.first, it.second->_h, it.second->_w, it.second->_l);
     }
     if (mark.size() > 0) {
-        printf("----- MARK -----\n");
+        appendf(buf, "----- MARK -----\n");
         for (int i = 0; i < W; i++) {
             for (int j = 0; j < L; j++) {
                 if (mark[i][j]) {
-                    printf("%d, %d\n", i, j);
+                    appendf(buf, "%d, %d\n", i, j);
                 }
             }
         }
     }
-    printf("----- AREA POOL -----\n");
+    appendf(buf, "----- AREA POOL -----\n");
     for (auto& it : area_pool) {
-        printf("%d, %d, %d\n", areas[it]->_h, areas[it]->_w, areas[it]->_l);
-    }
-    printf("----- GRAPH -----\n");
-    // for(int i=0; i<ss_graph.size(); i++){
-    //     if(ss_graph[i]->get_type() == 1){
-    //         static_cast<SlopeTimeGraph*>(ss_graph[i])->display();
-    //     }else{
-    //         static_cast<StableTimeGraph*>(ss_graph[i])->display();
-    //     }
-    // }
-    // for(int i=0; i<ls_graph.size(); i++){
-    //     if(ls_graph[i]->get_type() == 1){
-    //         static_cast<SlopeTimeGraph*>(ls_graph[i])->display();
-    //     }else{
-    //         static_cast<StableTimeGraph*>(ls_graph[i])->display();
-    //     }
-    // }
-    int x = 0, i = 0, j = 0, d = 0, e = 0;
-    while( i<ss_graph.size() || j<ls_graph.size() ){
-      printf("%d", x);
-      if(i<ss_graph.size()){
-        if(ss_graph[i]->get_type() == 1){
-            d = static_cast<SlopeTimeGraph*>(ss_graph[i])->get_value(x);
-        }else{
-            d = static_cast<StableTimeGraph*>(ss_graph[i])->get_value(x);
-        }
-        printf("\t%d",d);
-        ss_graph[i]->get_mode();
-        if(ss_graph[i]->outer(x)){
-          i++;
-        }
-      }else{
-          printf("\t");
-      }
-      if(j<ls_graph.size()){
-        if(ls_graph[j]->get_type() == 1){
-            e = static_cast<SlopeTimeGraph*>(ls_graph[j])->get_value(x);
-        }else{
-            e = static_cast<StableTimeGraph*>(ls_graph[j])->get_value(x);
-        }
-        printf("\t%d",e);
-        ls_graph[j]->get_mode();
-        if(ls_graph[j]->outer(x)){
-          j++;
-        }
-      }else{
-        printf("\t");
-      }
-      if(d >= e){
-        printf("\tERROR");
-      }
-      printf("\n");
-      x++;
-    }
-    printf("===============================================\n");
+        appendf(buf, "%d, %d, %d\n", areas[it]->_h, areas[it]->_w, areas[it]->_l);
+    }
+    appendf(buf, "----- GRAPH -----\n");
+    size_t i = 0, j = 0;
+    int x = 0, d = 0, e = 0;
+    while (i < ss_graph.size() || j < ls_graph.size()) {
+        appendf(buf, "%d", x);
+        if (i < ss_graph.size()) {
+            if (ss_graph[i]->get_type() == 1) {
+                d = static_cast<SlopeTimeGraph*>(ss_graph[i])->get_value(x);
+            } else {
+                d = static_cast<StableTimeGraph*>(ss_graph[i])->get_value(x);
+            }
+            appendf(buf, "\t%d", d);
+            ss_graph[i]->get_mode(buf);
+            if (ss_graph[i]->outer(x)) {
+                i++;
+            }
+        } else {
+            buf += '\t';
+        }
+        if (j < ls_graph.size()) {
+            if (ls_graph[j]->get_type() == 1) {
+                e = static_cast<SlopeTimeGraph*>(ls_graph[j])->get_value(x);
+            } else {
+                e = static_cast<StableTimeGraph*>(ls_graph[j])->get_value(x);
+            }
+            appendf(buf, "\t%d", e);
+            ls_graph[j]->get_mode(buf);
+            if (ls_graph[j]->outer(x)) {
+                j++;
+            }
+        } else {
+            buf += '\t';
+        }
+        buf += '\n';
+        x++;
+    }
+    std::vector<ScheduleViolation> violations = validate();
+    if (!violations.empty()) {
+        appendf(buf, "----- VIOLATIONS -----\n");
+        for (const ScheduleViolation& v : violations) {
+            appendf(buf, "%s\n", describe_violation(v).c_str());
+        }
+    }
+    appendf(buf, "===============================================\n");
+    fwrite(buf.data(), 1, buf.size(), stdout);
 }
 
 int All_Model::check_ss_slope(int& tc, int tt, int d, int a, int b) {
+    if (ss_graph.empty()) return 0;
     TimeGraph* tg = new SlopeTimeGraph(tt, tt + d, a, b);
     int shift = check_ss(tg, tc, tt);
     delete tg;
@@ -895,6 +1812,7 @@ int All_Model::check_ss_slope(int& tc, int tt, int d, int a, int b) {
 }
 
 int All_Model::check_ss_stable(int& tc, int tt, int d, int a) {
+    if (ss_graph.empty()) return 0;
     TimeGraph* tg = new StableTimeGraph(tt, tt + d, a);
     int shift = check_ss(tg, tc, tt);
     delete tg;
@@ -902,15 +1820,18 @@ int All_Model::check_ss_stable(int& tc, int tt, int d, int a) {
 }
 
 int All_Model::check_ss(TimeGraph* src, int& time_counter, int start_time) {
+    PSO_COUNT(COUNT_CHECK_SS);
+    PSO_TIME(TIME_CHECK_SS);
     int shifter = 0;
     int i = start_time;
     int j = start_time;
     if( time_counter < ss_graph.size() ){
-        while( !ss_graph[time_counter]->inner(i) && time_counter < ss_graph.size() ){
+        while( time_counter < ss_graph.size() && !ss_graph[time_counter]->inner(i) ){
             time_counter++;
         }
     }
     while (time_counter < ss_graph.size()) {
+        PSO_COUNT(COUNT_CHECK_SS_STEP);
         bool ret = TimeGraph::compare(ss_graph[time_counter], src, i + shifter, j);
         if (ret) {
             shifter += 1;
@@ -0,0 +1,90 @@
+#include "beam_search.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "thread_pool.h"
+
+BeamSearch::BeamSearch(All_Model* m, int w, bool j, int t) : model(m), width(w), joint(j), threads(t) {
+    size = joint ? model->get_joint_bit_size() : model->get_bit_size();
+}
+
+void BeamSearch::Simulate(int depth, Node& n) {
+    All_Model* m = model->clone();
+    m->fx_function_solve_prefix(n.x.data(), joint, depth, n.p);
+    delete m;
+}
+
+BeamSearchResult BeamSearch::Run() {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    BeamSearchResult res;
+    res.nodes = 1;
+    res.merged = 0;
+    std::vector<Node> beam(1);
+    beam[0].x.assign(size, 0);
+    Simulate(0, beam[0]);
+
+    ThreadPool* pool = threads > 1 ? new ThreadPool(threads) : NULL;
+    std::vector<MoveChoice> moves;
+    for (int depth = 1; !beam[0].p.done; depth++) {
+        std::vector<Node> children;
+        for (const Node& n : beam) {
+            All_Model::list_moves(n.p, moves);
+            for (const MoveChoice& c : moves) {
+                children.push_back(Node());
+                Node& child = children.back();
+                child.x = n.x;
+                model->encode_move(n.p, c.import, c.pick, c.area, child.x.data());
+            }
+        }
+        //! Each thread simulates its own slice, so the children come out in the same order
+        int slices = pool ? std::min((int) children.size(), threads * 4) : 1;
+        for (int s = 0; s < slices; s++) {
+            size_t from = children.size() * s / slices, to = children.size() * (s + 1) / slices;
+            std::vector<Node>* list = &children;
+            std::function<void()> job = [this, list, from, to, depth] {
+                for (size_t i = from; i < to; i++) Simulate(depth, (*list)[i]);
+            };
+            if (pool) pool->submit(job);
+            else job();
+        }
+        if (pool) pool->wait();
+        if (children.empty()) {
+            delete pool;
+            throw std::runtime_error("beam search: a prefix has no moves left");
+        }
+        res.nodes += children.size();
+
+        std::stable_sort(children.begin(), children.end(), [](const Node& a, const Node& b) {
+            return a.p.bound < b.p.bound || (a.p.bound == b.p.bound && a.p.time < b.p.time);
+        });
+        //! Without the long-span crane the moves left only depend on the state and the time
+        beam.clear();
+        std::unordered_set<uint64_t> seen;
+        for (Node& c : children) {
+            if ((int) beam.size() >= width) break;
+            if (!joint) {
+                uint64_t t;
+                memcpy(&t, &c.p.time, sizeof t);
+                if (!seen.insert(c.p.state ^ (t * 0x9e3779b97f4a7c15ULL)).second) {
+                    res.merged++;
+                    continue;
+                }
+            }
+            beam.push_back(Node());
+            beam.back().x.swap(c.x);
+            beam.back().p = c.p;
+        }
+    }
+    delete pool;
+
+    res.best = beam[0].p.bound;
+    res.xbest = beam[0].x;
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return res;
+}
@@ -0,0 +1,127 @@
+#include "binary_instance.h"
+
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <stdexcept>
+
+uint64_t fnv1a_64(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool is_binary_instance(const char* file) {
+    char magic[4];
+    FILE* ptr = fopen(file, "rb");
+    if (!ptr) return false;
+    bool ret = fread(magic, 1, 4, ptr) == 4 && memcmp(magic, BINARY_INSTANCE_MAGIC, 4) == 0;
+    fclose(ptr);
+    return ret;
+}
+
+void BinaryInstanceWriter::put(const std::vector<int>& v) {
+    words.push_back(v.size());
+    words.insert(words.end(), v.begin(), v.end());
+}
+
+void BinaryInstanceWriter::save(const char* file) const {
+    BinaryInstanceHeader h;
+    memcpy(h.magic, BINARY_INSTANCE_MAGIC, 4);
+    h.version = BINARY_INSTANCE_VERSION;
+    h.words = words.size();
+    h.reserved = 0;
+    h.checksum = fnv1a_64(words.data(), words.size() * sizeof(int32_t));
+
+    FILE* ptr = fopen(file, "wb");
+    if (!ptr) {
+        throw std::runtime_error(std::string(file) + ": cannot create: " + strerror(errno));
+    }
+    bool ok = fwrite(&h, sizeof(h), 1, ptr) == 1;
+    ok = ok && fwrite(words.data(), sizeof(int32_t), words.size(), ptr) == words.size();
+    ok = (fclose(ptr) == 0) && ok;
+    if (!ok) {
+        throw std::runtime_error(std::string(file) + ": write failed");
+    }
+}
+
+BinaryInstanceReader::BinaryInstanceReader(const char* path) : file(path), map(NULL), length(0), ptr(NULL), end(NULL) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(file + ": cannot open: " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(BinaryInstanceHeader)) {
+        close(fd);
+        throw std::runtime_error(file + ": truncated binary instance");
+    }
+    length = st.st_size;
+    map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        map = NULL;
+        throw std::runtime_error(file + ": cannot map: " + strerror(err));
+    }
+    const BinaryInstanceHeader* h = static_cast<const BinaryInstanceHeader*>(map);
+    std::string error;
+    if (memcmp(h->magic, BINARY_INSTANCE_MAGIC, 4) != 0) {
+        error = "not a binary instance";
+    } else if (h->version != BINARY_INSTANCE_VERSION) {
+        error = "unsupported binary instance version " + std::to_string(h->version);
+    } else if (sizeof(*h) + (size_t) h->words * sizeof(int32_t) != length) {
+        error = "binary instance size does not match its header";
+    } else if (fnv1a_64(h + 1, (size_t) h->words * sizeof(int32_t)) != h->checksum) {
+        error = "binary instance checksum mismatch";
+    }
+    if (!error.empty()) {
+        munmap(map, length);
+        map = NULL;
+        throw std::runtime_error(file + ": " + error);
+    }
+    ptr = reinterpret_cast<const int32_t*>(h + 1);
+    end = ptr + h->words;
+}
+
+BinaryInstanceReader::~BinaryInstanceReader() {
+    if (map) {
+        munmap(map, length);
+    }
+}
+
+void BinaryInstanceReader::fail(const std::string& message, size_t at) const {
+    throw std::runtime_error(file + ": byte " + std::to_string(at) + ": " + message);
+}
+
+int BinaryInstanceReader::next() {
+    if (ptr >= end) {
+        fail("binary instance payload is too short", offset());
+    }
+    return *ptr++;
+}
+
+const int32_t* BinaryInstanceReader::next_array(int& size) {
+    size_t at = offset();
+    size = next();
+    if (size < 0 || size > end - ptr) {
+        fail("binary instance array is out of bounds", at);
+    }
+    const int32_t* v = ptr;
+    ptr += size;
+    return v;
+}
+
+void BinaryInstanceReader::next_array(std::vector<int>& v) {
+    int size;
+    const int32_t* p = next_array(size);
+    v.assign(p, p + size);
+}
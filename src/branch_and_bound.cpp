@@ -0,0 +1,161 @@
+#include "branch_and_bound.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+#include "thread_pool.h"
+
+BranchAndBound::BranchAndBound(All_Model* m, bool j, int t)
+    : model(m), joint(j), threads(t), upper(std::numeric_limits<double>::infinity()), node_limit(0),
+      time_limit(0), table_size(1 << 22), best(0), nodes(0), pruned(0), merged(0), stopped(false),
+      table(SHARDS) {
+    size = joint ? model->get_joint_bit_size() : model->get_bit_size();
+}
+
+void BranchAndBound::Simulate(char* x, int depth, MovePrefix& p) {
+    nodes++;
+    All_Model* m = model->clone();
+    m->fx_function_solve_prefix(x, joint, depth, p);
+    delete m;
+}
+
+void BranchAndBound::Expand(Node& n, std::vector<Node>& children) {
+    std::vector<MoveChoice> moves;
+    All_Model::list_moves(n.p, moves);
+    children.resize(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        Node& c = children[i];
+        c.x = n.x;
+        c.depth = n.depth + 1;
+        model->encode_move(n.p, moves[i].import, moves[i].pick, moves[i].area, c.x.data());
+        Simulate(c.x.data(), c.depth, c.p);
+    }
+    std::sort(children.begin(), children.end(), [](const Node& a, const Node& b) {
+        return a.p.bound < b.p.bound || (a.p.bound == b.p.bound && a.p.time < b.p.time);
+    });
+}
+
+bool BranchAndBound::Cut(const MovePrefix& p, std::unordered_set<uint64_t>* seen) {
+    if (p.bound >= best.load()) {
+        pruned++;
+        return true;
+    }
+    if (p.ls) {
+        if (!seen) return false;
+        uint64_t t;
+        memcpy(&t, &p.time, sizeof t);
+        if (!seen->insert(p.state ^ (t * 0x9e3779b97f4a7c15ULL)).second) {
+            merged++;
+            return true;
+        }
+        return false;
+    }
+    //! In a joint search the long-span crane depends on how the short-span state was reached
+    if (joint) return false;
+    Shard& s = table[p.state % SHARDS];
+    std::lock_guard<std::mutex> guard(s.lock);
+    std::unordered_map<uint64_t, double>::iterator it = s.min.find(p.state);
+    if (it != s.min.end()) {
+        if (it->second <= p.time) {
+            merged++;
+            return true;
+        }
+        it->second = p.time;
+        return false;
+    }
+    if (s.min.size() >= table_size / SHARDS) s.min.clear();
+    s.min[p.state] = p.time;
+    return false;
+}
+
+void BranchAndBound::Improve(double value, const std::vector<char>& x) {
+    std::lock_guard<std::mutex> guard(best_lock);
+    if (value < best.load()) {
+        best.store(value);
+        xbest = x;
+    }
+}
+
+bool BranchAndBound::Limited() {
+    if (stopped.load()) return true;
+    if ((node_limit > 0 && nodes.load() >= node_limit) || (time_limit > 0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() >= time_limit)) {
+        stopped.store(true);
+    }
+    return stopped.load();
+}
+
+void BranchAndBound::Search(Node& n, std::unordered_set<uint64_t>* seen) {
+    if (Limited()) return;
+    //! The long-span states are only comparable below one short-span schedule
+    std::unordered_set<uint64_t> local;
+    if (n.p.ls && !seen) seen = &local;
+    if (Cut(n.p, seen)) return;
+    if (n.p.done) {
+        Improve(n.p.bound, n.x);
+        return;
+    }
+    std::vector<Node> children;
+    Expand(n, children);
+    for (Node& c : children) {
+        Search(c, seen);
+    }
+}
+
+BranchAndBoundResult BranchAndBound::Run() {
+    t0 = std::chrono::steady_clock::now();
+    best.store(upper);
+    nodes.store(0);
+    pruned.store(0);
+    merged.store(0);
+    stopped.store(false);
+    xbest.clear();
+    for (Shard& s : table) s.min.clear();
+
+    Node root;
+    root.x.assign(size, 0);
+    root.depth = 0;
+    Simulate(root.x.data(), 0, root.p);
+    if (threads <= 1) {
+        Search(root, NULL);
+    } else {
+        //! Split breadth first until there are enough subtrees to keep every thread busy
+        std::deque<Node> frontier;
+        frontier.push_back(root);
+        while (!frontier.empty() && frontier.size() < (size_t) threads * 8 && !Limited()) {
+            Node n = frontier.front();
+            frontier.pop_front();
+            if (n.p.bound >= best.load()) {
+                pruned++;
+                continue;
+            }
+            if (n.p.done) {
+                Improve(n.p.bound, n.x);
+                continue;
+            }
+            std::vector<Node> children;
+            Expand(n, children);
+            for (Node& c : children) frontier.push_back(c);
+        }
+        std::vector<Node> work(frontier.begin(), frontier.end());
+        std::sort(work.begin(), work.end(), [](const Node& a, const Node& b) { return a.p.bound < b.p.bound; });
+        ThreadPool pool(threads);
+        for (Node& n : work) {
+            pool.submit([this, &n] { Search(n, NULL); });
+        }
+        pool.wait();
+    }
+
+    BranchAndBoundResult res;
+    res.best = best.load();
+    res.xbest = xbest;
+    res.optimal = !stopped.load();
+    res.nodes = nodes.load();
+    res.pruned = pruned.load();
+    res.transpositions = merged.load();
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return res;
+}
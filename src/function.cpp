@@ -4,6 +4,7 @@
 #include <limits>
 #include <string>
 #include <math.h>
+#include <stdio.h>
 
 double sigmoid(double x) {
     double exp_value;
@@ -71,4 +72,21 @@ void read_configs(std::map<std::string, double>& configs){
         }
         fclose(ptr);
     }
-}
\ No newline at end of file
+}
+
+std::string json_quote(const std::string& s) {
+    std::string q = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            q += '\\';
+            q += c;
+        } else if ((unsigned char) c < 0x20) {
+            char hex[8];
+            snprintf(hex, sizeof hex, "\\u%04x", (unsigned char) c);
+            q += hex;
+        } else {
+            q += c;
+        }
+    }
+    return q + '"';
+}
@@ -0,0 +1,192 @@
+#include "instance_generator.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Represents the reserved and export layout of one side of the yard.
+ */
+struct YardSide {
+    std::vector<int> stacks;   /**< The stacks of the side, as w * L + l. */
+    std::vector<int> exports;  /**< The export stack of each export. */
+    std::vector<int> depth;    /**< The height of each export in its stack. */
+    std::vector<int> reserved; /**< The number of reserved containers on top of each stack of the yard. */
+};
+
+static void fail(const std::string& message) {
+    throw std::runtime_error("generate: " + message);
+}
+
+/**
+ * @brief Picks the exports and the reserved containers of one side.
+ */
+static void layout_side(YardSide& side, const std::vector<int>& height, int exports, int reserved,
+        const char* name, std::mt19937& rng) {
+    std::vector<int> filled;
+    for (int s : side.stacks) {
+        if (height[s] > 0) filled.push_back(s);
+    }
+    if ((int) filled.size() < exports) {
+        fail(std::string("only ") + std::to_string(filled.size()) + " non-empty " + name
+                + " stacks for " + std::to_string(exports) + " exports, raise the fill or W");
+    }
+    std::shuffle(filled.begin(), filled.end(), rng);
+    side.reserved.assign(height.size(), 0);
+    side.exports.assign(filled.begin(), filled.begin() + exports);
+    side.depth.resize(exports);
+    if (reserved < 0) {
+        //! Everything stacked on an export has to be moved away first
+        for (int i = 0; i < exports; i++) {
+            int s = side.exports[i];
+            side.depth[i] = std::uniform_int_distribution<int>(0, height[s] - 1)(rng);
+            side.reserved[s] = height[s] - 1 - side.depth[i];
+        }
+        return;
+    }
+    //! Bury the exports one container at a time until the budget is used up
+    std::vector<int> open;
+    for (int i = 0; i < exports; i++) {
+        side.depth[i] = height[side.exports[i]] - 1;
+        if (side.depth[i] > 0) open.push_back(i);
+    }
+    int left = reserved;
+    while (left > 0 && !open.empty()) {
+        int k = std::uniform_int_distribution<int>(0, open.size() - 1)(rng);
+        int i = open[k];
+        side.reserved[side.exports[i]]++;
+        left--;
+        if (--side.depth[i] == 0) {
+            open[k] = open.back();
+            open.pop_back();
+        }
+    }
+    //! Whatever is left is reserved from the tops of the other stacks of the side
+    for (size_t i = exports; i < filled.size(); i++) {
+        open.push_back(filled[i]);
+    }
+    while (left > 0 && !open.empty()) {
+        int k = std::uniform_int_distribution<int>(0, open.size() - 1)(rng);
+        int s = open[k];
+        side.reserved[s]++;
+        left--;
+        if (side.reserved[s] == height[s]) {
+            open[k] = open.back();
+            open.pop_back();
+        }
+    }
+    if (left > 0) {
+        fail(std::string("not enough containers for ") + std::to_string(reserved) + " reserved " + name
+                + " containers, raise the fill or W");
+    }
+}
+
+void generate_instance(const YardSpec& spec, const char* file) {
+    if (spec.W < 1 || spec.H < 1 || spec.L < 1) fail("W, H and L must be positive");
+    if (spec.fill < 0 || spec.fill > 1) fail("the fill ratio must lie in [0, 1]");
+    if (spec.exp_ss < 0 || spec.exp_ls < 0 || spec.imp_ss < 0 || spec.imp_ls < 0) {
+        fail("the import and export counts must not be negative");
+    }
+    long long slots = (long long) spec.W * spec.H * spec.L;
+    if (slots > 100000000) fail("the yard has more than 1e8 slots");
+    int stacks = spec.W * spec.L;
+    int total = (int) llround(spec.fill * slots);
+
+    std::mt19937 rng(spec.seed);
+    //! Drop the containers on random stacks that still have room
+    std::vector<int> height(stacks, 0), open(stacks);
+    for (int s = 0; s < stacks; s++) {
+        open[s] = s;
+    }
+    for (int i = 0; i < total; i++) {
+        int k = std::uniform_int_distribution<int>(0, open.size() - 1)(rng);
+        if (++height[open[k]] == spec.H) {
+            open[k] = open.back();
+            open.pop_back();
+        }
+    }
+
+    YardSide ss, ls;
+    int split = (spec.W + 1) / 2;
+    for (int s = 0; s < stacks; s++) {
+        (s / spec.L < split ? ss : ls).stacks.push_back(s);
+    }
+    layout_side(ss, height, spec.exp_ss, spec.res_ss, "short-span", rng);
+    layout_side(ls, height, spec.exp_ls, spec.res_ls, "long-span", rng);
+    int res_ss = 0, res_ls = 0;
+    for (int s = 0; s < stacks; s++) {
+        res_ss += ss.reserved[s];
+        res_ls += ls.reserved[s];
+    }
+
+    //! Every move into the yard takes one free slot. The long-span crane only sees the
+    //! stacks the short-span crane did not touch, so assume it touched the emptiest ones.
+    std::vector<int> room(stacks);
+    long long free_slots = 0;
+    for (int s = 0; s < stacks; s++) {
+        room[s] = spec.H - height[s];
+        free_slots += room[s];
+    }
+    if (free_slots < (long long) res_ss + spec.imp_ss + res_ls + spec.imp_ls) {
+        fail("only " + std::to_string(free_slots) + " free slots for the reserved moves and imports, lower the fill");
+    }
+    long long touched = 2LL * res_ss + spec.imp_ss + spec.exp_ss;
+    std::sort(room.begin(), room.end(), std::greater<int>());
+    long long ls_room = 0;
+    for (int s = (int) std::min<long long>(touched, stacks); s < stacks; s++) {
+        ls_room += room[s];
+    }
+    if (res_ls + spec.imp_ls > 0 && ls_room < res_ls + spec.imp_ls) {
+        fail("the long-span crane may be left with " + std::to_string(ls_room) + " free slots for "
+                + std::to_string(res_ls + spec.imp_ls) + " moves, lower the fill or the short-span load");
+    }
+
+    //! Number the containers stack by stack from the ground up
+    std::vector<int> first(stacks + 1, 0);
+    for (int s = 0; s < stacks; s++) {
+        first[s + 1] = first[s] + height[s];
+    }
+
+    FILE* out = fopen(file, "w");
+    if (!out) fail(std::string(file) + ": cannot open: " + strerror(errno));
+    fprintf(out, "%d %d %d\n", spec.H, spec.W, spec.L);
+    fprintf(out, "%d\n", total);
+    for (int s = 0; s < stacks; s++) {
+        for (int h = 0; h < height[s]; h++) {
+            fprintf(out, "%d %d %d\n", h, s / spec.L, s % spec.L);
+        }
+    }
+    int areas = 0;
+    for (int s = 0; s < stacks; s++) {
+        if (height[s] < spec.H) areas++;
+    }
+    fprintf(out, "%d\n", areas);
+    for (int s = 0; s < stacks; s++) {
+        if (height[s] < spec.H) fprintf(out, "%d %d %d\n", height[s], s / spec.L, s % spec.L);
+    }
+    const YardSide* sides[] = {&ss, &ls};
+    const int imports[] = {spec.imp_ss, spec.imp_ls};
+    const int counts[] = {res_ss, res_ls};
+    for (int k = 0; k < 2; k++) {
+        const YardSide& side = *sides[k];
+        fprintf(out, "%d\n", counts[k]);
+        for (int s = 0; s < stacks; s++) {
+            for (int h = height[s] - side.reserved[s]; h < height[s]; h++) {
+                fprintf(out, "%d\n", first[s] + h);
+            }
+        }
+        fprintf(out, "%d\n", imports[k]);
+        fprintf(out, "%d\n", (int) side.exports.size());
+        for (size_t i = 0; i < side.exports.size(); i++) {
+            fprintf(out, "%d\n", first[side.exports[i]] + side.depth[i]);
+        }
+    }
+    if (fclose(out) != 0) fail(std::string(file) + ": write failed");
+}
@@ -0,0 +1,161 @@
+#include "instance_reader.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <stdexcept>
+
+static const double pow10_table[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool is_digit(char c) {
+    return (unsigned) (c - '0') < 10u;
+}
+
+InstanceReader::InstanceReader(const char* path) : file(path ? path : "(null)"), begin(NULL), ptr(NULL), end(NULL), length(0) {
+    int fd = path ? open(path, O_RDONLY) : -1;
+    if (fd < 0) {
+        throw std::runtime_error(file + ": cannot open: " + strerror(path ? errno : EINVAL));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error(file + ": cannot stat: " + strerror(err));
+    }
+    length = st.st_size;
+    if (length > 0) {
+        void* m = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            throw std::runtime_error(file + ": cannot map: " + strerror(err));
+        }
+        madvise(m, length, MADV_SEQUENTIAL);
+        begin = static_cast<const char*>(m);
+    }
+    close(fd);
+    ptr = begin;
+    end = begin + length;
+}
+
+InstanceReader::~InstanceReader() {
+    if (begin) {
+        munmap(const_cast<char*>(begin), length);
+    }
+}
+
+void InstanceReader::fail(const std::string& message) const {
+    int line = 1;
+    for (const char* p = begin; p < ptr && p < end; p++) {
+        line += (*p == '\n');
+    }
+    throw std::runtime_error(file + ":" + std::to_string(line) + ": " + message);
+}
+
+void InstanceReader::skip_space(const char* what) {
+    while (ptr < end && (unsigned char) *ptr <= ' ') ptr++;
+    if (ptr == end) {
+        fail(std::string("unexpected end of file reading ") + what);
+    }
+}
+
+int InstanceReader::next_int(const char* what) {
+    skip_space(what);
+    bool neg = (*ptr == '-');
+    ptr += (*ptr == '-' || *ptr == '+');
+    if (ptr == end || !is_digit(*ptr)) {
+        fail(std::string("expected an integer for ") + what);
+    }
+    long long v = 0;
+    while (ptr < end && is_digit(*ptr)) {
+        v = v * 10 + (*ptr++ - '0');
+        if (v > INT_MAX) fail(std::string("integer overflow reading ") + what);
+    }
+    if (ptr < end && (unsigned char) *ptr > ' ') {
+        fail(std::string("malformed integer for ") + what);
+    }
+    return (int) (neg ? -v : v);
+}
+
+int InstanceReader::next_int(const char* what, int lo, int hi) {
+    int v = next_int(what);
+    if (v < lo || v > hi) {
+        fail(std::string(what) + " = " + std::to_string(v) + " is out of range [" +
+                std::to_string(lo) + ", " + std::to_string(hi) + "]");
+    }
+    return v;
+}
+
+double InstanceReader::next_double(const char* what) {
+    skip_space(what);
+    bool neg = (*ptr == '-');
+    ptr += (*ptr == '-' || *ptr == '+');
+    unsigned long long mant = 0;
+    int digits = 0, scale = 0;
+    const char* start = ptr;
+    while (ptr < end && is_digit(*ptr)) {
+        if (digits < 19) {
+            mant = mant * 10 + (*ptr - '0');
+            digits += (mant != 0);
+        } else {
+            scale++;
+        }
+        ptr++;
+    }
+    if (ptr < end && *ptr == '.') {
+        ptr++;
+        while (ptr < end && is_digit(*ptr)) {
+            if (digits < 19) {
+                mant = mant * 10 + (*ptr - '0');
+                digits += (mant != 0);
+                scale--;
+            }
+            ptr++;
+        }
+    }
+    if (ptr == start || (ptr == start + 1 && *start == '.')) {
+        fail(std::string("expected a number for ") + what);
+    }
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+        ptr++;
+        bool eneg = (ptr < end && *ptr == '-');
+        ptr += (ptr < end && (*ptr == '-' || *ptr == '+'));
+        if (ptr == end || !is_digit(*ptr)) {
+            fail(std::string("malformed exponent for ") + what);
+        }
+        int e = 0;
+        while (ptr < end && is_digit(*ptr)) {
+            if (e < 10000) e = e * 10 + (*ptr - '0');
+            ptr++;
+        }
+        scale += eneg ? -e : e;
+    }
+    if (ptr < end && (unsigned char) *ptr > ' ') {
+        fail(std::string("malformed number for ") + what);
+    }
+    double v = (double) mant;
+    //! Exact for the short decimals in the data files, since both operands are exact doubles
+    while (scale < -22) {
+        v /= 1e22;
+        scale += 22;
+    }
+    while (scale > 22) {
+        v *= 1e22;
+        scale -= 22;
+    }
+    v = scale < 0 ? v / pow10_table[-scale] : v * pow10_table[scale];
+    return neg ? -v : v;
+}
+
+bool InstanceReader::at_end() {
+    while (ptr < end && (unsigned char) *ptr <= ' ') ptr++;
+    return ptr == end;
+}
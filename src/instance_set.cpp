@@ -0,0 +1,71 @@
+#include "instance_set.h"
+
+#include <glob.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <stdexcept>
+
+#include "binary_instance.h"
+#include "model_objective.h"
+
+void LoadedInstance::load(int cranes) {
+    const char* path = file.c_str();
+    try {
+        if (kind == "matrix") {
+            Matrix_Model* m = new Matrix_Model(path);
+            model = m;
+            objective = new MatrixObjective(m);
+        } else if (kind == "ss") {
+            SS_Model* m = new SS_Model(path);
+            model = m;
+            objective = new SSObjective(m);
+        } else {
+            All_Model* m = new All_Model(path);
+            model = m;
+            objective = new JointObjective(m, cranes);
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+}
+
+void expand_instance_arg(const std::string& arg, std::vector<std::string>& files) {
+    if (arg.empty()) return;
+    if (arg[0] == '@') {
+        std::ifstream in(arg.c_str() + 1);
+        if (!in) throw std::runtime_error(arg.substr(1) + ": cannot open list");
+        std::string line;
+        while (std::getline(in, line)) {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#') expand_instance_arg(line, files);
+        }
+    } else if (arg.find_first_of("*?[") != std::string::npos) {
+        glob_t g;
+        if (glob(arg.c_str(), 0, NULL, &g) == 0) {
+            for (size_t i = 0; i < g.gl_pathc; i++) {
+                files.push_back(g.gl_pathv[i]);
+            }
+        }
+        globfree(&g);
+    } else {
+        files.push_back(arg);
+    }
+}
+
+std::string detect_instance_kind(const std::string& file) {
+    if (is_binary_instance(file.c_str())) return "all";
+    FILE* f = fopen(file.c_str(), "r");
+    if (!f) return "all";
+    char line[256];
+    int tokens = 0;
+    if (fgets(line, sizeof line, f)) {
+        char* save = NULL;
+        for (char* t = strtok_r(line, " \t\r\n", &save); t; t = strtok_r(NULL, " \t\r\n", &save)) {
+            tokens++;
+        }
+    }
+    fclose(f);
+    return tokens == 7 ? "matrix" : "all";
+}
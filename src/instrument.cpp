@@ -0,0 +1,186 @@
+#include "instrument.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+
+static const char* counter_names[COUNT_KINDS] = {
+    "clone", "evaluation", "ss_solve", "ls_solve", "check_ss", "check_ss_step",
+    "fixed_point_round", "area_pop", "res_pop", "pool_pop", "bound_abort", "relaxed", "alloc", "alloc_bytes"
+};
+
+static const char* timer_names[TIME_KINDS] = {
+    "clone", "analyze", "evaluation", "move", "ss_solve", "ls_solve", "check_ss"
+};
+
+#ifdef PSO_INSTRUMENT
+
+//! Counters live in static storage so they outlive their threads and need no allocation,
+//! which matters because operator new itself is counted. Threads past the last slot are
+//! not counted: they write to a block of their own that no snapshot reads.
+static const int MAX_THREADS = 256;
+static InstrumentCounts blocks[MAX_THREADS];
+static std::atomic<int> used(0);
+static thread_local int slot = -1;
+static thread_local InstrumentCounts overflow;
+
+//! The timestamp counter is calibrated against the steady clock over the whole run
+static uint64_t start_ticks;
+static std::chrono::steady_clock::time_point start_time;
+
+static void report_at_exit() {
+    const char* env = getenv("PSO_INSTRUMENT_OUT");
+    if (env && *env) {
+        FILE* out = fopen(env, "w");
+        if (out) {
+            size_t n = strlen(env);
+            instrument_report(out, n > 5 && strcmp(env + n - 5, ".json") == 0);
+            fclose(out);
+            return;
+        }
+    }
+    instrument_report(stderr, false);
+}
+
+/**
+ * @brief Starts the clock calibration and the summary at exit.
+ */
+struct InstrumentInit {
+    InstrumentInit() {
+        start_ticks = instrument_ticks();
+        start_time = std::chrono::steady_clock::now();
+        atexit(report_at_exit);
+    }
+};
+
+static InstrumentInit init;
+
+InstrumentCounts& instrument_local() {
+    if (slot < 0) slot = used.fetch_add(1);
+    return slot < MAX_THREADS ? blocks[slot] : overflow;
+}
+
+void* operator new(size_t size) {
+    InstrumentCounts& c = instrument_local();
+    c.counts[COUNT_ALLOC]++;
+    c.counts[COUNT_ALLOC_BYTES] += size;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+bool instrument_enabled() {
+    return true;
+}
+
+int instrument_uncounted() {
+    return std::max(0, used.load() - MAX_THREADS);
+}
+
+int instrument_snapshot(InstrumentCounts& total) {
+    memset(&total, 0, sizeof total);
+    int n = std::min(used.load(), MAX_THREADS);
+    for (int t = 0; t < n; t++) {
+        for (int i = 0; i < COUNT_KINDS; i++) total.counts[i] += blocks[t].counts[i];
+        for (int i = 0; i < TIME_KINDS; i++) {
+            total.ticks[i] += blocks[t].ticks[i];
+            total.calls[i] += blocks[t].calls[i];
+        }
+    }
+    return n;
+}
+
+void instrument_reset() {
+    int n = std::min(used.load(), MAX_THREADS);
+    for (int t = 0; t < n; t++) {
+        memset(&blocks[t], 0, sizeof blocks[t]);
+    }
+}
+
+double instrument_seconds(uint64_t ticks) {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    uint64_t spent = instrument_ticks() - start_ticks;
+    if (elapsed <= 0 || spent == 0) return 0;
+    return ticks * (elapsed / spent);
+}
+
+#else
+
+bool instrument_enabled() {
+    return false;
+}
+
+int instrument_uncounted() {
+    return 0;
+}
+
+int instrument_snapshot(InstrumentCounts& total) {
+    memset(&total, 0, sizeof total);
+    return 0;
+}
+
+void instrument_reset() {}
+
+double instrument_seconds(uint64_t ticks) {
+    return ticks * 1e-9;
+}
+
+#endif /* PSO_INSTRUMENT */
+
+void instrument_report(FILE* out, bool json) {
+    InstrumentCounts total;
+    int threads = instrument_snapshot(total);
+    if (json) {
+        fprintf(out, "{\n  \"enabled\": %s,\n  \"threads\": %d,\n  \"uncounted_threads\": %d,\n  \"counters\": {",
+                instrument_enabled() ? "true" : "false", threads, instrument_uncounted());
+        for (int i = 0; i < COUNT_KINDS; i++) {
+            fprintf(out, "%s\n    \"%s\": %llu", i ? "," : "", counter_names[i], (unsigned long long) total.counts[i]);
+        }
+        fprintf(out, "\n  },\n  \"timers\": {");
+        for (int i = 0; i < TIME_KINDS; i++) {
+            fprintf(out, "%s\n    \"%s\": {\"calls\": %llu, \"seconds\": %.6f}", i ? "," : "", timer_names[i],
+                    (unsigned long long) total.calls[i], instrument_seconds(total.ticks[i]));
+        }
+        fprintf(out, "\n  }\n}\n");
+        return;
+    }
+    if (!instrument_enabled()) {
+        fprintf(out, "instrumentation disabled, rebuild with -DPSO_INSTRUMENT\n");
+        return;
+    }
+    fprintf(out, "-- instrumentation (%d threads) --\n", threads);
+    if (instrument_uncounted()) fprintf(out, "%d more threads were not counted\n", instrument_uncounted());
+    for (int i = 0; i < COUNT_KINDS; i++) {
+        fprintf(out, "%-20s %16llu\n", counter_names[i], (unsigned long long) total.counts[i]);
+    }
+    fprintf(out, "%-20s %16s %12s %12s\n", "timer", "calls", "seconds", "ns/call");
+    for (int i = 0; i < TIME_KINDS; i++) {
+        double s = instrument_seconds(total.ticks[i]);
+        fprintf(out, "%-20s %16llu %12.6f %12.1f\n", timer_names[i], (unsigned long long) total.calls[i], s,
+                total.calls[i] ? s * 1e9 / total.calls[i] : 0.0);
+    }
+}
@@ -1,6 +1,7 @@
 #include <linear_graph.h>
 
 #include <math.h>
+#include <stdio.h>
 
 int TimeGraph::get_type() {
     return 0;
@@ -34,21 +35,19 @@ void TimeGraph::set_mode(int _mode, int _counter, bool _is_wait){
 }
 
 void TimeGraph::get_mode(){
-    switch (mode) {
-      case 0:
-        printf("(RES-%d-%d)", counter, is_wait);
-      break;
-      case 1:
-        printf("(IMP-%d-%d)", counter, is_wait);
-      break;
-      case 2:
-        printf("(EXP-%d-%d)", counter, is_wait);
-      break;
-      case 3:
-        printf("(BACK)");
-      break;
-      default:
-      break;
+    std::string label;
+    get_mode(label);
+    fputs(label.c_str(), stdout);
+}
+
+void TimeGraph::get_mode(std::string& out) const {
+    static const char* names[] = {"RES", "IMP", "EXP"};
+    char label[48];
+    if (mode >= 0 && mode < 3) {
+        snprintf(label, sizeof label, "(%s-%d-%d)", names[mode], counter, is_wait);
+        out += label;
+    } else if (mode == 3) {
+        out += "(BACK)";
     }
 }
 
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+
+#include "function.h"
+#include "instance_reader.h"
+#include "matrix_model.h"
+#include "instrument.h"
+
+Matrix_Model::Matrix_Model() {
+}
+
+Matrix_Model::Matrix_Model(const char*& input) {
+    load_data(input);
+    calculate_malloc_size();
+}
+
+Matrix_Model::~Matrix_Model() {
+}
+
+void Matrix_Model::load_data(const char* file) {
+    InstanceReader in(file);
+    side_of_working = in.next_int("side_of_working", 0, INT_MAX);
+    ss = in.next_int("ss", 0, INT_MAX);
+    ls = in.next_int("ls", 0, INT_MAX);
+    import_container = in.next_int("import_container", 0, INT_MAX);
+    free_area = in.next_int("free_area", ss + ls, INT_MAX);
+    export_container = in.next_int("export_container", ss + ls, INT_MAX);
+    movement = in.next_int("movement", 0, INT_MAX);
+    if (ls > 0 && side_of_working < 2) {
+        in.fail("long-span moves need two working sides");
+    }
+    time_side_to_a.resize(side_of_working);
+    for (int i = 0; i < side_of_working; i++) {
+        time_side_to_a[i].resize(free_area);
+        for (int j = 0; j < free_area; j++) {
+            time_side_to_a[i][j] = in.next_double("time_side_to_a");
+        }
+    }
+    time_side_to_c.resize(side_of_working);
+    for (int i = 0; i < side_of_working; i++) {
+        time_side_to_c[i].resize(export_container);
+        for (int j = 0; j < export_container; j++) {
+            time_side_to_c[i][j] = in.next_double("time_side_to_c");
+        }
+    }
+    time_a_to_c.resize(free_area);
+    for (int i = 0; i < free_area; i++) {
+        time_a_to_c[i].resize(export_container);
+        for (int j = 0; j < export_container; j++) {
+            time_a_to_c[i][j] = in.next_double("time_a_to_c");
+        }
+    }
+}
+
+int Matrix_Model::calculate_malloc_size() {
+    upper.resize((ss + ls) * 2);
+    lower.resize((ss + ls) * 2);
+    start_bit.resize((ss + ls) * 2);
+    bitnum.resize((ss + ls) * 2);
+    int sbit = 0;
+    for (int i = 0; i < ss; i++) {
+        lower[i * 2] = 0;
+        lower[i * 2 + 1] = 0;
+        upper[i * 2] = ss - 1 - i;
+        upper[i * 2 + 1] = free_area - 1 - i;
+        start_bit[i * 2] = sbit;
+        bitnum[i * 2] = decimal_2_binary_size(upper[i * 2]);
+        sbit += bitnum[i * 2];
+        start_bit[i * 2 + 1] = sbit;
+        bitnum[i * 2 + 1] = decimal_2_binary_size(upper[i * 2 + 1]);
+        sbit += bitnum[i * 2 + 1];
+    }
+    for (int j = 0; j < ls; j++) {
+        int i = j + ss;
+        lower[i * 2] = 0;
+        lower[i * 2 + 1] = 0;
+        upper[i * 2] = ls - 1 - j;
+        upper[i * 2 + 1] = free_area - 1 - j - ss;
+        start_bit[i * 2] = sbit;
+        bitnum[i * 2] = decimal_2_binary_size(upper[i * 2]);
+        sbit += bitnum[i * 2];
+        start_bit[i * 2 + 1] = sbit;
+        bitnum[i * 2 + 1] = decimal_2_binary_size(upper[i * 2 + 1]);
+        sbit += bitnum[i * 2 + 1];
+    }
+    allocate_size = sbit;
+    return allocate_size;
+}
+
+Matrix_Model* Matrix_Model::clone() {
+    PSO_COUNT(COUNT_CLONE);
+    return new Matrix_Model(*this);
+}
+
+double Matrix_Model::fx_function_solve(int, char* x, bool display) {
+    int mss = ss;
+    int mls = ls + ss;
+    int ma = free_area;
+    std::vector<int> set_export_container(export_container);
+    std::vector<int> set_area(free_area);
+    for (int i = 0; i < export_container; i++)
+        set_export_container[i] = i;
+    for (int i = 0; i < free_area; i++)
+        set_area[i] = i;
+    double y = 0;
+    for (int i = 0; i < ss; i++) {
+        int ic = binary_2_decimal(bitnum[i * 2], &x[start_bit[i * 2]]);
+        int ia = binary_2_decimal(bitnum[i * 2 + 1], &x[start_bit[i * 2 + 1]]);
+        ic = (ic / pow(2, bitnum[i * 2])) * upper[i * 2];
+        ia = (ia / pow(2, bitnum[i * 2 + 1])) * upper[i * 2 + 1];
+        int tc = set_export_container[ic];
+        int ta = set_area[ia];
+        set_export_container[ic] = set_export_container[mss - 1];
+        set_area[ia] = set_area[ma - 1];
+        mss--;
+        ma--;
+        double sum = time_side_to_a[0][ta] + time_a_to_c[ta][tc] + time_side_to_c[0][tc];
+        if (display) printf("SS: 1, %d, %d, %d, %d, %lf(%lf, %lf, %lf)\n", i + 1, ta + 1, tc + 1, i + 1, sum, time_side_to_a[0][ta], time_a_to_c[ta][tc], time_side_to_c[0][tc]);
+        y += sum;
+    }
+    for (int i = ss; i < (ls + ss); i++) {
+        int ic = binary_2_decimal(bitnum[i * 2], &x[start_bit[i * 2]]);
+        int ia = binary_2_decimal(bitnum[i * 2 + 1], &x[start_bit[i * 2 + 1]]);
+        ic = (ic / pow(2, bitnum[i * 2])) * upper[i * 2];
+        ia = (ia / pow(2, bitnum[i * 2 + 1])) * upper[i * 2 + 1];
+        ic += ss;
+        int tc = set_export_container[ic];
+        int ta = set_area[ia];
+        set_export_container[ic] = set_export_container[mls - 1];
+        set_area[ia] = set_area[ma - 1];
+        mls--;
+        ma--;
+        double sum = time_side_to_a[1][ta] + time_a_to_c[ta][tc] + time_side_to_c[1][tc];
+        if (display) printf("LS: 2, %d, %d, %d, %d, %lf(%lf, %lf, %lf)\n", i + 1, ta + 1, tc + 1, i + 1, sum, time_side_to_a[1][ta], time_a_to_c[ta][tc], time_side_to_c[1][tc]);
+        y += sum;
+    }
+    return y;
+}
+
+void Matrix_Model::display() {
+    printf("===============================================\n");
+    printf("SIDES: %d, SS: %d, LS: %d, AREAS: %d, EXPORTS: %d\n", side_of_working, ss, ls, free_area, export_container);
+    printf("BITS: %d\n", allocate_size);
+    printf("===============================================\n");
+}
@@ -19,8 +19,8 @@ void Model::load_data(const char* file) {
     ptr = fopen(file, "r");
     if (ptr) {
         //! Do Nothing
+        fclose(ptr);
     }
-    fclose(ptr);
 }
 
 Model* Model::clone() {
@@ -0,0 +1,102 @@
+#include "perf_counters.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* event_names[PERF_EVENTS] = {
+    "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+#ifdef __linux__
+
+static const uint64_t event_configs[PERF_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+//! Explains the usual failure, a `perf_event_paranoid` setting above what the user may count
+static std::string open_error(int err) {
+    std::string msg = std::string("perf_event_open: ") + strerror(err);
+    if (err == EACCES || err == EPERM) {
+        FILE* f = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+        int level;
+        if (f && fscanf(f, "%d", &level) == 1) {
+            char buf[64];
+            snprintf(buf, sizeof buf, " (perf_event_paranoid is %d)", level);
+            msg += buf;
+        }
+        if (f) fclose(f);
+    }
+    return msg;
+}
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        fds[i] = -1;
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = event_configs[i];
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) {
+            if (why.empty()) why = std::string(event_names[i]) + ": " + open_error(errno);
+            continue;
+        }
+        fds[i] = fd;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+}
+
+void PerfCounters::read(PerfSample& s) const {
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        s.counts[i] = 0;
+        uint64_t v[3];
+        if (fds[i] < 0 || ::read(fds[i], v, sizeof v) != (ssize_t) sizeof v) continue;
+        //! v holds the count, the time enabled and the time running on the PMU
+        if (v[2] > 0 && v[2] < v[1]) {
+            s.counts[i] = (uint64_t) ((double) v[0] * v[1] / v[2]);
+        } else {
+            s.counts[i] = v[0];
+        }
+    }
+}
+
+#else
+
+PerfCounters::PerfCounters() : why("hardware counters need Linux perf_event_open") {
+    for (int i = 0; i < PERF_EVENTS; i++) fds[i] = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::read(PerfSample& s) const {
+    for (int i = 0; i < PERF_EVENTS; i++) s.counts[i] = 0;
+}
+
+#endif /* __linux__ */
+
+bool PerfCounters::available() const {
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        if (fds[i] >= 0) return true;
+    }
+    return false;
+}
+
+const char* PerfCounters::name(PerfEvent e) {
+    return event_names[e];
+}
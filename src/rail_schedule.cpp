@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "rail_schedule.h"
+
+RailSchedule::RailSchedule(int cranes, int bays) {
+    W = bays;
+    cranes = std::max(2, std::min(cranes, W + 2));
+    homes.resize(cranes);
+    ends.resize(cranes, 0);
+    lines.resize(cranes);
+    homes[0] = -1;
+    homes[cranes - 1] = W;
+    //! Intermediate cranes wait at the centre of their zone
+    for (int m = 1; m < cranes - 1; m++) {
+        int lo = W, hi = -1;
+        for (int b = 0; b < W; b++) {
+            if (zone(b) == m) {
+                lo = std::min(lo, b);
+                hi = std::max(hi, b);
+            }
+        }
+        homes[m] = (lo + hi) / 2;
+    }
+    last_bay = homes;
+}
+
+int RailSchedule::zone(int bay) const {
+    int k = homes.size();
+    if (k <= 2 || bay < 0 || bay >= W) return -1;
+    return 1 + bay * (k - 2) / W;
+}
+
+int RailSchedule::check(int crane, const RailSegment& src, int& cursor) const {
+    if (crane == 0) return 0;
+    const std::vector<RailSegment>& nb = lines[crane - 1];
+    int n = nb.size();
+    int shifter = 0;
+    int i = src.min_x;
+    int j = src.min_x;
+    while (cursor < n && !nb[cursor].inner(i)) {
+        cursor++;
+    }
+    while (cursor < n) {
+        if (nb[cursor].get_value(i + shifter) >= src.get_value(j)) {
+            shifter += 1;
+        } else {
+            i += 1;
+            j += 1;
+        }
+        while (cursor < n && nb[cursor].outer(i + shifter)) cursor++;
+        if (src.outer(j)) break;
+    }
+    return shifter;
+}
+
+double RailSchedule::run_free(int crane, const std::vector<CraneTask>& tasks) {
+    std::vector<RailSegment>& line = lines[crane];
+    int h = homes[crane];
+    int y = 0, counter = 0;
+    int last_x = h, last_y = -1;
+    for (auto& t : tasks) {
+        int d;
+        if (t.mode == 0) {
+            //! RESERVED
+            if (last_x != t.from_w || last_y != t.from_l) {
+                d = abs(last_x - t.from_w) * const_travel_time;
+                line.push_back(RailSegment(y, y + d, last_x, t.from_w, 0, counter));
+                y += d;
+            }
+            line.push_back(RailSegment(y, y + CONTROL_TIME, t.from_w, t.from_w, 0, counter));
+            y += CONTROL_TIME;
+            d = abs(t.to_w - t.from_w) * const_travel_time;
+            line.push_back(RailSegment(y, y + d, t.from_w, t.to_w, 0, counter));
+            y += d;
+            line.push_back(RailSegment(y, y + CONTROL_TIME, t.to_w, t.to_w, 0, counter++));
+            y += CONTROL_TIME;
+            last_x = t.to_w;
+            last_y = t.to_l;
+        } else if (t.mode == 1) {
+            //! IMPORT
+            if (last_x != h) {
+                d = abs(last_x - h) * const_travel_time;
+                line.push_back(RailSegment(y, y + d, last_x, h, 1, counter));
+                y += d;
+            }
+            line.push_back(RailSegment(y, y + CONTROL_TIME, h, h, 1, counter));
+            y += CONTROL_TIME;
+            d = abs(t.to_w - h) * const_travel_time;
+            line.push_back(RailSegment(y, y + d, h, t.to_w, 1, counter));
+            y += d;
+            line.push_back(RailSegment(y, y + CONTROL_TIME, t.to_w, t.to_w, 1, counter++));
+            y += CONTROL_TIME;
+            last_x = t.to_w;
+            last_y = t.to_l;
+        } else {
+            //! EXPORT
+            if (last_x != t.from_w || last_y != t.from_l) {
+                d = abs(t.from_w - last_x) * const_travel_time;
+                line.push_back(RailSegment(y, y + d, last_x, t.from_w, 2, counter));
+                y += d;
+            }
+            line.push_back(RailSegment(y, y + CONTROL_TIME, t.from_w, t.from_w, 2, counter));
+            y += CONTROL_TIME;
+            d = abs(t.from_w - h) * const_travel_time;
+            line.push_back(RailSegment(y, y + d, t.from_w, h, 2, counter));
+            y += d;
+            line.push_back(RailSegment(y, y + CONTROL_TIME, h, h, 2, counter++));
+            y += CONTROL_TIME;
+            last_x = h;
+            last_y = -1;
+        }
+    }
+    if (last_x != h || last_y != -1) {
+        int d = abs(last_x - h) * const_travel_time;
+        line.push_back(RailSegment(y, y + d, last_x, h, 3, counter));
+        y += d;
+    }
+    ends[crane] = y;
+    return y;
+}
+
+double RailSchedule::run_anchored(int crane, const std::vector<CraneTask>& tasks) {
+    struct Leg {
+        int d, a, b;
+        bool optional;
+    };
+    std::vector<RailSegment>& line = lines[crane];
+    int h = homes[crane];
+    int y = 0, counter = 0, cursor = 0;
+    Leg legs[5];
+    for (auto& t : tasks) {
+        int n = 0;
+        if (t.mode == 0) {
+            //! RESERVED
+            legs[n++] = {abs(h - t.from_w) * const_travel_time, h, t.from_w, false};
+            legs[n++] = {CONTROL_TIME, t.from_w, t.from_w, false};
+            legs[n++] = {abs(t.from_w - t.to_w) * const_travel_time, t.from_w, t.to_w, true};
+            legs[n++] = {CONTROL_TIME, t.to_w, t.to_w, false};
+            legs[n++] = {abs(t.to_w - h) * const_travel_time, t.to_w, h, false};
+        } else if (t.mode == 1) {
+            //! IMPORT
+            legs[n++] = {CONTROL_TIME, h, h, false};
+            legs[n++] = {abs(t.to_w - h) * const_travel_time, h, t.to_w, false};
+            legs[n++] = {CONTROL_TIME, t.to_w, t.to_w, false};
+            legs[n++] = {abs(h - t.to_w) * const_travel_time, t.to_w, h, false};
+        } else {
+            //! EXPORT
+            legs[n++] = {abs(t.from_w - h) * const_travel_time, h, t.from_w, false};
+            legs[n++] = {CONTROL_TIME, t.from_w, t.from_w, false};
+            legs[n++] = {abs(h - t.from_w) * const_travel_time, t.from_w, h, false};
+            legs[n++] = {CONTROL_TIME, h, h, false};
+        }
+
+        //! Delay the whole move until no leg crosses the left neighbour
+        int prev_cursor = cursor;
+        int total_shift = 0, prev_total_shift = 0;
+        do {
+            cursor = prev_cursor;
+            prev_total_shift = total_shift;
+            int ty = y + total_shift;
+            for (int k = 0; k < n; k++) {
+                if (legs[k].optional && legs[k].d <= 0) continue;
+                int shift = check(crane, RailSegment(ty, ty + legs[k].d, legs[k].a, legs[k].b), cursor);
+                total_shift += shift;
+                ty += shift + legs[k].d;
+            }
+        } while (prev_total_shift != total_shift);
+
+        if (total_shift > 0) {
+            line.push_back(RailSegment(y, y + total_shift, h, h, t.mode, counter, true));
+            y += total_shift;
+        }
+        for (int k = 0; k < n; k++) {
+            if (legs[k].optional && legs[k].d <= 0) continue;
+            line.push_back(RailSegment(y, y + legs[k].d, legs[k].a, legs[k].b, t.mode, counter));
+            y += legs[k].d;
+        }
+        counter++;
+    }
+    ends[crane] = y;
+    return y;
+}
+
+int RailSchedule::clear(int crane, int lo, int hi, int to, int s, int d) {
+    bool moved = true;
+    while (moved) {
+        moved = false;
+        for (int side = -1; side <= 1 && !moved; side += 2) {
+            int nb = crane + side;
+            if (nb < 0 || nb >= size()) continue;
+            const std::vector<RailSegment>& line = lines[nb];
+            std::vector<RailSegment>::const_iterator it = std::upper_bound(line.begin(), line.end(), s,
+                    [](int x, const RailSegment& g) { return x < g.max_x; });
+            for (; it != line.end(); ++it) {
+                //! After the leg the crane stays at `to` for as long as the neighbour is already scheduled
+                int a = it->min_x < s + d ? lo : to, b = it->min_x < s + d ? hi : to;
+                bool in_way = side > 0 ? std::min(it->min_y, it->max_y) <= b : std::max(it->min_y, it->max_y) >= a;
+                if (in_way) {
+                    s = it->max_x;
+                    moved = true;
+                    break;
+                }
+            }
+            if (!moved && ends[nb] < s + d && (side > 0 ? last_bay[nb] <= hi : last_bay[nb] >= lo)) {
+                yield(nb, side > 0 ? hi + 1 : lo - 1);
+                moved = true;
+            }
+        }
+    }
+    return s;
+}
+
+void RailSchedule::place(int crane, int to, int d, int mode, int counter) {
+    int from = last_bay[crane];
+    int y = ends[crane];
+    int s = clear(crane, std::min(from, to), std::max(from, to), to, y, d);
+    if (s > y) {
+        lines[crane].push_back(RailSegment(y, s, from, from, mode, counter, true));
+    }
+    lines[crane].push_back(RailSegment(s, s + d, from, to, mode, counter));
+    ends[crane] = s + d;
+    last_bay[crane] = to;
+}
+
+void RailSchedule::yield(int crane, int to) {
+    place(crane, to, abs(to - last_bay[crane]) * const_travel_time, 4, -1);
+}
+
+double RailSchedule::run(const std::vector<std::vector<CraneTask> >& lists) {
+    int k = size();
+    if (k == 2) {
+        run_free(0, lists[0]);
+        run_anchored(1, lists[1]);
+        return makespan();
+    }
+    //! Every task is a pick stop and a drop stop, and the last stop of a crane is its home
+    std::vector<int> stop(k, 0);
+    while (true) {
+        int c = -1;
+        for (int i = 0; i < k; i++) {
+            if (stop[i] <= 2 * (int) lists[i].size() && (c < 0 || ends[i] < ends[c])) c = i;
+        }
+        if (c < 0) break;
+        int n = stop[c]++, task = n / 2, h = homes[c];
+        if (task == (int) lists[c].size()) {
+            if (last_bay[c] != h) place(c, h, abs(last_bay[c] - h) * const_travel_time, 3, task);
+            continue;
+        }
+        const CraneTask& t = lists[c][task];
+        int bay = n % 2 == 0 ? (t.mode == 1 ? h : t.from_w) : (t.mode == 2 ? h : t.to_w);
+        if (last_bay[c] != bay) place(c, bay, abs(last_bay[c] - bay) * const_travel_time, t.mode, task);
+        place(c, bay, CONTROL_TIME, t.mode, task);
+    }
+    return makespan();
+}
+
+void RailSchedule::events(std::vector<ScheduleEvent>& out) const {
+    for (int c = 0; c < size(); c++) {
+        for (auto& s : lines[c]) {
+            ScheduleEvent e = {s.is_wait ? EVENT_WAIT : s.min_y != s.max_y ? EVENT_MOVE : EVENT_PICK, c, s.mode, false,
+                    -1, -1, -1, s.min_y, -1, -1, s.max_y, -1, (double) s.min_x, (double) (s.max_x - s.min_x)};
+            out.push_back(e);
+        }
+    }
+}
+
+double RailSchedule::makespan() const {
+    double y = 0;
+    for (auto& e : ends) {
+        y = std::max(y, e);
+    }
+    return y;
+}
+
+void RailSchedule::display() const {
+    static const char* modes[] = {"RES", "IMP", "EXP", "BACK", "YIELD"};
+    for (int c = 0; c < size(); c++) {
+        printf("----- CRANE %d (HOME %d, END %lf) -----\n", c, homes[c], ends[c]);
+        for (auto& s : lines[c]) {
+            printf("%d -> %d\t%d -> %d\t(%s-%d-%d)\n", s.min_x, s.max_x, s.min_y, s.max_y,
+                    modes[s.mode], s.counter, s.is_wait);
+        }
+    }
+}
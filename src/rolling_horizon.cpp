@@ -0,0 +1,226 @@
+#include "rolling_horizon.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include "model_objective.h"
+#include "optimizers.h"
+#include "rail_schedule.h"
+#include "schedule_sink.h"
+
+bool parse_stream_job(const std::string& line, StreamJob& job) {
+    std::istringstream in(line);
+    std::string kind, crane;
+    if (!(in >> kind) || kind[0] == '#') return false;
+    if (!(in >> crane) || (kind != "imp" && kind != "exp") || (crane != "ss" && crane != "ls")) {
+        throw std::runtime_error("bad job '" + line + "', expected imp|exp ss|ls [container]");
+    }
+    job.ls = crane == "ls";
+    job.import = kind == "imp";
+    job.container = -1;
+    if (!job.import && !(in >> job.container)) {
+        throw std::runtime_error("bad job '" + line + "', an export needs a container");
+    }
+    std::string rest;
+    if (in >> rest) throw std::runtime_error("bad job '" + line + "', unexpected '" + rest + "'");
+    return true;
+}
+
+RollingHorizon::RollingHorizon(const char* yard, const BinaryPSOParams& p, int w, unsigned s)
+    : params(p), window(w), seed(s), sink(NULL), now(0) {
+    if (window < 1) throw std::runtime_error("the window must take at least one job");
+    All_Model model(yard);
+    AllModelData d = model.get_data();
+    H = d.H;
+    W = d.W;
+    L = d.L;
+    stacks.resize(W * L);
+    open.assign(W * L, false);
+    last_container = -1;
+    //! Containers are stacked by height, as `All_Model` stacks them
+    std::vector<std::pair<int, int> > order;
+    for (auto& it : d.containers) {
+        last_container = std::max(last_container, it.first);
+        if (it.second._w >= 0 && it.second._l >= 0) order.push_back(std::make_pair(it.second._h, it.first));
+    }
+    std::stable_sort(order.begin(), order.end());
+    for (auto& it : order) {
+        const dat& c = d.containers.at(it.second);
+        stacks[c._w * L + c._l].push_back(it.second);
+        where[it.second] = c._w * L + c._l;
+    }
+    for (const dat& a : d.areas) open[a._w * L + a._l] = true;
+
+    //! The instance's own exports may make the room for its imports, so the room is
+    //! checked once all of them are queued
+    StreamJob job;
+    for (int k = 0; k < 2; k++) {
+        job.ls = k == 1;
+        job.import = true;
+        job.container = -1;
+        for (int i = 0, n = k ? d.imp_ls : d.imp_ss; i < n; i++) queue.push_back(job);
+        job.import = false;
+        for (int c : k ? d.exp_ls : d.exp_ss) {
+            job.container = c;
+            add(job);
+        }
+    }
+    if (Room() < 0) throw std::runtime_error("the instance imports more containers than the yard holds");
+}
+
+long long RollingHorizon::Room() const {
+    long long room = 0;
+    for (int s = 0; s < W * L; s++) {
+        if (open[s]) room += H - (long long) stacks[s].size();
+    }
+    for (const StreamJob& q : queue) room += q.import ? -1 : open[where.at(q.container)];
+    return room;
+}
+
+void RollingHorizon::add(const StreamJob& job) {
+    if (!job.import) {
+        if (where.find(job.container) == where.end()) {
+            throw std::runtime_error("export of container " + std::to_string(job.container) + ", which is not in the yard");
+        }
+        for (const StreamJob& q : queue) {
+            if (!q.import && q.container == job.container) {
+                throw std::runtime_error("container " + std::to_string(job.container) + " is already exported");
+            }
+        }
+    } else if (Room() <= 0) {
+        throw std::runtime_error("import with no free slot left in the yard");
+    }
+    queue.push_back(job);
+}
+
+std::map<int, dat> RollingHorizon::containers() const {
+    std::map<int, dat> out;
+    for (int s = 0; s < W * L; s++) {
+        for (size_t h = 0; h < stacks[s].size(); h++) {
+            out.insert(std::make_pair(stacks[s][h], dat(h, s / L, s % L)));
+        }
+    }
+    return out;
+}
+
+void RollingHorizon::Apply(const std::vector<CraneTask>& tasks) {
+    for (const CraneTask& t : tasks) {
+        int c = t.container;
+        if (t.mode != 1) {
+            std::vector<int>& from = stacks[where.at(c)];
+            from.erase(std::find(from.begin(), from.end(), c));
+            where.erase(c);
+        }
+        if (t.mode == 1) c = ++last_container;
+        if (t.mode != 2) {
+            stacks[t.to_w * L + t.to_l].push_back(c);
+            where[c] = t.to_w * L + t.to_l;
+        }
+    }
+}
+
+RollingWindow RollingHorizon::step() {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    if (queue.empty()) throw std::runtime_error("no job is queued");
+
+    //! Take the oldest jobs the yard can hold, at most one export per stack
+    AllModelData d;
+    d.H = H;
+    d.W = W;
+    d.L = L;
+    d.imp_ss = d.imp_ls = 0;
+    std::set<int> exporting;
+    std::vector<bool> taken(queue.size(), false);
+    int jobs = 0;
+    for (size_t q = 0; q < queue.size() && jobs < window; q++) {
+        const StreamJob& job = queue[q];
+        AllModelData next = d;
+        std::set<int> stacks_out = exporting;
+        if (job.import) {
+            (job.ls ? next.imp_ls : next.imp_ss)++;
+        } else {
+            int s = where.at(job.container);
+            if (!stacks_out.insert(s).second) continue;
+            (job.ls ? next.exp_ls : next.exp_ss).insert(job.container);
+            const std::vector<int>& stack = stacks[s];
+            size_t k = std::find(stack.begin(), stack.end(), job.container) - stack.begin();
+            for (size_t i = k + 1; i < stack.size(); i++) (job.ls ? next.res_ls : next.res_ss).insert(stack[i]);
+        }
+        //! Every move into the yard takes a free slot. The long-span crane only sees the
+        //! stacks the short-span crane did not touch, so assume it touched the roomiest ones.
+        std::vector<int> room;
+        long long free_slots = 0;
+        for (int s = 0; s < W * L; s++) {
+            if (open[s] && !stacks_out.count(s) && (int) stacks[s].size() < H) {
+                room.push_back(H - stacks[s].size());
+                free_slots += room.back();
+            }
+        }
+        long long res_ss = next.res_ss.size(), res_ls = next.res_ls.size();
+        if (free_slots < res_ss + next.imp_ss + res_ls + next.imp_ls) continue;
+        std::sort(room.begin(), room.end(), std::greater<int>());
+        long long touched = 2 * res_ss + next.imp_ss + next.exp_ss.size(), ls_room = 0;
+        for (size_t s = std::min<long long>(touched, room.size()); s < room.size(); s++) ls_room += room[s];
+        if (res_ls + next.imp_ls > 0 && ls_room < res_ls + next.imp_ls) continue;
+        d = next;
+        exporting = stacks_out;
+        taken[q] = true;
+        jobs++;
+    }
+    RollingWindow w;
+    w.jobs = jobs;
+    w.start = now;
+    w.dropped = 0;
+    if (jobs == 0) {
+        //! Nothing committed means nothing moves, so the queue would never drain
+        queue.pop_front();
+        w.moves = 0;
+        w.makespan = 0;
+        w.evaluations = 0;
+        w.dropped = 1;
+        w.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return w;
+    }
+
+    for (int s = 0; s < W * L; s++) {
+        for (size_t h = 0; h < stacks[s].size(); h++) {
+            d.containers.insert(std::make_pair(stacks[s][h], dat(h, s / L, s % L)));
+        }
+        if (open[s] && !exporting.count(s) && (int) stacks[s].size() < H) {
+            d.areas.push_back(dat(stacks[s].size(), s / L, s % L));
+        }
+    }
+    std::deque<StreamJob> rest;
+    for (size_t q = 0; q < queue.size(); q++) {
+        if (!taken[q]) rest.push_back(queue[q]);
+    }
+    queue.swap(rest);
+
+    All_Model master(d);
+    JointObjective objective(&master);
+    Optimizer* opt = make_optimizer(params, seed++);
+    BinaryPSOResult res = opt->Run(objective);
+    delete opt;
+
+    w.evaluations = res.evaluations;
+    All_Model* m = master.clone();
+    OffsetScheduleSink shifted(sink, now);
+    if (sink) m->set_schedule_sink(&shifted);
+    w.makespan = m->fx_function_solve_joint(objective.Size(), res.xbest.data(), sink != NULL);
+    delete m;
+
+    std::vector<CraneTask> ss, ls;
+    m = master.clone();
+    m->decode_tasks(res.xbest.data(), ss, ls);
+    delete m;
+    Apply(ss);
+    Apply(ls);
+    w.moves = ss.size() + ls.size();
+    now += w.makespan;
+    w.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return w;
+}
@@ -0,0 +1,204 @@
+#include "schedule_sink.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <stdexcept>
+
+static const char* event_names[] = {"MOVE", "PICK", "DROP", "WAIT"};
+static const char* mode_names[] = {"RES", "IMP", "EXP", "BACK", "YIELD"};
+static const char* crane_names[] = {"SS", "LS", "C2", "C3", "C4", "C5", "C6", "C7", "C8", "C9"};
+
+//! Modes and cranes past the tables, as a binary stream read back may hold, get a placeholder
+static const char* mode_name(int mode) {
+    return mode >= 0 && mode < 5 ? mode_names[mode] : "?";
+}
+
+static const char* crane_name(int crane) {
+    return crane >= 0 && crane < 10 ? crane_names[crane] : "C?";
+}
+static const size_t SPILL_SIZE = 1 << 16;
+
+void BufferedScheduleSink::append(const char* format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof line, format, args);
+    va_end(args);
+    if (n < 0) return;
+    if ((size_t) n < sizeof line) {
+        buf.append(line, n);
+    } else {
+        std::string big(n + 1, '\0');
+        va_start(args, format);
+        vsnprintf(&big[0], big.size(), format, args);
+        va_end(args);
+        buf.append(big.data(), n);
+    }
+}
+
+void BufferedScheduleSink::spill() {
+    if (buf.size() >= SPILL_SIZE) flush();
+}
+
+void BufferedScheduleSink::flush() {
+    if (!buf.empty() && out) {
+        fwrite(buf.data(), 1, buf.size(), out);
+    }
+    buf.clear();
+}
+
+BufferedScheduleSink::~BufferedScheduleSink() {
+    flush();
+}
+
+void TextScheduleSink::emit(const ScheduleEvent& e) {
+    double s = e.start, d = e.duration, t = e.start + e.duration;
+    const char* crane = crane_name(e.crane);
+    if (e.type == EVENT_WAIT) {
+        append("WAIT %lf (%f + %f -> %f)\n", d, s, d, t);
+    } else if (e.type == EVENT_PICK || e.type == EVENT_DROP) {
+        append("%s %s%d (%lf + %lf -> %lf)\n", event_names[e.type], e.mode == 1 ? "IMP-" : "", e.container + 1, s, d, t);
+    } else if (e.mode == 3) {
+        append("TRAVEL BACK %d, %d (%lf + %lf -> %lf)\n", e.from_w, e.from_l, s, d, t);
+    } else if (e.mode == 4) {
+        append("%s YIELD %d TO %d (%lf + %lf -> %lf)\n", crane, e.from_w, e.to_w, s, d, t);
+    } else if (e.crane == 1 && !e.loaded && e.to_h < 0) {
+        append("Move ( %d, %d, %d ) to LS (%lf + %lf -> %lf)\n", e.from_h, e.from_w, e.from_l, s, d, t);
+    } else if (e.mode == 0) {
+        if (e.loaded) {
+            //! The long-span line never had a space after the plus
+            append(e.crane ? "Move %d( %d, %d, %d ) to ( %d, %d, %d ) (%lf +%lf -> %f)\n"
+                    : "Move %d( %d, %d, %d ) to ( %d, %d, %d ) (%lf + %lf -> %f)\n", e.container + 1,
+                    e.from_h, e.from_w, e.from_l, e.to_h, e.to_w, e.to_l, s, d, t);
+        } else if (e.crane == 0) {
+            append("MOVE FROM %d, %d TO %d, %d (%lf + %lf -> %lf)\n", e.from_w, e.from_l, e.to_w, e.to_l, s, d, t);
+        } else {
+            append("MOVE FROM LS TO %d, %d (%lf + %lf -> %lf)\n", e.to_w, e.to_l, s, d, t);
+        }
+    } else if (e.mode == 1) {
+        if (e.loaded) {
+            append("IMP MOVE IMP-%d TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n", e.container + 1, e.area + 1,
+                    e.to_h, e.to_w, e.to_l, s, d, t);
+        } else {
+            append("IMP MOVE FROM %d, %d TO %s (%lf + %lf -> %lf)\n", e.from_w, e.from_l, crane, s, d, t);
+        }
+    } else {
+        if (e.loaded) {
+            append("EXP MOVE %d (%d, %d, %d) TO %s (%lf + %lf -> %lf)\n", e.container + 1,
+                    e.from_h, e.from_w, e.from_l, crane, s, d, t);
+        } else if (e.crane == 0) {
+            append("EXP MOVE FROM %d, %d TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n", e.from_w, e.from_l,
+                    e.container + 1, e.to_h, e.to_w, e.to_l, s, d, t);
+        } else {
+            append("EXP MOVE FROM LS TO %d (%d, %d, %d) (%lf + %lf -> %lf)\n", e.container + 1,
+                    e.to_h, e.to_w, e.to_l, s, d, t);
+        }
+    }
+    spill();
+}
+
+void CsvScheduleSink::emit(const ScheduleEvent& e) {
+    if (!header) {
+        append("event,crane,mode,loaded,container,area,from_h,from_w,from_l,to_h,to_w,to_l,start,duration\n");
+        header = true;
+    }
+    append("%s,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%lf,%lf\n", event_names[e.type], crane_name(e.crane),
+            mode_name(e.mode), e.loaded, e.container, e.area, e.from_h, e.from_w, e.from_l,
+            e.to_h, e.to_w, e.to_l, e.start, e.duration);
+    spill();
+}
+
+void JsonScheduleSink::emit(const ScheduleEvent& e) {
+    append("%s{\"event\": \"%s\", \"crane\": \"%s\", \"mode\": \"%s\", \"loaded\": %s, \"container\": %d, \"area\": %d, "
+            "\"from\": [%d, %d, %d], \"to\": [%d, %d, %d], \"start\": %lf, \"duration\": %lf}",
+            count ? ",\n  " : "[\n  ", event_names[e.type], crane_name(e.crane), mode_name(e.mode),
+            e.loaded ? "true" : "false", e.container, e.area, e.from_h, e.from_w, e.from_l,
+            e.to_h, e.to_w, e.to_l, e.start, e.duration);
+    count++;
+    spill();
+}
+
+JsonScheduleSink::~JsonScheduleSink() {
+    append(count ? "\n]\n" : "[]\n");
+}
+
+void BinaryScheduleSink::emit(const ScheduleEvent& e) {
+    if (!header) {
+        int32_t version = VERSION;
+        buf.append("PSOE", 4);
+        buf.append((const char*) &version, 4);
+        header = true;
+    }
+    char rec[RECORD_SIZE];
+    char* p = rec;
+    *p++ = (char) e.type;
+    *p++ = (char) e.crane;
+    *p++ = (char) e.mode;
+    *p++ = (char) e.loaded;
+    int32_t ints[8] = {e.container, e.area, e.from_h, e.from_w, e.from_l, e.to_h, e.to_w, e.to_l};
+    memcpy(p, ints, sizeof ints);
+    p += sizeof ints;
+    memcpy(p, &e.start, sizeof(double));
+    p += sizeof(double);
+    memcpy(p, &e.duration, sizeof(double));
+    buf.append(rec, RECORD_SIZE);
+    spill();
+}
+
+void BinaryScheduleSink::read(const char* file, std::vector<ScheduleEvent>& events) {
+    FILE* ptr = fopen(file, "rb");
+    if (!ptr) {
+        throw std::runtime_error(std::string(file) + ": cannot open: " + strerror(errno));
+    }
+    char head[8];
+    int32_t version = 0;
+    size_t got = fread(head, 1, 8, ptr);
+    memcpy(&version, head + 4, 4);
+    if (got != 8 || memcmp(head, "PSOE", 4) != 0 || version != VERSION) {
+        fclose(ptr);
+        throw std::runtime_error(std::string(file) + ": not a schedule event stream");
+    }
+    char rec[RECORD_SIZE];
+    while ((got = fread(rec, 1, RECORD_SIZE, ptr)) == (size_t) RECORD_SIZE) {
+        ScheduleEvent e;
+        int32_t ints[8];
+        e.type = rec[0];
+        e.crane = rec[1];
+        e.mode = rec[2];
+        e.loaded = rec[3] != 0;
+        memcpy(ints, rec + 4, sizeof ints);
+        e.container = ints[0];
+        e.area = ints[1];
+        e.from_h = ints[2];
+        e.from_w = ints[3];
+        e.from_l = ints[4];
+        e.to_h = ints[5];
+        e.to_w = ints[6];
+        e.to_l = ints[7];
+        memcpy(&e.start, rec + 4 + sizeof ints, sizeof(double));
+        memcpy(&e.duration, rec + 4 + sizeof ints + sizeof(double), sizeof(double));
+        events.push_back(e);
+    }
+    fclose(ptr);
+    if (got != 0) {
+        throw std::runtime_error(std::string(file) + ": truncated schedule event stream");
+    }
+}
+
+ScheduleSink* make_schedule_sink(const std::string& format, FILE* out) {
+    if (format == "text") return new TextScheduleSink(out);
+    if (format == "csv") return new CsvScheduleSink(out);
+    if (format == "json") return new JsonScheduleSink(out);
+    if (format == "bin") return new BinaryScheduleSink(out);
+    return NULL;
+}
+
+std::string schedule_format(const std::string& file) {
+    size_t dot = file.rfind('.');
+    std::string ext = dot == std::string::npos ? "" : file.substr(dot + 1);
+    if (ext == "csv" || ext == "json" || ext == "bin") return ext;
+    return "text";
+}
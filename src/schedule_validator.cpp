@@ -0,0 +1,222 @@
+#include "schedule_validator.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+static const double EPS = 1e-9;
+
+/**
+ * @brief Represents a stretch of time over which a crane moves at most once, linearly.
+ */
+struct CranePiece {
+    double start; /**< The start time. */
+    double end;   /**< The end time. */
+    int from;     /**< The bay at the start. */
+    int to;       /**< The bay at the end. */
+    int event;    /**< The event of the piece, or the one a wait follows. */
+
+    /**
+     * @brief Gets the time the crane takes per bay.
+     * @return The time, 0 for a piece without travel.
+     */
+    double step() const {
+        return from == to ? 0 : (end - start) / abs(to - from);
+    }
+
+    /**
+     * @brief Gets the direction of travel.
+     * @return 1 up, -1 down, 0 for none.
+     */
+    int dir() const {
+        return (to > from) - (to < from);
+    }
+
+    /**
+     * @brief Gets the bay of the crane, one bay per `step()` as in `SlopeTimeGraph`.
+     * @param t The time.
+     * @return The bay.
+     */
+    int at(double t) const {
+        if (t >= end) return to;
+        if (from == to || t <= start) return from;
+        int k = (int) floor((t - start) / step() + EPS);
+        return from + dir() * std::min(k, abs(to - from));
+    }
+
+    /**
+     * @brief Gets the next time the bay changes.
+     * @param t The time.
+     * @return The first time after `t` at which the crane reaches another bay, infinite if none.
+     */
+    double next(double t) const {
+        if (from == to || t >= end) return std::numeric_limits<double>::infinity();
+        if (t < start) return start;
+        double k = floor((t - start) / step() + EPS) + 1;
+        return std::min(end, start + k * step());
+    }
+};
+
+static ScheduleViolation violation(int type, int crane, int event, int other, double time, int bay, int other_bay) {
+    ScheduleViolation v;
+    v.type = type;
+    v.crane = crane;
+    v.event = event;
+    v.other = other;
+    v.time = time;
+    v.bay = bay;
+    v.other_bay = other_bay;
+    return v;
+}
+
+/**
+ * @brief Checks the events of one crane and cuts its timeline into pieces.
+ *
+ * Idle gaps become pieces without travel, and overlapping events are clipped to start
+ * when the previous one ends, so the pieces tile the time from `t0` to `t1`.
+ */
+static void crane_pieces(const std::vector<ScheduleEvent>& events, int crane, std::vector<int> index,
+        double t0, double t1, std::vector<CranePiece>& pieces, std::vector<ScheduleViolation>& out) {
+    for (size_t k = 1; k < index.size(); k++) {
+        const ScheduleEvent& e = events[index[k]];
+        const ScheduleEvent& p = events[index[k - 1]];
+        if (e.start < p.start - EPS) {
+            out.push_back(violation(VIOLATION_ORDER, crane, index[k], index[k - 1], e.start, e.from_w, p.from_w));
+        }
+    }
+    std::stable_sort(index.begin(), index.end(), [&](int a, int b) {
+        return events[a].start < events[b].start;
+    });
+    pieces.clear();
+    const ScheduleEvent& first = events[index[0]];
+    pieces.push_back({t0, first.start, first.from_w, first.from_w, index[0]});
+    for (size_t k = 0; k < index.size(); k++) {
+        const ScheduleEvent& e = events[index[k]];
+        if (e.duration < 0 || (e.duration <= 0 && e.from_w != e.to_w)) {
+            out.push_back(violation(VIOLATION_DURATION, crane, index[k], -1, e.start, e.from_w, e.to_w));
+        }
+        const CranePiece& last = pieces.back();
+        if (k > 0 && e.start < last.end - EPS) {
+            out.push_back(violation(VIOLATION_OVERLAP, crane, index[k], last.event, e.start, e.from_w, last.to));
+        }
+        if (k > 0 && e.from_w != last.to) {
+            out.push_back(violation(VIOLATION_JUMP, crane, index[k], last.event, e.start, e.from_w, last.to));
+        }
+        if (e.start > last.end + EPS) pieces.push_back({last.end, e.start, last.to, last.to, last.event});
+        double start = std::max(e.start, pieces.back().end);
+        pieces.push_back({start, std::max(start, e.start + e.duration), e.from_w, e.to_w, index[k]});
+    }
+    const CranePiece& last = pieces.back();
+    pieces.push_back({last.end, t1, last.to, last.to, last.event});
+}
+
+/**
+ * @brief Finds the first time two pieces cross.
+ *
+ * `ls - ss` only changes where one of them reaches a bay. It cannot fall when the upper
+ * crane does not move down and the lower one does not move up, so `a` decides; it cannot
+ * rise in the opposite case, so the end decides whether to look for the first crossing.
+ * Cranes moving the same way at the same speed keep a gap that repeats every `step()`;
+ * at different speeds it is not monotone, so every bay change of the overlap is visited.
+ *
+ * @param s The piece of the lower crane.
+ * @param l The piece of the upper crane.
+ * @param a The start of their overlap.
+ * @param b The end of their overlap.
+ * @param closed Whether `b` itself belongs to the overlap.
+ * @param at Receives the first time the lower crane is not below the upper one.
+ * @return `true` if they cross.
+ */
+static bool first_crossing(const CranePiece& s, const CranePiece& l, double a, double b, bool closed, double& at) {
+    //! Just before `b` both cranes are where they were at their last change before it
+    double last = closed ? b : b - 1e-6;
+    if (last < a) return false;
+    int ds = s.dir(), dl = l.dir();
+    double limit = last;
+    if (dl >= 0 && ds <= 0) {
+        limit = a;
+    } else if (dl <= 0 && ds >= 0) {
+        if (s.at(last) < l.at(last)) return false;
+    } else if (fabs(s.step() - l.step()) < EPS) {
+        limit = std::min(last, a + s.step());
+    }
+    for (double t = a; t <= limit + EPS; t = std::min(s.next(t), l.next(t))) {
+        if (s.at(t) >= l.at(t)) {
+            at = t;
+            return true;
+        }
+    }
+    if (closed && limit < b && s.at(b) >= l.at(b)) {
+        at = b;
+        return true;
+    }
+    return false;
+}
+
+std::vector<ScheduleViolation> validate_schedule(const std::vector<ScheduleEvent>& events) {
+    std::vector<ScheduleViolation> out;
+    if (events.empty()) return out;
+    std::map<int, std::vector<int> > cranes;
+    double t0 = events[0].start, t1 = t0;
+    for (size_t i = 0; i < events.size(); i++) {
+        cranes[events[i].crane].push_back(i);
+        t0 = std::min(t0, events[i].start);
+        t1 = std::max(t1, events[i].start + std::max(0.0, events[i].duration));
+    }
+
+    std::vector<CranePiece> lower, upper;
+    int lower_crane = -1;
+    for (auto& it : cranes) {
+        crane_pieces(events, it.first, it.second, t0, t1, upper, out);
+        if (lower_crane >= 0) {
+            //! The pieces of both cranes tile [t0, t1], so one merge visits every overlap;
+            //! each overlap is half open but for the very end
+            size_t i = 0, j = 0;
+            while (i < lower.size() && j < upper.size()) {
+                const CranePiece& s = lower[i];
+                const CranePiece& l = upper[j];
+                double a = std::max(s.start, l.start), b = std::min(s.end, l.end), at;
+                bool closed = i + 1 == lower.size() && j + 1 == upper.size();
+                //! A wait belongs to the event before it, so its pair may already be reported
+                bool reported = !out.empty() && out.back().type == VIOLATION_CROSSING && out.back().crane == lower_crane
+                        && out.back().event == s.event && out.back().other == l.event;
+                if (!reported && a <= b && first_crossing(s, l, a, b, closed, at)) {
+                    out.push_back(violation(VIOLATION_CROSSING, lower_crane, s.event, l.event, at, s.at(at), l.at(at)));
+                }
+                if (s.end < l.end) i++;
+                else if (l.end < s.end) j++;
+                else {
+                    i++;
+                    j++;
+                }
+            }
+        }
+        lower.swap(upper);
+        lower_crane = it.first;
+    }
+    return out;
+}
+
+std::string describe_violation(const ScheduleViolation& v) {
+    static const char* names[] = {"crossing", "order", "overlap", "jump", "duration"};
+    char line[256];
+    switch (v.type) {
+    case VIOLATION_CROSSING:
+        snprintf(line, sizeof line, "%s at %.1f: crane %d at bay %d, next crane at bay %d (events %d and %d)",
+                names[v.type], v.time, v.crane, v.bay, v.other_bay, v.event, v.other);
+        break;
+    case VIOLATION_DURATION:
+        snprintf(line, sizeof line, "%s at %.1f: crane %d from bay %d to bay %d (event %d)",
+                names[v.type], v.time, v.crane, v.bay, v.other_bay, v.event);
+        break;
+    default:
+        snprintf(line, sizeof line, "%s at %.1f: crane %d at bay %d, after bay %d (events %d after %d)",
+                v.type >= 0 && v.type < 5 ? names[v.type] : "unknown", v.time, v.crane, v.bay, v.other_bay,
+                v.event, v.other);
+        break;
+    }
+    return line;
+}
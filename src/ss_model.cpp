@@ -3,6 +3,7 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <limits.h>
 
 #include <string>
 #include <stack>
@@ -11,14 +12,23 @@
 #include <algorithm>
 
 #include "function.h"
+#include "instance_reader.h"
 #include "ss_model.h"
+#include "instrument.h"
 
 SS_Model::SS_Model() {
 
 }
 
 SS_Model::SS_Model(const char*& input) {
-    load_data(input);
+    try {
+        load_data(input);
+    } catch (...) {
+        //! The destructor does not run when a constructor throws
+        for (auto& it : cc_containers) delete it.second;
+        for (auto& it : areas) delete it.second;
+        throw;
+    }
     analyze();
     calculate_malloc_size();
 }
@@ -39,48 +49,48 @@ SS_Model::~SS_Model() {
 }
 
 void SS_Model::load_data(const char* file) {
-    FILE *ptr = NULL;
-    ptr = fopen(file, "r");
-    if (ptr) {
-        int n;
-        int x, y, z;
-        //! Read H W L
-        fscanf(ptr, "%d %d %d", &H, &W, &L);
-        table.resize(W);
-        for (int i = 0; i < W; i++) {
-            table[i].resize(L);
-        }
-        //! Read Containers
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d %d %d", &x, &y, &z);
-            dat* _a = new dat(x, y, z);
-            cc_containers.insert(std::make_pair(i, _a));
-        }
-        //! Read Areas
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d %d %d", &x, &y, &z);
-            dat* _a = new dat(x, y, z);
-            areas.insert(std::make_pair(i, _a));
-        }
-        int t;
-        //! Read Res
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d", &t);
-            res.insert(t);
-        }
-        //! Number of IMP SS
-        fscanf(ptr, "%d", &imp_ss);
-        //! Number of EXP SS
-        fscanf(ptr, "%d", &n);
-        for (int i = 0; i < n; i++) {
-            fscanf(ptr, "%d", &t);
-            exp_ss.insert(t);
-        }
+    InstanceReader in(file);
+    int n;
+    int x, y, z;
+    //! Read H W L
+    H = in.next_int("H", 1, INT_MAX);
+    W = in.next_int("W", 1, INT_MAX);
+    L = in.next_int("L", 1, INT_MAX);
+    table.resize(W);
+    for (int i = 0; i < W; i++) {
+        table[i].resize(L);
+    }
+    //! Read Containers
+    n = in.next_int("container count", 0, INT_MAX);
+    for (int i = 0; i < n; i++) {
+        x = in.next_int("container h", 0, H - 1);
+        y = in.next_int("container w", 0, W - 1);
+        z = in.next_int("container l", 0, L - 1);
+        dat* _a = new dat(x, y, z);
+        cc_containers.insert(std::make_pair(i, _a));
+    }
+    int containers = n;
+    //! Read Areas
+    n = in.next_int("area count", 0, INT_MAX);
+    for (int i = 0; i < n; i++) {
+        x = in.next_int("area h", 0, H - 1);
+        y = in.next_int("area w", 0, W - 1);
+        z = in.next_int("area l", 0, L - 1);
+        dat* _a = new dat(x, y, z);
+        areas.insert(std::make_pair(i, _a));
+    }
+    //! Read Res
+    n = in.next_int("res count", 0, containers);
+    for (int i = 0; i < n; i++) {
+        res.insert(in.next_int("res container", 0, containers - 1));
+    }
+    //! Number of IMP SS
+    imp_ss = in.next_int("imp ss count", 0, INT_MAX);
+    //! Number of EXP SS
+    n = in.next_int("exp ss count", 0, containers);
+    for (int i = 0; i < n; i++) {
+        exp_ss.insert(in.next_int("exp ss container", 0, containers - 1));
     }
-    fclose(ptr);
 }
 
 void SS_Model::analyze() {
@@ -133,6 +143,7 @@ int SS_Model::calculate_malloc_size() {
 }
 
 SS_Model* SS_Model::clone() {
+    PSO_COUNT(COUNT_CLONE);
     SS_Model *m = new SS_Model();
 
     m->W = this->W;
@@ -169,6 +180,7 @@ SS_Model* SS_Model::clone() {
 }
 
 int SS_Model::pop_area_pool(int idx) {
+    PSO_COUNT(COUNT_AREA_POP);
     int a = area_pool[idx];
     if (areas[a]->_h + 1 < H) {
         int n = areas.size();
@@ -182,6 +194,7 @@ int SS_Model::pop_area_pool(int idx) {
 }
 
 int SS_Model::pop_res_pool(int idx) {
+    PSO_COUNT(COUNT_RES_POP);
     int r = res_pool[idx];
     int nt = table[cc_containers[r]->_w][cc_containers[r]->_l][cc_containers[r]->_h - 1];
     if (cc_containers[r]->_h - 1 >= 0 && res.find(nt) != res.end()) {
@@ -195,6 +208,7 @@ int SS_Model::pop_res_pool(int idx) {
 }
 
 int SS_Model::pop_pool(std::vector<int>& pool, int idx) {
+    PSO_COUNT(COUNT_POOL_POP);
     int r = pool[idx];
     pool[idx] = pool[pool.size() - 1];
     pool.pop_back();
@@ -217,6 +231,7 @@ void SS_Model::find_res() {
 }
 
 double SS_Model::fx_function_solve(int x_size, char* x, bool display) {
+    PSO_COUNT(COUNT_SS_SOLVE);
     double y = 0;
     int start = 0;
     int all = W*L;
@@ -0,0 +1,162 @@
+#include "trace_recorder.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <chrono>
+#include <stdexcept>
+
+static const size_t SPILL_SIZE = 1 << 16;
+
+TraceRecorder::TraceRecorder(const std::string& file, size_t capacity) : head(0), tail(0), lost(0), stopping(false) {
+    out = fopen(file.c_str(), "wb");
+    if (!out) {
+        throw std::runtime_error(file + ": cannot open: " + strerror(errno));
+    }
+    binary = file.size() > 4 && file.compare(file.size() - 4, 4, ".bin") == 0;
+    size_t n = 2;
+    while (n < capacity) n <<= 1;
+    mask = n - 1;
+    cells = new Cell[n];
+    for (size_t i = 0; i < n; i++) {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    if (binary) {
+        int32_t version = VERSION;
+        buf.append("PSOT", 4);
+        buf.append((const char*) &version, 4);
+    } else {
+        buf += "run,restart,island,iteration,gbest,mean_pbest,dispersion,vel_index,min_obj,avg_obj,max_obj,"
+                "evaluations,seconds,diversity,unique\n";
+    }
+    writer = std::thread(&TraceRecorder::drain, this);
+}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+    delete[] cells;
+}
+
+bool TraceRecorder::record(const TraceRecord& r) {
+    size_t pos = head.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        long long diff = (long long) seq - (long long) pos;
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            lost.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+    cell->rec = r;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool TraceRecorder::pop(TraceRecord& r) {
+    Cell* cell = &cells[tail & mask];
+    if (cell->seq.load(std::memory_order_acquire) != tail + 1) return false;
+    r = cell->rec;
+    cell->seq.store(tail + mask + 1, std::memory_order_release);
+    tail++;
+    return true;
+}
+
+void TraceRecorder::format(const TraceRecord& r) {
+    if (binary) {
+        char rec[RECORD_SIZE];
+        memset(rec, 0, sizeof rec);
+        int32_t ids[4] = {r.run, r.restart, r.island, r.iteration};
+        double vals[7] = {r.gbest, r.mean_pbest, r.dispersion, r.vel_index, r.min_obj, r.avg_obj, r.max_obj};
+        memcpy(rec, ids, sizeof ids);
+        memcpy(rec + 16, vals, sizeof vals);
+        memcpy(rec + 72, &r.evaluations, 8);
+        memcpy(rec + 80, &r.seconds, 8);
+        memcpy(rec + 88, &r.diversity, 8);
+        memcpy(rec + 96, &r.unique, 4);
+        buf.append(rec, RECORD_SIZE);
+    } else {
+        char line[512];
+        int n = snprintf(line, sizeof line, "%d,%d,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%lld,%.6f,%.6f,%d\n",
+                r.run, r.restart, r.island, r.iteration, r.gbest, r.mean_pbest, r.dispersion, r.vel_index,
+                r.min_obj, r.avg_obj, r.max_obj, (long long) r.evaluations, r.seconds, r.diversity, r.unique);
+        buf.append(line, n);
+    }
+}
+
+void TraceRecorder::drain() {
+    TraceRecord r;
+    for (;;) {
+        bool last = stopping.load(std::memory_order_acquire);
+        bool any = false;
+        while (pop(r)) {
+            format(r);
+            any = true;
+            if (buf.size() >= SPILL_SIZE) {
+                fwrite(buf.data(), 1, buf.size(), out);
+                buf.clear();
+            }
+        }
+        //! Stop only after a pass that started with the flag set found the ring empty
+        if (last) break;
+        if (!any) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    fwrite(buf.data(), 1, buf.size(), out);
+    buf.clear();
+}
+
+void TraceRecorder::close() {
+    if (!out) return;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    fclose(out);
+    out = NULL;
+}
+
+void TraceRecorder::read(const char* file, std::vector<TraceRecord>& records) {
+    FILE* ptr = fopen(file, "rb");
+    if (!ptr) {
+        throw std::runtime_error(std::string(file) + ": cannot open: " + strerror(errno));
+    }
+    char head[8];
+    int32_t version = 0;
+    size_t got = fread(head, 1, 8, ptr);
+    memcpy(&version, head + 4, 4);
+    if (got != 8 || memcmp(head, "PSOT", 4) != 0 || version != VERSION) {
+        fclose(ptr);
+        throw std::runtime_error(std::string(file) + ": not a trace");
+    }
+    char rec[RECORD_SIZE];
+    while ((got = fread(rec, 1, RECORD_SIZE, ptr)) == (size_t) RECORD_SIZE) {
+        TraceRecord r;
+        int32_t ids[4];
+        double vals[7];
+        memcpy(ids, rec, sizeof ids);
+        memcpy(vals, rec + 16, sizeof vals);
+        r.run = ids[0];
+        r.restart = ids[1];
+        r.island = ids[2];
+        r.iteration = ids[3];
+        r.gbest = vals[0];
+        r.mean_pbest = vals[1];
+        r.dispersion = vals[2];
+        r.vel_index = vals[3];
+        r.min_obj = vals[4];
+        r.avg_obj = vals[5];
+        r.max_obj = vals[6];
+        memcpy(&r.evaluations, rec + 72, 8);
+        memcpy(&r.seconds, rec + 80, 8);
+        memcpy(&r.diversity, rec + 88, 8);
+        memcpy(&r.unique, rec + 96, 4);
+        records.push_back(r);
+    }
+    fclose(ptr);
+    if (got != 0) {
+        throw std::runtime_error(std::string(file) + ": truncated trace");
+    }
+}
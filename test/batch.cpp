@@ -0,0 +1,247 @@
+#include "function.h"
+#include "binary_pso.h"
+#include "instance_set.h"
+#include "optimizers.h"
+#include "pareto_archive.h"
+#include "thread_pool.h"
+#include "trace_recorder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Solves many instances in one process, with (instance, restart) jobs shared by one thread pool.
+//! Usage: batch [-j threads] [-r restarts] [-k cranes] [-m auto|matrix|all|ss] [-a pso|sa|tabu] [-s seed]
+//!              [-o results.csv|results.json] [-t trace.csv|trace.bin] [-p front.csv] <file | 'glob' | @list>...
+//! PSO parameters come from config.txt like the other drivers; -a overrides its METHOD.
+//! Without -s the seed is random, and it is printed at the end so the run can be repeated.
+//! -p merges the Pareto fronts of the restarts of each instance, up to PARETO points (32 when
+//! unset), and writes one line per point: makespan, waiting time, travel time and the bits.
+//! Objectives an instance kind does not have are left empty; only PSO runs keep a front.
+
+/**
+ * @brief Represents one instance of the batch and the runs made on it.
+ */
+struct Instance : public LoadedInstance {
+    std::vector<BinaryPSOResult> runs; /**< The result of each restart. */
+};
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-j threads] [-r restarts] [-k cranes] [-m auto|matrix|all|ss] [-a pso|sa|tabu] [-s seed]\n"
+            "       [-o results.csv|results.json] [-t trace.csv|trace.bin] [-p front.csv] <file | 'glob' | @list>...\n", prog);
+}
+
+int main(int argc, const char** argv) {
+    int threads = 0, cranes = 2, restarts = -1;
+    unsigned seed = 0;
+    std::string mode = "auto", method, output, trace_file, front_file;
+    std::vector<std::string> files;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string a = argv[i];
+            bool has_value = i + 1 < argc;
+            if (a == "-j" && has_value) threads = atoi(argv[++i]);
+            else if (a == "-r" && has_value) restarts = atoi(argv[++i]);
+            else if (a == "-k" && has_value) cranes = atoi(argv[++i]);
+            else if (a == "-m" && has_value) mode = argv[++i];
+            else if (a == "-a" && has_value) method = argv[++i];
+            else if (a == "-s" && has_value) {
+                //! 0 stands for a random seed, so it cannot be asked for
+                char* end;
+                seed = strtoul(argv[++i], &end, 10);
+                if (seed == 0 || *end) {
+                    fprintf(stderr, "-s: the seed must be a positive integer, got %s\n", argv[i]);
+                    return 1;
+                }
+            }
+            else if (a == "-o" && has_value) output = argv[++i];
+            else if (a == "-t" && has_value) trace_file = argv[++i];
+            else if (a == "-p" && has_value) front_file = argv[++i];
+            else if (a[0] == '-') {
+                usage(argv[0]);
+                return 1;
+            } else expand_instance_arg(a, files);
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    if (files.empty() || (mode != "auto" && mode != "matrix" && mode != "all" && mode != "ss")) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, double> configs;
+    read_configs(configs);
+    BinaryPSOParams params(configs);
+    if (restarts > 0) params.restarts = restarts;
+    if (!method.empty()) params.method = parse_method(method);
+    if (params.method < 0 || params.method >= METHODS) {
+        fprintf(stderr, "unknown method %s\n", method.empty() ? "in config.txt" : method.c_str());
+        return 1;
+    }
+    if (params.popsize <= 0 || params.iterations < 0 || params.restarts <= 0) {
+        fprintf(stderr, "config.txt: POPSIZE, ITERATION and RESTARTS must be positive\n");
+        return 1;
+    }
+    if (seed == 0) seed = std::random_device()();
+    if (!front_file.empty() && params.pareto <= 0) params.pareto = 32;
+
+    //! One record per iteration of every restart, run numbers follow the instance order
+    TraceRecorder* trace = NULL;
+    if (!trace_file.empty()) {
+        try {
+            trace = new TraceRecorder(trace_file);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    ThreadPool pool(threads);
+
+    //! Instances are loaded on the pool too, the model constructors touch no shared state
+    std::vector<Instance> instances(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        Instance* in = &instances[i];
+        in->file = files[i];
+        in->kind = mode == "auto" ? detect_instance_kind(files[i]) : mode;
+        in->runs.resize(params.restarts);
+        pool.submit([in, cranes] {
+            in->load(cranes);
+        });
+    }
+    pool.wait();
+
+    //! Largest genomes first, so the long jobs do not end up alone at the tail
+    std::vector<Instance*> order;
+    for (auto& in : instances) {
+        if (in.error.empty()) order.push_back(&in);
+    }
+    std::stable_sort(order.begin(), order.end(), [](Instance* a, Instance* b) {
+        return a->objective->Size() > b->objective->Size();
+    });
+    for (auto in : order) {
+        for (int r = 0; r < params.restarts; r++) {
+            unsigned run_seed = seed + (unsigned) ((in - &instances[0]) * params.restarts + r) * 2654435761u;
+            int run = in - &instances[0];
+            pool.submit([in, r, run, run_seed, trace, &params] {
+                Optimizer* opt = make_optimizer(params, run_seed);
+                opt->Trace(trace, run, r);
+                in->runs[r] = opt->Run(*in->objective);
+                delete opt;
+            });
+        }
+    }
+    pool.wait();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (trace) {
+        trace->close();
+        if (trace->dropped()) fprintf(stderr, "%s: %lld trace records dropped\n", trace_file.c_str(), trace->dropped());
+        delete trace;
+    }
+
+    FILE* out = stdout;
+    bool json = output.size() >= 5 && output.compare(output.size() - 5, 5, ".json") == 0;
+    if (!output.empty()) {
+        out = fopen(output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "%s: cannot open for writing\n", output.c_str());
+            return 1;
+        }
+    }
+    if (json) {
+        fprintf(out, "{\n  \"seed\": %u,\n  \"threads\": %d,\n  \"restarts\": %d,\n  \"wall_seconds\": %.3f,\n  \"instances\": [",
+                seed, pool.size(), params.restarts, wall);
+    } else {
+        fprintf(out, "file,kind,bits,restarts,best,mean,worst,mean_pbest,evaluations,screened,relaxed,relaxed_gap,duplicates,key_seconds,diversity,cpu_seconds,error\n");
+    }
+    long long total_evaluations = 0;
+    int failed = 0;
+    for (size_t i = 0; i < instances.size(); i++) {
+        Instance& in = instances[i];
+        double best = 0, mean = 0, worst = 0, mean_pbest = 0, seconds = 0;
+        long long evaluations = 0, screened = 0, relaxed = 0, duplicates = 0;
+        double relaxed_gap = 0, diversity = 0, key_seconds = 0;
+        if (in.error.empty()) {
+            best = std::numeric_limits<double>::max();
+            worst = -best;
+            for (auto& r : in.runs) {
+                best = std::min(best, r.best);
+                worst = std::max(worst, r.best);
+                mean_pbest += r.mean_pbest / in.runs.size();
+                mean += r.best;
+                evaluations += r.evaluations;
+                screened += r.screened;
+                relaxed += r.relaxed;
+                relaxed_gap += r.relaxed_gap / in.runs.size();
+                duplicates += r.duplicates;
+                key_seconds += r.key_seconds;
+                diversity += r.diversity / in.runs.size();
+                seconds += r.seconds;
+            }
+            mean /= in.runs.size();
+            total_evaluations += evaluations;
+            if (out != stdout) printf("%s : %lf\n", in.file.c_str(), best);
+        } else {
+            fprintf(stderr, "%s\n", in.error.c_str());
+            failed++;
+        }
+        int bits = in.objective ? in.objective->Size() : 0;
+        if (json) {
+            fprintf(out, "%s\n    {\"file\": %s, \"kind\": \"%s\", \"bits\": %d, \"restarts\": %d, \"best\": %lf, \"mean\": %lf, "
+                    "\"worst\": %lf, \"mean_pbest\": %lf, \"evaluations\": %lld, \"screened\": %lld, \"relaxed\": %lld, "
+                    "\"relaxed_gap\": %lf, \"duplicates\": %lld, \"key_seconds\": %.3f, \"diversity\": %lf, \"cpu_seconds\": %.3f, \"error\": %s}",
+                    i ? "," : "", json_quote(in.file).c_str(), in.kind.c_str(), bits, (int) in.runs.size(), best, mean,
+                    worst, mean_pbest, evaluations, screened, relaxed, relaxed_gap, duplicates, key_seconds, diversity, seconds,
+                    json_quote(in.error).c_str());
+        } else {
+            std::string error = in.error;
+            std::replace(error.begin(), error.end(), ',', ';');
+            fprintf(out, "%s,%s,%d,%d,%lf,%lf,%lf,%lf,%lld,%lld,%lld,%lf,%lld,%.3f,%lf,%.3f,%s\n", in.file.c_str(),
+                    in.kind.c_str(), bits, (int) in.runs.size(), best, mean, worst, mean_pbest, evaluations, screened, relaxed,
+                    relaxed_gap, duplicates, key_seconds, diversity, seconds, error.c_str());
+        }
+    }
+    if (json) {
+        fprintf(out, "\n  ]\n}\n");
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    if (!front_file.empty()) {
+        FILE* fp = fopen(front_file.c_str(), "w");
+        if (!fp) {
+            fprintf(stderr, "%s: cannot open for writing\n", front_file.c_str());
+            return 1;
+        }
+        fprintf(fp, "file,makespan,wait,travel,bits\n");
+        for (auto& in : instances) {
+            if (!in.error.empty()) continue;
+            ParetoArchive front(in.objective->Objectives(), params.pareto);
+            for (auto& r : in.runs) front.merge(r.front);
+            for (const ParetoPoint& p : front.front()) {
+                fprintf(fp, "%s", in.file.c_str());
+                for (int k = 0; k < 3; k++) {
+                    if (k < (int) p.f.size()) fprintf(fp, ",%lf", p.f[k]);
+                    else fprintf(fp, ",");
+                }
+                std::string bits;
+                for (char c : p.x) bits += c ? '1' : '0';
+                fprintf(fp, ",%s\n", bits.c_str());
+            }
+        }
+        fclose(fp);
+    }
+    fprintf(stderr, "%zu instances, %d threads, %.3f s, %.0f evaluations/s (seed %u)\n", instances.size(),
+            pool.size(), wall, total_evaluations / std::max(wall, 1e-9), seed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+#include "all_model.h"
+#include "bench.h"
+#include "binary_pso.h"
+#include "function.h"
+#include "linear_graph.h"
+#include "perf_counters.h"
+#include "schedule_sink.h"
+#include "swarm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Microbenchmarks of the evaluator hot paths on one All_Model instance.
+//! Usage: bench [-w warmup] [-r repetitions] [-t target_ms] [-f filter] [-P] [-o results.json] [instance]
+//! Built with optimization by `make bench`, which runs it on the small example instance.
+//! Hardware counters are reported per benchmark where perf_event_open is permitted; -P skips them.
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-w warmup] [-r repetitions] [-t target_ms] [-f filter] [-P] [-o results.json] [instance]\n", prog);
+}
+
+int main(int argc, const char** argv) {
+    std::string instance = "data/example_data_all_small_01.txt", filter, output;
+    Bench bench;
+    bool counters = true;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "-w" && has_value) bench.warmup = atoi(argv[++i]);
+        else if (a == "-r" && has_value) bench.repetitions = atoi(argv[++i]);
+        else if (a == "-t" && has_value) bench.target_ms = atof(argv[++i]);
+        else if (a == "-f" && has_value) filter = argv[++i];
+        else if (a == "-o" && has_value) output = argv[++i];
+        else if (a == "-P") counters = false;
+        else if (a[0] != '-') instance = a;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (bench.repetitions <= 0 || bench.warmup < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    PerfCounters perf;
+    if (counters) {
+        if (perf.available()) bench.perf = &perf;
+        else fprintf(stderr, "hardware counters unavailable, timing only: %s\n", perf.error().c_str());
+    }
+
+    All_Model* master;
+    try {
+        const char* file = instance.c_str();
+        master = new All_Model(file);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    const int size = master->get_joint_bit_size();
+    const int ss_size = master->get_ss_bit_size();
+    NullScheduleSink null_sink;
+
+    //! Fixed inputs, so every run of the benchmark does the same work
+    const int K = 64;
+    std::mt19937 rng(12345);
+    std::vector<std::vector<char> > genomes(K, std::vector<char>(size));
+    for (auto& g : genomes) {
+        for (auto& b : g) b = rng() % 2;
+    }
+    std::vector<All_Model*> models;
+    auto free_models = [&models]() {
+        for (All_Model* m : models) delete m;
+        models.clear();
+    };
+    auto fresh_models = [&](int n) {
+        free_models();
+        for (int i = 0; i < n; i++) models.push_back(master->clone());
+    };
+
+    //! A model with a recorded short-span schedule, as the long-span crane sees it
+    auto recorded = [&](int g) {
+        All_Model* m = master->clone();
+        m->set_schedule_sink(&null_sink);
+        m->fx_function_solve(ss_size, genomes[g].data(), true);
+        m->set_schedule_sink(NULL);
+        m->ls_analyze();
+        return m;
+    };
+    All_Model* timeline = recorded(0);
+    double makespan;
+    {
+        All_Model* m = master->clone();
+        makespan = m->fx_function_solve(ss_size, genomes[0].data());
+        delete m;
+    }
+    struct Probe { int tt, d, a, b; };
+    std::vector<Probe> probes(K);
+    for (auto& p : probes) {
+        p.tt = rng() % std::max(1, (int) makespan);
+        p.d = 1 + rng() % 40;
+        p.a = (int) (rng() % 12) - 1;
+        p.b = (int) (rng() % 12) - 1;
+    }
+
+    //! Every stack can be filled once per clone
+    int capacity = 0;
+    {
+        All_Model* m = master->clone();
+        while (m->get_area_pool_size() > 0) {
+            m->pop_area_pool(0);
+            capacity++;
+        }
+        delete m;
+    }
+
+    std::vector<SlopeTimeGraph> graphs;
+    std::vector<int> starts, spans;
+    for (int i = 0; i < K; i++) {
+        starts.push_back(rng() % 1000);
+        spans.push_back(1 + rng() % 200);
+        graphs.push_back(SlopeTimeGraph(starts[i], starts[i] + spans[i], (int) (rng() % 12) - 1, (int) (rng() % 12) - 1));
+    }
+    std::vector<char> bits(4096);
+    for (auto& b : bits) b = rng() % 2;
+    const int bsize = decimal_2_binary_size(16 * 16);
+
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 1;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSO pso(BinaryPSOParams(configs), 1);
+    std::vector<char> x(genomes[1]), xpbest(genomes[2]), xbest(genomes[3]);
+    std::vector<double> vel(size), one_vel(size), zero_vel(size);
+    for (int j = 0; j < size; j++) {
+        vel[j] = pso.Uniform() - 0.5;
+        one_vel[j] = pso.Uniform() - 0.5;
+        zero_vel[j] = pso.Uniform() - 0.5;
+    }
+
+    //! A swarm of the continuous PSO with spread-out positions and fitness values
+    Swarm swarm(30, 32);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (int i = 0; i < swarm.Member; i++) {
+        Particle* p = swarm.pParticle[i];
+        for (int j = 0; j < p->Dimension; j++) {
+            p->Position[j] = unit(rng);
+            p->BestP[j] = unit(rng);
+        }
+        p->Objective = unit(rng);
+        p->ObjectiveP = unit(rng);
+    }
+    swarm.posBest = 0;
+
+    std::vector<BenchCase> cases;
+    cases.push_back({"clone", [&](int n) { free_models(); models.resize(n); },
+            [&](int i) { models[i] = master->clone(); }, free_models, 4096});
+    cases.push_back({"fx_function_solve", fresh_models,
+            [&](int i) { bench_keep(models[i]->fx_function_solve(ss_size, genomes[i % K].data())); },
+            free_models, 4096});
+    cases.push_back({"fx_function_solve_2", [&](int n) {
+                free_models();
+                for (int i = 0; i < n; i++) models.push_back(recorded(i % K));
+            },
+            [&](int i) {
+                bench_keep(models[i]->fx_function_solve_2(size - ss_size, genomes[i % K].data() + ss_size));
+            }, free_models, 4096});
+    cases.push_back({"fx_function_solve_joint", fresh_models,
+            [&](int i) { bench_keep(models[i]->fx_function_solve_joint(size, genomes[i % K].data())); },
+            free_models, 4096});
+    cases.push_back({"check_ss", std::function<void(int)>(), [&](int i) {
+                const Probe& p = probes[i % K];
+                int tc = 0;
+                bench_keep(i & 1 ? timeline->check_ss_slope(tc, p.tt, p.d, p.a, p.b)
+                        : timeline->check_ss_stable(tc, p.tt, p.d, p.a));
+            }, std::function<void()>(), 0});
+    cases.push_back({"pop_area_pool", [&](int n) { fresh_models((n + capacity - 1) / capacity); },
+            [&](int i) {
+                All_Model* m = models[i / capacity];
+                bench_keep(m->pop_area_pool(probes[i % K].tt % m->get_area_pool_size()));
+            }, free_models, 0});
+    cases.push_back({"SlopeTimeGraph::get_value", std::function<void(int)>(), [&](int i) {
+                int k = i % K;
+                bench_keep(graphs[k].get_value(starts[k] + i % (spans[k] + 1)));
+            }, std::function<void()>(), 0});
+    cases.push_back({"binary_2_decimal", std::function<void(int)>(),
+            [&](int i) { bench_keep(binary_2_decimal(bsize, bits.data() + (i * 7) % (4096 - bsize))); },
+            std::function<void()>(), 0});
+    cases.push_back({"velocity_update", std::function<void(int)>(), [&](int) {
+                pso.Move(size, x.data(), xpbest.data(), xbest.data(), vel.data(), one_vel.data(),
+                        zero_vel.data(), 1.3, 0.7);
+            }, std::function<void()>(), 0});
+    cases.push_back({"Swarm::UpdateBest", std::function<void(int)>(), [&](int) { swarm.UpdateBest(3); },
+            std::function<void()>(), 0});
+
+    fprintf(stderr, "%s: %d joint bits, %d short-span bits, %d free slots\n", instance.c_str(), size, ss_size, capacity);
+    for (const BenchCase& c : cases) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+        bench.run(c);
+    }
+    bench.print(stdout);
+    if (!output.empty()) {
+        FILE* out = fopen(output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "%s: cannot open\n", output.c_str());
+        } else {
+            bench.write_json(out, instance);
+            fclose(out);
+        }
+    }
+    delete timeline;
+    delete master;
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "all_model.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <stdexcept>
+
+//! Converts All_Model text instances into precomputed binary instances.
+//! Usage: convert <input.txt> [<input.txt> ...]   writes <input>.bin next to each input
+//!        convert -o <output.bin> <input.txt>
+int main(int argc, const char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <input.txt>... | -o <output.bin> <input.txt>\n", argv[0]);
+        return 1;
+    }
+    int first = 1;
+    const char* output = NULL;
+    if (strcmp(argv[1], "-o") == 0) {
+        if (argc != 4) {
+            fprintf(stderr, "usage: %s -o <output.bin> <input.txt>\n", argv[0]);
+            return 1;
+        }
+        output = argv[2];
+        first = 3;
+    }
+    int failed = 0;
+    for (int i = first; i < argc; i++) {
+        const char* file_name = argv[i];
+        std::string out;
+        if (output) {
+            out = output;
+        } else {
+            out = file_name;
+            size_t dot = out.rfind('.');
+            if (dot != std::string::npos && out.find('/', dot) == std::string::npos) {
+                out.erase(dot);
+            }
+            out += ".bin";
+        }
+        try {
+            All_Model model(file_name);
+            model.save_binary(out.c_str());
+            printf("%s -> %s (%d bits)\n", file_name, out.c_str(), model.get_joint_bit_size());
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s\n", e.what());
+            failed++;
+        }
+    }
+    return failed ? 1 : 0;
+}
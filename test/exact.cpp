@@ -0,0 +1,126 @@
+#include "all_model.h"
+#include "beam_search.h"
+#include "branch_and_bound.h"
+#include "binary_pso.h"
+#include "function.h"
+#include "model_objective.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Solves small All_Model instances exactly and compares with the PSO.
+//! Usage: exact [-j threads] [-m joint|ss] [-n nodes] [-T seconds] [-u upper] [-b width] [-r restarts] [-s seed]
+//!              <instance>...
+//! With -r the PSO of config.txt runs that many restarts first; its best makespan is the
+//! starting upper bound and the gap to the optimum is reported. With -b a beam search of
+//! that width builds one schedule instead, which is not proven optimal.
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-j threads] [-m joint|ss] [-n nodes] [-T seconds] [-u upper] [-b width] [-r restarts]\n"
+            "       [-s seed] <instance>...\n", prog);
+}
+
+int main(int argc, const char** argv) {
+    int threads = 1, restarts = 0, width = 0;
+    long long nodes = 0;
+    double seconds = 0, upper = 0;
+    unsigned seed = 1;
+    std::string mode = "joint";
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "-j" && has_value) threads = atoi(argv[++i]);
+        else if (a == "-m" && has_value) mode = argv[++i];
+        else if (a == "-n" && has_value) nodes = atoll(argv[++i]);
+        else if (a == "-T" && has_value) seconds = atof(argv[++i]);
+        else if (a == "-u" && has_value) upper = atof(argv[++i]);
+        else if (a == "-b" && has_value) width = atoi(argv[++i]);
+        else if (a == "-r" && has_value) restarts = atoi(argv[++i]);
+        else if (a == "-s" && has_value) seed = strtoul(argv[++i], NULL, 10);
+        else if (a[0] != '-') files.push_back(a);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (files.empty() || threads < 1 || restarts < 0 || width < 0 || (mode != "joint" && mode != "ss")) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::map<std::string, double> configs;
+    if (restarts > 0) {
+        read_configs(configs);
+        if (configs["POPSIZE"] <= 0 || configs["ITERATION"] <= 0) {
+            fprintf(stderr, "config.txt: POPSIZE and ITERATION must be positive\n");
+            return 1;
+        }
+    }
+
+    bool joint = mode == "joint";
+    printf("file,kind,moves,best,optimal,nodes,pruned,transpositions,seconds,pso_best,gap\n");
+    int failed = 0;
+    for (const std::string& f : files) {
+        All_Model* master;
+        try {
+            const char* file = f.c_str();
+            master = new All_Model(file);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s: %s\n", f.c_str(), e.what());
+            failed++;
+            continue;
+        }
+        double pso = 0;
+        if (restarts > 0) {
+            BinaryPSOParams params(configs);
+            JointObjective joint_objective(master);
+            ShortSpanObjective ss_objective(master);
+            Objective& objective = joint ? (Objective&) joint_objective : (Objective&) ss_objective;
+            pso = std::numeric_limits<double>::infinity();
+            for (int r = 0; r < restarts; r++) {
+                pso = std::min(pso, BinaryPSO(params, seed + r).Run(objective).best);
+            }
+        }
+        BranchAndBoundResult res;
+        if (width > 0) {
+            BeamSearchResult beam;
+            try {
+                beam = BeamSearch(master, width, joint, threads).Run();
+            } catch (const std::exception& e) {
+                fprintf(stderr, "%s: %s\n", f.c_str(), e.what());
+                failed++;
+                delete master;
+                continue;
+            }
+            res.best = beam.best;
+            res.optimal = false;
+            res.nodes = beam.nodes;
+            res.pruned = 0;
+            res.transpositions = beam.merged;
+            res.seconds = beam.seconds;
+        } else {
+            BranchAndBound bb(master, joint, threads);
+            bb.node_limit = nodes;
+            bb.time_limit = seconds;
+            //! A schedule as good as the PSO's is already known, so the search looks for better ones
+            if (upper > 0) bb.upper = upper;
+            if (restarts > 0) bb.upper = std::min(bb.upper, pso + 1e-9);
+            res = bb.Run();
+        }
+        int moves = master->get_ss_steps() + (joint ? master->get_ls_steps() : 0);
+        printf("%s,%s,%d,%f,%d,%lld,%lld,%lld,%.3f,", f.c_str(), mode.c_str(), moves, res.best, res.optimal ? 1 : 0,
+                res.nodes, res.pruned, res.transpositions, res.seconds);
+        if (restarts > 0) printf("%f,%.2f%%\n", pso, res.best > 0 ? 100 * (pso - res.best) / res.best : 0.0);
+        else printf(",\n");
+        fflush(stdout);
+        delete master;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#include "instance_generator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <stdexcept>
+#include <string>
+
+//! Writes a synthetic All_Model instance.
+//! Usage: generate [-W bays] [-H height] [-L rows] [-f fill] [-e exp_ss,exp_ls] [-i imp_ss,imp_ls]
+//!                 [-r res_ss,res_ls] [-s seed] out.txt
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-W bays] [-H height] [-L rows] [-f fill] [-e exp_ss,exp_ls] [-i imp_ss,imp_ls]\n"
+            "       [-r res_ss,res_ls] [-s seed] out.txt\n"
+            "A reserved count of -1 reserves whatever is stacked on the exports.\n", prog);
+}
+
+static bool parse_pair(const char* arg, int& a, int& b) {
+    return sscanf(arg, "%d,%d", &a, &b) == 2;
+}
+
+int main(int argc, const char** argv) {
+    YardSpec spec;
+    std::string output;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        bool ok = true;
+        if (a == "-W" && has_value) spec.W = atoi(argv[++i]);
+        else if (a == "-H" && has_value) spec.H = atoi(argv[++i]);
+        else if (a == "-L" && has_value) spec.L = atoi(argv[++i]);
+        else if (a == "-f" && has_value) spec.fill = atof(argv[++i]);
+        else if (a == "-e" && has_value) ok = parse_pair(argv[++i], spec.exp_ss, spec.exp_ls);
+        else if (a == "-i" && has_value) ok = parse_pair(argv[++i], spec.imp_ss, spec.imp_ls);
+        else if (a == "-r" && has_value) ok = parse_pair(argv[++i], spec.res_ss, spec.res_ls);
+        else if (a == "-s" && has_value) spec.seed = strtoul(argv[++i], NULL, 10);
+        else if (a[0] != '-' && output.empty()) output = a;
+        else ok = false;
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (output.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    try {
+        generate_instance(spec, output.c_str());
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "binary_pso.h"
+#include "function.h"
+#include "rolling_horizon.h"
+#include "schedule_sink.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+//! Schedules a stream of jobs on a yard one window at a time.
+//! Usage: stream [-w window] [-s seed] [-o schedule] <yard> [jobs]
+//! The jobs of the yard instance come first, then the lines of the jobs file (or of stdin
+//! without one, or with "-"): `imp ss`, `imp ls`, `exp ss <container>` or `exp ls <container>`.
+//! A window is planned as soon as it is full and once more at the end for the rest. Every
+//! committed window prints one CSV line; its events go to the schedule file (.csv, .json,
+//! .bin or text) shifted to the time the window starts. The optimizer is the one of config.txt.
+//! A job line that is malformed, names a container the yard cannot export or imports into a
+//! yard with no slot left is reported with its line number on stderr and skipped; the stream
+//! goes on. A window where no queued job fits drops the oldest one, also on stderr.
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-w window] [-s seed] [-o schedule] <yard> [jobs]\n", prog);
+}
+
+static void report(int k, const RollingWindow& w, int& dropped) {
+    if (w.dropped) fprintf(stderr, "window %d: no queued job fits in the yard, the oldest is dropped\n", k);
+    dropped += w.dropped;
+    printf("%d,%d,%d,%lf,%lf,%lld,%.6f\n", k, w.jobs, w.moves, w.start, w.makespan, w.evaluations, w.seconds);
+    fflush(stdout);
+}
+
+int main(int argc, const char** argv) {
+    int window = 8;
+    unsigned seed = 1;
+    std::string output;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "-w" && has_value) window = atoi(argv[++i]);
+        else if (a == "-s" && has_value) seed = strtoul(argv[++i], NULL, 10);
+        else if (a == "-o" && has_value) output = argv[++i];
+        else if (a == "-" || a[0] != '-') files.push_back(a);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (files.empty() || files.size() > 2 || window < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::map<std::string, double> configs;
+    read_configs(configs);
+    if (configs["POPSIZE"] <= 0 || configs["ITERATION"] <= 0) {
+        fprintf(stderr, "config.txt: POPSIZE and ITERATION must be positive\n");
+        return 1;
+    }
+
+    FILE* out = NULL;
+    ScheduleSink* sink = NULL;
+    if (!output.empty()) {
+        out = fopen(output.c_str(), "wb");
+        if (!out) {
+            fprintf(stderr, "%s: cannot open for writing\n", output.c_str());
+            return 1;
+        }
+        sink = make_schedule_sink(schedule_format(output), out);
+    }
+
+    int status = 0, k = 0;
+    try {
+        RollingHorizon horizon(files[0].c_str(), BinaryPSOParams(configs), window, seed);
+        horizon.set_schedule_sink(sink);
+        printf("window,jobs,moves,start,makespan,evaluations,seconds\n");
+        std::ifstream file;
+        std::istream* in = NULL;
+        if (files.size() > 1 && files[1] != "-") {
+            file.open(files[1].c_str());
+            if (!file) throw std::runtime_error(files[1] + ": cannot open");
+            in = &file;
+        } else if (files.size() > 1) {
+            in = &std::cin;
+        }
+        std::string name = files.size() > 1 && files[1] != "-" ? files[1] : "stdin";
+        StreamJob job;
+        int line = 0, skipped = 0, dropped = 0;
+        for (std::string text; in && std::getline(*in, text);) {
+            line++;
+            try {
+                if (parse_stream_job(text, job)) horizon.add(job);
+            } catch (const std::runtime_error& e) {
+                fprintf(stderr, "%s:%d: %s, skipped\n", name.c_str(), line, e.what());
+                skipped++;
+            }
+            while (horizon.ready()) report(++k, horizon.step(), dropped);
+        }
+        while (horizon.pending() > 0) report(++k, horizon.step(), dropped);
+        fprintf(stderr, "%d windows, makespan %lf, %d jobs skipped, %d dropped\n", k, horizon.clock(), skipped, dropped);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        status = 1;
+    }
+    delete sink;
+    if (out) fclose(out);
+    return status;
+}
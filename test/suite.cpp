@@ -0,0 +1,455 @@
+#include "function.h"
+#include "binary_pso.h"
+#include "instance_generator.h"
+#include "instance_set.h"
+#include "model_objective.h"
+#include "optimizers.h"
+#include "schedule_sink.h"
+#include "schedule_validator.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! End-to-end time-to-target suite: the full short-span then long-span optimization of
+//! test_3 on every instance, with fixed seeds and fixed PSO parameters.
+//! Usage: suite [-r seeds] [-s seed] [-c] [-G] [-T targets.txt] [-x gap] [-o results.csv|results.json]
+//!              [file | 'glob' | @list]...
+//! Without instances it runs data/example_data_* and three generated yards. Each instance
+//! runs in its own child process so its peak RSS can be measured. The best schedule of every
+//! split run is replayed and checked with `validate_schedule()`; `violations` counts what it finds.
+
+/**
+ * @brief Represents one seeded run of an instance.
+ */
+struct SuiteRun {
+    double best;          /**< The final makespan. */
+    long long evaluations; /**< The number of evaluations. */
+    double seconds;       /**< The wall time. */
+    int violations;       /**< The violations found in the best schedule. */
+    std::vector<BinaryPSOProgress> history; /**< The makespan after every improvement. */
+};
+
+/**
+ * @brief Represents one instance of the suite and its runs.
+ */
+struct SuiteEntry {
+    std::string name;          /**< The instance file, or the spec of a generated yard. */
+    std::string file;          /**< The path the instance is loaded from. */
+    std::string kind;          /**< split for All_Model instances, ss for short-span ones. */
+    std::string error;         /**< The loading error, empty if loaded. */
+    int bits;                  /**< The genome size. */
+    long peak_rss_kb;          /**< The peak resident set of the child that ran it. */
+    double target;             /**< The target makespan. */
+    std::vector<SuiteRun> runs; /**< The runs, one per seed. */
+};
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-r seeds] [-s seed] [-c] [-G] [-T targets.txt] [-x gap]\n"
+            "       [-o results.csv|results.json] [file | 'glob' | @list]...\n", prog);
+}
+
+//! Records are sent from the child as raw doubles; both ends are the same binary
+static void put(std::string& buf, double v) {
+    buf.append((const char*) &v, sizeof v);
+}
+
+static double get(const std::string& buf, size_t& pos) {
+    double v = 0;
+    if (pos + sizeof v <= buf.size()) memcpy(&v, buf.data() + pos, sizeof v);
+    pos += sizeof v;
+    return v;
+}
+
+/**
+ * @brief Runs every seed of one instance.
+ *
+ * All_Model instances follow `test_3`: a short-span run, its best schedule recorded on a
+ * copy of the master, then a long-span run against it. The makespan history of the
+ * long-span phase is offset by the time and evaluations of the first phase.
+ */
+static void run_instance(SuiteEntry& e, const BinaryPSOParams& params, const std::vector<unsigned>& seeds) {
+    const char* file = e.file.c_str();
+    All_Model* all = NULL;
+    SS_Model* ss = NULL;
+    try {
+        all = new All_Model(file);
+        e.kind = "split";
+        e.bits = all->get_bit_size();
+    } catch (const std::exception& ex) {
+        try {
+            ss = new SS_Model(file);
+            e.kind = "ss";
+            e.bits = ss->get_bit_size();
+        } catch (const std::exception&) {
+            e.error = ex.what();
+            return;
+        }
+    }
+    for (unsigned seed : seeds) {
+        SuiteRun run;
+        run.violations = 0;
+        Optimizer* opt = make_optimizer(params, seed);
+        if (ss) {
+            SSObjective f(ss);
+            BinaryPSOResult r = opt->Run(f);
+            run.best = r.best;
+            run.evaluations = r.evaluations;
+            run.seconds = r.seconds;
+            run.history = r.history;
+        } else {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            ShortSpanObjective f1(all);
+            BinaryPSOResult r1 = opt->Run(f1);
+            All_Model* rec = all->clone();
+            NullScheduleSink quiet;
+            rec->set_schedule_sink(&quiet);
+            rec->fx_function_solve(e.bits, r1.xbest.data(), true);
+            rec->set_schedule_sink(NULL);
+            rec->ls_analyze();
+            double offset = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            LongSpanObjective f2(rec);
+            BinaryPSOResult r2 = opt->Run(f2);
+            All_Model* replay = rec->clone();
+            replay->set_schedule_sink(&quiet);
+            replay->fx_function_solve_2(f2.Size(), r2.xbest.data(), true);
+            run.violations = replay->validate().size();
+            delete replay;
+            delete rec;
+            for (BinaryPSOProgress p : r2.history) {
+                p.seconds += offset;
+                p.evaluations += r1.evaluations;
+                p.best = std::max(p.best, r1.best);
+                if (run.history.empty() || p.best < run.history.back().best) run.history.push_back(p);
+            }
+            run.best = std::max(r1.best, r2.best);
+            run.evaluations = r1.evaluations + r2.evaluations;
+            run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+        delete opt;
+        e.runs.push_back(run);
+    }
+    delete all;
+    delete ss;
+}
+
+/**
+ * @brief Runs one instance in a child process and collects its runs and peak RSS.
+ */
+static void run_isolated(SuiteEntry& e, const BinaryPSOParams& params, const std::vector<unsigned>& seeds) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        e.error = std::string("pipe: ") + strerror(errno);
+        return;
+    }
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) {
+        e.error = std::string("fork: ") + strerror(errno);
+        close(fds[0]);
+        close(fds[1]);
+        return;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        run_instance(e, params, seeds);
+        std::string buf;
+        put(buf, e.bits);
+        put(buf, e.kind.empty() ? 0 : e.kind == "ss" ? 2 : 1);
+        put(buf, e.error.size());
+        buf += e.error;
+        put(buf, e.runs.size());
+        for (const SuiteRun& r : e.runs) {
+            put(buf, r.best);
+            put(buf, r.evaluations);
+            put(buf, r.seconds);
+            put(buf, r.violations);
+            put(buf, r.history.size());
+            for (const BinaryPSOProgress& p : r.history) {
+                put(buf, p.seconds);
+                put(buf, p.evaluations);
+                put(buf, p.best);
+            }
+        }
+        for (size_t off = 0; off < buf.size();) {
+            ssize_t n = write(fds[1], buf.data() + off, buf.size() - off);
+            if (n <= 0) _exit(1);
+            off += n;
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    std::string buf;
+    char chunk[65536];
+    ssize_t n;
+    while ((n = read(fds[0], chunk, sizeof chunk)) > 0) {
+        buf.append(chunk, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof usage);
+    wait4(pid, &status, 0, &usage);
+    e.peak_rss_kb = usage.ru_maxrss;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        e.error = "child failed";
+        return;
+    }
+    size_t pos = 0;
+    e.bits = (int) get(buf, pos);
+    int kind = (int) get(buf, pos);
+    e.kind = kind == 2 ? "ss" : kind == 1 ? "split" : "";
+    size_t len = (size_t) get(buf, pos);
+    if (pos + len > buf.size()) {
+        e.error = "truncated results";
+        return;
+    }
+    e.error = buf.substr(pos, len);
+    pos += len;
+    size_t runs = (size_t) get(buf, pos);
+    for (size_t i = 0; i < runs && pos < buf.size(); i++) {
+        SuiteRun r;
+        r.best = get(buf, pos);
+        r.evaluations = (long long) get(buf, pos);
+        r.seconds = get(buf, pos);
+        r.violations = (int) get(buf, pos);
+        size_t h = (size_t) get(buf, pos);
+        for (size_t j = 0; j < h; j++) {
+            BinaryPSOProgress p;
+            p.seconds = get(buf, pos);
+            p.evaluations = (long long) get(buf, pos);
+            p.best = get(buf, pos);
+            r.history.push_back(p);
+        }
+        e.runs.push_back(r);
+    }
+    if (pos > buf.size()) e.error = "truncated results";
+}
+
+/**
+ * @brief Finds when a run first reached a target.
+ * @return The progress point, or `NULL` if the run never reached it.
+ */
+static const BinaryPSOProgress* reached(const SuiteRun& r, double target) {
+    for (const BinaryPSOProgress& p : r.history) {
+        if (p.best <= target) return &p;
+    }
+    return NULL;
+}
+
+static double median(std::vector<double> v) {
+    if (v.empty()) return -1;
+    std::sort(v.begin(), v.end());
+    return v.size() % 2 ? v[v.size() / 2] : (v[v.size() / 2 - 1] + v[v.size() / 2]) / 2;
+}
+
+int main(int argc, const char** argv) {
+    int nseeds = 5;
+    unsigned seed = 1;
+    bool use_config = false, generated = true;
+    double gap = 0.05;
+    std::string targets_file, output;
+    std::vector<std::string> files;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string a = argv[i];
+            bool has_value = i + 1 < argc;
+            if (a == "-r" && has_value) nseeds = atoi(argv[++i]);
+            else if (a == "-s" && has_value) seed = strtoul(argv[++i], NULL, 10);
+            else if (a == "-c") use_config = true;
+            else if (a == "-G") generated = false;
+            else if (a == "-T" && has_value) targets_file = argv[++i];
+            else if (a == "-x" && has_value) gap = atof(argv[++i]);
+            else if (a == "-o" && has_value) output = argv[++i];
+            else if (a[0] == '-') {
+                usage(argv[0]);
+                return 1;
+            } else expand_instance_arg(a, files);
+        }
+        if (files.empty()) expand_instance_arg("data/example_data_*", files);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    if (nseeds <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    //! Fixed parameters keep results comparable between commits; -c takes config.txt instead
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 100;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    if (use_config) read_configs(configs);
+    BinaryPSOParams params(configs);
+    if (params.popsize <= 0 || params.iterations < 0) {
+        fprintf(stderr, "POPSIZE and ITERATION must be positive\n");
+        return 1;
+    }
+    if (params.method < 0 || params.method >= METHODS) {
+        fprintf(stderr, "config.txt: unknown METHOD\n");
+        return 1;
+    }
+    std::vector<unsigned> seeds;
+    for (int i = 0; i < nseeds; i++) {
+        seeds.push_back(seed + i * 2654435761u);
+    }
+
+    std::vector<SuiteEntry> entries(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        entries[i].name = entries[i].file = files[i];
+    }
+    char dir[] = "/tmp/pso_suite_XXXXXX";
+    if (generated) {
+        if (!mkdtemp(dir)) {
+            fprintf(stderr, "mkdtemp: %s\n", strerror(errno));
+            return 1;
+        }
+        const int shapes[][9] = {
+            //! W, H, L, fill %, exp_ss, exp_ls, imp_ss, imp_ls, seed
+            {10, 4, 4, 50, 5, 5, 5, 5, 1},
+            {40, 5, 4, 60, 10, 10, 8, 8, 2},
+            {100, 5, 6, 60, 20, 20, 15, 15, 3},
+        };
+        for (const int* g : shapes) {
+            YardSpec spec;
+            spec.W = g[0];
+            spec.H = g[1];
+            spec.L = g[2];
+            spec.fill = g[3] / 100.0;
+            spec.exp_ss = g[4];
+            spec.exp_ls = g[5];
+            spec.imp_ss = g[6];
+            spec.imp_ls = g[7];
+            spec.seed = g[8];
+            char name[128];
+            snprintf(name, sizeof name, "gen:W%d-H%d-L%d-f%.2f-e%dx%d-i%dx%d-s%u", spec.W, spec.H, spec.L,
+                    spec.fill, spec.exp_ss, spec.exp_ls, spec.imp_ss, spec.imp_ls, spec.seed);
+            SuiteEntry e;
+            e.name = name;
+            e.file = std::string(dir) + "/yard_" + std::to_string(spec.W) + ".txt";
+            try {
+                generate_instance(spec, e.file.c_str());
+            } catch (const std::exception& ex) {
+                e.error = ex.what();
+            }
+            entries.push_back(e);
+        }
+    }
+
+    std::map<std::string, double> targets;
+    if (!targets_file.empty()) {
+        std::ifstream in(targets_file.c_str());
+        std::string name;
+        double t;
+        while (in >> name >> t) targets[name] = t;
+    }
+
+    for (SuiteEntry& e : entries) {
+        e.bits = 0;
+        e.peak_rss_kb = 0;
+        if (e.error.empty()) run_isolated(e, params, seeds);
+        fprintf(stderr, "%s: %s\n", e.name.c_str(), e.error.empty() ? "done" : e.error.c_str());
+    }
+    if (generated) {
+        for (const SuiteEntry& e : entries) {
+            if (e.name.compare(0, 4, "gen:") == 0) unlink(e.file.c_str());
+        }
+        rmdir(dir);
+    }
+
+    //! Instances without a stored target get one from the best makespan of this run
+    bool new_targets = false;
+    for (SuiteEntry& e : entries) {
+        e.target = -1;
+        if (!e.error.empty() || e.runs.empty()) continue;
+        if (targets.count(e.name)) {
+            e.target = targets[e.name];
+        } else {
+            double best = e.runs[0].best;
+            for (const SuiteRun& r : e.runs) best = std::min(best, r.best);
+            e.target = targets[e.name] = best * (1 + gap);
+            new_targets = true;
+        }
+    }
+    if (!targets_file.empty() && new_targets) {
+        FILE* out = fopen(targets_file.c_str(), "w");
+        if (out) {
+            for (auto& t : targets) fprintf(out, "%s %.6f\n", t.first.c_str(), t.second);
+            fclose(out);
+        } else {
+            fprintf(stderr, "%s: cannot write targets\n", targets_file.c_str());
+        }
+    }
+
+    FILE* out = stdout;
+    if (!output.empty()) {
+        out = fopen(output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "%s: cannot open\n", output.c_str());
+            return 1;
+        }
+    }
+    bool json = output.size() > 5 && output.compare(output.size() - 5, 5, ".json") == 0;
+    if (json) {
+        fprintf(out, "{\n  \"popsize\": %d, \"iterations\": %d, \"weight\": %g, \"c1\": %g, \"c2\": %g, \"vmax\": %g,\n"
+                "  \"method\": \"%s\", \"seed\": %u, \"seeds\": %d,\n  \"instances\": [", params.popsize, params.iterations,
+                params.weight, params.c1, params.c2, params.vmax, method_names[params.method], seed, nseeds);
+    } else {
+        fprintf(out, "instance,kind,bits,seeds,evals_per_sec,mean_seconds,target,hits,median_seconds_to_target,"
+                "mean_evals_to_target,best,mean_best,violations,peak_rss_kb,error\n");
+    }
+    int row = 0;
+    for (const SuiteEntry& e : entries) {
+        double evals = 0, seconds = 0, best = 0, mean_best = 0, evals_to_target = 0;
+        int violations = 0;
+        std::vector<double> to_target;
+        for (const SuiteRun& r : e.runs) {
+            evals += r.evaluations;
+            seconds += r.seconds;
+            mean_best += r.best;
+            violations += r.violations;
+            best = (&r == &e.runs[0]) ? r.best : std::min(best, r.best);
+            const BinaryPSOProgress* p = reached(r, e.target);
+            if (p) {
+                to_target.push_back(p->seconds);
+                evals_to_target += p->evaluations;
+            }
+        }
+        size_t n = std::max<size_t>(e.runs.size(), 1);
+        double rate = seconds > 0 ? evals / seconds : 0;
+        double med = median(to_target);
+        double mean_evals = to_target.empty() ? -1 : evals_to_target / to_target.size();
+        if (json) {
+            fprintf(out, "%s\n    {\"instance\": %s, \"kind\": \"%s\", \"bits\": %d, \"evals_per_sec\": %.1f, "
+                    "\"mean_seconds\": %.6f, \"target\": %.6f, \"hits\": %zu, \"median_seconds_to_target\": %.6f, "
+                    "\"mean_evals_to_target\": %.1f, \"best\": %.6f, \"mean_best\": %.6f, \"violations\": %d, "
+                    "\"peak_rss_kb\": %ld, \"error\": %s}", row++ ? "," : "", json_quote(e.name).c_str(), e.kind.c_str(), e.bits,
+                    rate, seconds / n, e.target, to_target.size(), med, mean_evals, best, mean_best / n, violations,
+                    e.peak_rss_kb, json_quote(e.error).c_str());
+        } else {
+            fprintf(out, "%s,%s,%d,%zu,%.1f,%.6f,%.6f,%zu,%.6f,%.1f,%.6f,%.6f,%d,%ld,%s\n", e.name.c_str(),
+                    e.kind.c_str(), e.bits, e.runs.size(), rate, seconds / n, e.target, to_target.size(), med,
+                    mean_evals, best, mean_best / n, violations, e.peak_rss_kb, e.error.c_str());
+        }
+    }
+    if (json) fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) fclose(out);
+    return 0;
+}
@@ -0,0 +1,354 @@
+#include "function.h"
+#include "binary_pso.h"
+#include "instance_set.h"
+#include "optimizers.h"
+#include "thread_pool.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Runs a grid (or a random sample of it) of PSO parameter settings over a set of instances.
+//! Usage: sweep [-j threads] [-r seeds] [-n samples] [-k cranes] [-m auto|matrix|all|ss] [-s seed]
+//!              [-o report.csv|report.json] -p NAME=v1,v2,... -p NAME=lo:hi:step ... <file | 'glob' | @list>...
+//! NAME is one of POPSIZE, ITERATION, WEIGHT, C1, C2, VMAX, METHOD, TEMP, REPLICAS, TENURE,
+//! NEIGHBORS, SCREEN, FIDELITY, INERTIA, WEIGHTEND, MINPOP, DEDUP, RESEED or MINDIV. Unswept values come from config.txt.
+
+static const char* sweepable[] = {"POPSIZE", "ITERATION", "WEIGHT", "C1", "C2", "VMAX",
+                                  "METHOD", "TEMP", "REPLICAS", "TENURE", "NEIGHBORS", "SCREEN", "FIDELITY",
+                                  "INERTIA", "WEIGHTEND", "MINPOP", "DEDUP", "RESEED", "MINDIV"};
+static const int SWEEPABLE = sizeof sweepable / sizeof sweepable[0];
+
+/**
+ * @brief Represents one swept parameter and its values.
+ */
+struct Axis {
+    std::string name;           /**< The config.txt key. */
+    std::vector<double> values; /**< The values to try. */
+};
+
+/**
+ * @brief Represents the runs of one configuration on one instance.
+ */
+struct Cell {
+    std::vector<BinaryPSOResult> runs; /**< The result of each seed. */
+    double best;                       /**< The best fitness over the seeds. */
+    double mean;                       /**< The mean fitness over the seeds. */
+    double seconds;                    /**< The mean wall time of a run. */
+    double evaluations;                /**< The mean evaluation count of a run. */
+};
+
+/**
+ * @brief Represents one configuration of the sweep and its summary.
+ */
+struct Config {
+    std::map<std::string, double> values; /**< The config.txt entries of the configuration. */
+    std::vector<Cell> cells;              /**< The runs on each instance. */
+    double mean_gap;                      /**< The mean relative gap of the mean fitness to the reference. */
+    double best_gap;                      /**< The mean relative gap of the best fitness to the reference. */
+    double seconds;                       /**< The mean wall time of a run. */
+    double evaluations;                   /**< The mean evaluation count of a run. */
+    bool pareto;                          /**< A flag indicating whether no other configuration is both better and faster. */
+};
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-j threads] [-r seeds] [-n samples] [-k cranes] [-m auto|matrix|all|ss] [-s seed]\n"
+            "       [-o report.csv|report.json] -p NAME=v1,v2,... | -p NAME=lo:hi:step ... <file | 'glob' | @list>...\n", prog);
+}
+
+static Axis parse_axis(const std::string& spec) {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 == spec.size()) {
+        throw std::runtime_error("-p " + spec + ": expected NAME=values");
+    }
+    Axis axis;
+    axis.name = spec.substr(0, eq);
+    if (std::find(sweepable, sweepable + SWEEPABLE, axis.name) == sweepable + SWEEPABLE) {
+        throw std::runtime_error("-p " + spec + ": " + axis.name + " cannot be swept");
+    }
+    std::string list = spec.substr(eq + 1);
+    char* end;
+    if (std::count(list.begin(), list.end(), ':') == 2) {
+        const char* p = list.c_str();
+        double lo = strtod(p, &end);
+        double hi = strtod(end + 1, &end);
+        double step = strtod(end + 1, &end);
+        if (*end || step <= 0 || hi < lo) {
+            throw std::runtime_error("-p " + spec + ": expected lo:hi:step with lo <= hi and step > 0");
+        }
+        //! Stepped by count so rounding does not drop the last value
+        int n = (int) floor((hi - lo) / step + 1e-9);
+        for (int i = 0; i <= n; i++) {
+            axis.values.push_back(lo + i * step);
+        }
+    } else {
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t comma = list.find(',', start);
+            std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+            double v = strtod(item.c_str(), &end);
+            if (item.empty() || *end) {
+                throw std::runtime_error("-p " + spec + ": bad value '" + item + "'");
+            }
+            axis.values.push_back(v);
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+    }
+    return axis;
+}
+
+static std::string describe(const Config& c, const std::vector<Axis>& axes) {
+    std::string s;
+    char buf[64];
+    for (auto& a : axes) {
+        snprintf(buf, sizeof buf, "%s%s=%g", s.empty() ? "" : " ", a.name.c_str(), c.values.at(a.name));
+        s += buf;
+    }
+    return s;
+}
+
+int main(int argc, const char** argv) {
+    int threads = 0, cranes = 2, seeds = -1, samples = 0;
+    unsigned seed = 0;
+    std::string mode = "auto", output;
+    std::vector<std::string> files;
+    std::vector<Axis> axes;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string a = argv[i];
+            bool has_value = i + 1 < argc;
+            if (a == "-j" && has_value) threads = atoi(argv[++i]);
+            else if (a == "-r" && has_value) seeds = atoi(argv[++i]);
+            else if (a == "-n" && has_value) samples = atoi(argv[++i]);
+            else if (a == "-k" && has_value) cranes = atoi(argv[++i]);
+            else if (a == "-m" && has_value) mode = argv[++i];
+            else if (a == "-s" && has_value) seed = strtoul(argv[++i], NULL, 10);
+            else if (a == "-o" && has_value) output = argv[++i];
+            else if (a == "-p" && has_value) axes.push_back(parse_axis(argv[++i]));
+            else if (a[0] == '-') {
+                usage(argv[0]);
+                return 1;
+            } else expand_instance_arg(a, files);
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    if (files.empty() || axes.empty() || (mode != "auto" && mode != "matrix" && mode != "all" && mode != "ss")) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, double> base;
+    read_configs(base);
+    if (seeds <= 0) seeds = BinaryPSOParams(base).restarts;
+    if (seed == 0) seed = std::random_device()();
+
+    //! Enumerate the grid, then keep a random sample of it if asked
+    std::vector<Config> configs(1);
+    configs[0].values = base;
+    for (auto& axis : axes) {
+        std::vector<Config> next;
+        for (auto& c : configs) {
+            for (double v : axis.values) {
+                next.push_back(c);
+                next.back().values[axis.name] = v;
+            }
+        }
+        configs.swap(next);
+    }
+    if (samples > 0 && samples < (int) configs.size()) {
+        std::mt19937 rng(seed);
+        std::shuffle(configs.begin(), configs.end(), rng);
+        configs.resize(samples);
+    }
+    for (auto& c : configs) {
+        BinaryPSOParams p(c.values);
+        if (p.popsize <= 0 || p.iterations < 0) {
+            fprintf(stderr, "%s: POPSIZE and ITERATION must be positive\n", describe(c, axes).c_str());
+            return 1;
+        }
+        if (p.method < 0 || p.method >= METHODS) {
+            fprintf(stderr, "%s: unknown METHOD\n", describe(c, axes).c_str());
+            return 1;
+        }
+        //! The report shows the values the runs use, defaults included
+        c.values["METHOD"] = p.method;
+        c.values["TEMP"] = p.temp;
+        c.values["REPLICAS"] = p.replicas;
+        c.values["TENURE"] = p.tenure;
+        c.values["NEIGHBORS"] = p.neighbors;
+        c.values["SCREEN"] = p.screen;
+        c.values["FIDELITY"] = p.fidelity;
+        c.values["INERTIA"] = p.inertia;
+        c.values["WEIGHTEND"] = p.weight_end;
+        c.values["MINPOP"] = p.min_pop;
+        c.values["DEDUP"] = p.dedup;
+        c.values["RESEED"] = p.reseed;
+        c.values["MINDIV"] = p.min_div;
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    ThreadPool pool(threads);
+    std::vector<LoadedInstance> instances(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        LoadedInstance* in = &instances[i];
+        in->file = files[i];
+        in->kind = mode == "auto" ? detect_instance_kind(files[i]) : mode;
+        pool.submit([in, cranes] {
+            in->load(cranes);
+        });
+    }
+    pool.wait();
+    for (auto& in : instances) {
+        if (!in.error.empty()) {
+            fprintf(stderr, "%s\n", in.error.c_str());
+            return 1;
+        }
+    }
+
+    //! Every configuration sees the same seeds, so differences come from the parameters
+    struct Job {
+        int c, i, r;
+        double cost;
+    };
+    std::vector<Job> jobs;
+    for (size_t c = 0; c < configs.size(); c++) {
+        BinaryPSOParams p(configs[c].values);
+        configs[c].cells.resize(instances.size());
+        for (size_t i = 0; i < instances.size(); i++) {
+            configs[c].cells[i].runs.resize(seeds);
+            for (int r = 0; r < seeds; r++) {
+                jobs.push_back({(int) c, (int) i, r, (double) p.popsize * p.iterations * instances[i].objective->Size()});
+            }
+        }
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        return a.cost > b.cost;
+    });
+    for (auto& j : jobs) {
+        Config* c = &configs[j.c];
+        LoadedInstance* in = &instances[j.i];
+        unsigned run_seed = seed + (unsigned) (j.i * seeds + j.r) * 2654435761u;
+        int r = j.r, i = j.i;
+        pool.submit([c, in, i, r, run_seed] {
+            Optimizer* opt = make_optimizer(BinaryPSOParams(c->values), run_seed);
+            c->cells[i].runs[r] = opt->Run(*in->objective);
+            delete opt;
+        });
+    }
+    pool.wait();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    //! Gaps are relative to the best fitness any configuration reached on the instance
+    std::vector<double> reference(instances.size(), std::numeric_limits<double>::max());
+    for (auto& c : configs) {
+        for (size_t i = 0; i < instances.size(); i++) {
+            Cell& cell = c.cells[i];
+            cell.best = std::numeric_limits<double>::max();
+            cell.mean = cell.seconds = cell.evaluations = 0;
+            for (auto& r : cell.runs) {
+                cell.best = std::min(cell.best, r.best);
+                cell.mean += r.best;
+                cell.seconds += r.seconds;
+                cell.evaluations += r.evaluations;
+            }
+            cell.mean /= seeds;
+            cell.seconds /= seeds;
+            cell.evaluations /= seeds;
+            reference[i] = std::min(reference[i], cell.best);
+        }
+    }
+    for (auto& c : configs) {
+        c.mean_gap = c.best_gap = c.seconds = c.evaluations = 0;
+        for (size_t i = 0; i < instances.size(); i++) {
+            double ref = reference[i] != 0 ? fabs(reference[i]) : 1;
+            c.mean_gap += (c.cells[i].mean - reference[i]) / ref;
+            c.best_gap += (c.cells[i].best - reference[i]) / ref;
+            c.seconds += c.cells[i].seconds;
+            c.evaluations += c.cells[i].evaluations;
+        }
+        c.mean_gap /= instances.size();
+        c.best_gap /= instances.size();
+        c.seconds /= instances.size();
+        c.evaluations /= instances.size();
+    }
+    for (auto& c : configs) {
+        c.pareto = true;
+        for (auto& o : configs) {
+            if (o.mean_gap <= c.mean_gap && o.seconds <= c.seconds && (o.mean_gap < c.mean_gap || o.seconds < c.seconds)) {
+                c.pareto = false;
+                break;
+            }
+        }
+    }
+    std::vector<Config*> order;
+    for (auto& c : configs) {
+        order.push_back(&c);
+    }
+    std::stable_sort(order.begin(), order.end(), [](Config* a, Config* b) {
+        return a->mean_gap < b->mean_gap || (a->mean_gap == b->mean_gap && a->seconds < b->seconds);
+    });
+
+    printf("%-40s %10s %10s %12s %12s %s\n", "configuration", "mean_gap", "best_gap", "run_seconds", "evaluations", "pareto");
+    for (auto c : order) {
+        printf("%-40s %10.6f %10.6f %12.6f %12.0f %s\n", describe(*c, axes).c_str(), c->mean_gap, c->best_gap,
+                c->seconds, c->evaluations, c->pareto ? "*" : "");
+    }
+
+    if (!output.empty()) {
+        FILE* out = fopen(output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "%s: cannot open for writing\n", output.c_str());
+            return 1;
+        }
+        bool json = output.size() >= 5 && output.compare(output.size() - 5, 5, ".json") == 0;
+        if (json) {
+            fprintf(out, "{\n  \"seed\": %u,\n  \"seeds\": %d,\n  \"threads\": %d,\n  \"wall_seconds\": %.3f,\n  \"configs\": [",
+                    seed, seeds, pool.size(), wall);
+        } else {
+            fprintf(out, "config");
+            for (auto name : sweepable) fprintf(out, ",%s", name);
+            fprintf(out, ",mean_gap,best_gap,run_seconds,evaluations,pareto,file,best,mean,file_run_seconds,file_evaluations\n");
+        }
+        for (size_t k = 0; k < order.size(); k++) {
+            Config* c = order[k];
+            if (json) {
+                fprintf(out, "%s\n    {\"params\": {", k ? "," : "");
+                for (int n = 0; n < 6; n++) {
+                    fprintf(out, "%s\"%s\": %g", n ? ", " : "", sweepable[n], c->values[sweepable[n]]);
+                }
+                fprintf(out, "}, \"mean_gap\": %lf, \"best_gap\": %lf, \"run_seconds\": %lf, \"evaluations\": %.0f, \"pareto\": %s, \"instances\": [",
+                        c->mean_gap, c->best_gap, c->seconds, c->evaluations, c->pareto ? "true" : "false");
+            }
+            for (size_t i = 0; i < instances.size(); i++) {
+                Cell& cell = c->cells[i];
+                if (json) {
+                    fprintf(out, "%s\n      {\"file\": %s, \"best\": %lf, \"mean\": %lf, \"run_seconds\": %lf, \"evaluations\": %.0f}",
+                            i ? "," : "", json_quote(instances[i].file).c_str(), cell.best, cell.mean, cell.seconds, cell.evaluations);
+                } else {
+                    fprintf(out, "%d", (int) k);
+                    for (auto name : sweepable) fprintf(out, ",%g", c->values[name]);
+                    fprintf(out, ",%lf,%lf,%lf,%.0f,%d,%s,%lf,%lf,%lf,%.0f\n", c->mean_gap, c->best_gap, c->seconds,
+                            c->evaluations, c->pareto, instances[i].file.c_str(), cell.best, cell.mean, cell.seconds, cell.evaluations);
+                }
+            }
+            if (json) fprintf(out, "\n    ]}");
+        }
+        if (json) fprintf(out, "\n  ]\n}\n");
+        fclose(out);
+    }
+    fprintf(stderr, "%zu configurations x %zu instances x %d seeds, %d threads, %.3f s (seed %u)\n",
+            configs.size(), instances.size(), seeds, pool.size(), wall, seed);
+    return 0;
+}
@@ -4,170 +4,24 @@
 #include <time.h>
 #include <math.h>
 #include <limits>
+#include <stdexcept>
 
 #include "function.h"
+#include "matrix_model.h"
 
 #define WEIGHT 1000
 
-int side_of_working, ss, ls, import_container, free_area, export_container, movement;
-double **time_side_to_a;
-double **time_side_to_c;
-double **time_a_to_c;
-int* upper;
-int* lower;
-int* start_bit;
-int* bitnum;
-
-double fx_function_solve(int x_size, char* x, bool display) {
-    int max_size = ls + ss;
-    int mss = ss;
-    int mls = ls + ss;
-    int ma = free_area;
-    int set_export_container[export_container];
-    int set_area[free_area];
-    for (int i = 0; i < export_container; i++)
-        set_export_container[i] = i;
-    for (int i = 0; i < free_area; i++)
-        set_area[i] = i;
-    double y = 0;
-    for (int i = 0; i < ss; i++) {
-        int ic = binary_2_decimal(bitnum[i * 2], &x[start_bit[i * 2]]);
-        int ia = binary_2_decimal(bitnum[i * 2 + 1], &x[start_bit[i * 2 + 1]]);
-        ic = (ic / pow(2, bitnum[i * 2])) * upper[i * 2];
-        ia = (ia / pow(2, bitnum[i * 2 + 1])) * upper[i * 2 + 1];
-        int tc = set_export_container[ic];
-        int ta = set_area[ia];
-        set_export_container[ic] = set_export_container[mss - 1];
-        set_area[ia] = set_area[ma - 1];
-        mss--;
-        ma--;
-        double sum = time_side_to_a[0][ta] + time_a_to_c[ta][tc] + time_side_to_c[0][tc];
-        if (display) printf("SS: 1, %d, %d, %d, %d, %lf(%lf, %lf, %lf)\n", i + 1, ta + 1, tc + 1, i + 1, sum, time_side_to_a[0][ta], time_a_to_c[ta][tc], time_side_to_c[0][tc]);
-        y += sum;
-    }
-    for (int i = ss; i < (ls + ss); i++) {
-        int ic = binary_2_decimal(bitnum[i * 2], &x[start_bit[i * 2]]);
-        int ia = binary_2_decimal(bitnum[i * 2 + 1], &x[start_bit[i * 2 + 1]]);
-        ic = (ic / pow(2, bitnum[i * 2])) * upper[i * 2];
-        ia = (ia / pow(2, bitnum[i * 2 + 1])) * upper[i * 2 + 1];
-        ic += ss;
-        int tc = set_export_container[ic];
-        int ta = set_area[ia];
-        set_export_container[ic] = set_export_container[mls - 1];
-        set_area[ia] = set_area[ma - 1];
-        mls--;
-        ma--;
-        double sum = time_side_to_a[1][ta] + time_a_to_c[ta][tc] + time_side_to_c[1][tc];
-        if (display) printf("LS: 2, %d, %d, %d, %d, %lf(%lf, %lf, %lf)\n", i + 1, ta + 1, tc + 1, i + 1, sum, time_side_to_a[1][ta], time_a_to_c[ta][tc], time_side_to_c[1][tc]);
-        y += sum;
-    }
-    return y;
-}
-
-int calculate_malloc_size() {
-    int sbit = 0;
-    for (int i = 0; i < ss; i++) {
-        lower[i * 2] = 0;
-        lower[i * 2 + 1] = 0;
-        upper[i * 2] = ss - 1 - i;
-        upper[i * 2 + 1] = free_area - 1 - i;
-        start_bit[i * 2] = sbit;
-        bitnum[i * 2] = decimal_2_binary_size(upper[i * 2]);
-        sbit += bitnum[i * 2];
-        start_bit[i * 2 + 1] = sbit;
-        bitnum[i * 2 + 1] = decimal_2_binary_size(upper[i * 2 + 1]);
-        sbit += bitnum[i * 2 + 1];
-        /*		printf("bit %d(%d:%d), %d(%d:%d)\n",
-                                   start_bit[i*2], upper[i*2], bitnum[i*2],
-                                   start_bit[i*2+1], upper[i*2+1], bitnum[i*2+1]); */
-    }
-    for (int j = 0; j < ls; j++) {
-        int i = j + ss;
-        lower[i * 2] = 0;
-        lower[i * 2 + 1] = 0;
-        upper[i * 2] = ls - 1 - j;
-        upper[i * 2 + 1] = free_area - 1 - j - ss;
-        start_bit[i * 2] = sbit;
-        bitnum[i * 2] = decimal_2_binary_size(upper[i * 2]);
-        sbit += bitnum[i * 2];
-        start_bit[i * 2 + 1] = sbit;
-        bitnum[i * 2 + 1] = decimal_2_binary_size(upper[i * 2 + 1]);
-        sbit += bitnum[i * 2 + 1];
-        /*		printf("bit %d(%d:%d), %d(%d:%d)\n",
-                                   start_bit[i*2], upper[i*2], bitnum[i*2],
-                                   start_bit[i*2+1], upper[i*2+1], bitnum[i*2+1]); */
-    }
-    //	printf("count: %d\n", sbit);
-    return sbit;
-}
-
-void read_data(const char* file) {
-    FILE *ptr = NULL;
-    ptr = fopen(file, "r");
-    if (ptr) {
-        fscanf(ptr, "%d %d %d %d %d %d %d", &side_of_working, &ss, &ls, &import_container, &free_area, &export_container, &movement);
-        time_side_to_a = (double**) malloc(sizeof (double*) * side_of_working);
-        for (int i = 0; i < side_of_working; i++) {
-            time_side_to_a[i] = (double*) malloc(sizeof (double) * free_area);
-            for (int j = 0; j < free_area; j++) {
-                fscanf(ptr, "%lf", &time_side_to_a[i][j]);
-                //				printf("%lf ", time_side_to_a[i][j]);
-            }
-            //			printf("\n");
-        }
-        time_side_to_c = (double**) malloc(sizeof (double*) * side_of_working);
-        for (int i = 0; i < side_of_working; i++) {
-            time_side_to_c[i] = (double*) malloc(sizeof (double) * export_container);
-            for (int j = 0; j < export_container; j++) {
-                fscanf(ptr, "%lf", &time_side_to_c[i][j]);
-                //				printf("%lf\n", time_side_to_c[i][j]);
-            }
-        }
-        time_a_to_c = (double**) malloc(sizeof (double*) * free_area);
-        for (int i = 0; i < free_area; i++) {
-            time_a_to_c[i] = (double*) malloc(sizeof (double) * export_container);
-            for (int j = 0; j < export_container; j++) {
-                fscanf(ptr, "%lf", &time_a_to_c[i][j]);
-                //				printf("%lf ", time_a_to_c[i][j]);
-            }
-            //			printf("\n");
-        }
-    }
-    fclose(ptr);
-}
-
-int init(char*& input) {
-    read_data(input);
-    upper = (int*) malloc(sizeof (int)*((ss + ls)*2));
-    lower = (int*) malloc(sizeof (int)*((ss + ls)*2));
-    start_bit = (int*) malloc(sizeof (int)*((ss + ls)*2));
-    bitnum = (int*) malloc(sizeof (int)*((ss + ls)*2));
-    int allocate_size = calculate_malloc_size();
-
-    return allocate_size;
-}
-
-void uninit() {
-    free(upper);
-    free(lower);
-    free(start_bit);
-    free(bitnum);
-    for (int i = 0; i < side_of_working; i++) {
-        free(time_side_to_a[i]);
-    }
-    free(time_side_to_a);
-    for (int i = 0; i < side_of_working; i++) {
-        free(time_side_to_c[i]);
-    }
-    free(time_side_to_c);
-    for (int i = 0; i < free_area; i++) {
-        free(time_a_to_c[i]);
-    }
-    free(time_a_to_c);
-}
-
 int main(int argc, char** argv) {
-    int malloc_size = init(argv[1]);
+    const char* file_name = argv[1];
+
+    Matrix_Model* master;
+    try {
+        master = new Matrix_Model(file_name);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    int malloc_size = master->get_bit_size();
 
     std::map<std::string, double> configs;
     read_configs(configs);
@@ -205,7 +59,7 @@ int main(int argc, char** argv) {
         }
 
         for (int i = 0; i < popsize; i++) {
-            pbest[i] = fx[i] = fx_function_solve(malloc_size, x[i], false);
+            pbest[i] = fx[i] = master->fx_function_solve(malloc_size, x[i], false);
         }
 
         double w1 = configs["WEIGHT"];
@@ -222,9 +76,8 @@ int main(int argc, char** argv) {
         memcpy(xgbest, x[l], malloc_size);
 
         for (int iter = 1; iter <= maxiter; iter++) {
-            double w = 0.5;
             for (int i = 0; i < popsize; i++) {
-                fx[i] = fx_function_solve(malloc_size, x[i], false);
+                fx[i] = master->fx_function_solve(malloc_size, x[i], false);
                 if (fx[i] < pbest[i]) {
                     pbest[i] = fx[i];
                     memcpy(xpbest[i], x[i], malloc_size);
@@ -289,7 +142,7 @@ int main(int argc, char** argv) {
         //		printf("%lf %lf\n", Gbest1, Pbest1);
     }
     printf("%s : %lf\n", argv[1], Gbest1);
-    fx_function_solve(malloc_size, xgbest, true);
+    master->fx_function_solve(malloc_size, xgbest, true);
 
     for (int i = 0; i < popsize; i++) {
         free(x[i]);
@@ -306,6 +159,7 @@ int main(int argc, char** argv) {
     free(fx);
     free(pbest);
     free(xgbest);
+    delete master;
 
     return 0;
 }
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <math.h>
 #include <limits>
+#include <stdexcept>
 #include <time.h>
 
 //#define DEBUG
@@ -18,7 +19,13 @@ int main(int argc, const char** argv) {
     std::map<std::string, double> configs;
     read_configs(configs);
 
-    All_Model* master = new All_Model(file_name);
+    All_Model* master;
+    try {
+        master = new All_Model(file_name);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
     int malloc_size = master->get_bit_size();
 
     double Pbest1 = std::numeric_limits<double>::max();
@@ -72,7 +79,6 @@ int main(int argc, const char** argv) {
         memcpy(xgbest, x[l], malloc_size);
 
         for (int iter = 1; iter <= maxiter; iter++) {
-            double w = 0.5;
             for (int i = 0; i < popsize; i++) {
                 All_Model* m = static_cast<All_Model*>(master->clone());
                 fx[i] = m->fx_function_solve(malloc_size, x[i], false);
@@ -179,7 +185,6 @@ int main(int argc, const char** argv) {
         memcpy(xgbest, x[l], malloc_size);
 
         for (int iter = 1; iter <= maxiter; iter++) {
-            double w = 0.5;
             for (int i = 0; i < popsize; i++) {
                 All_Model* m = static_cast<All_Model*>(master->clone());
                 fx[i] = m->fx_function_solve_2(malloc_size, x[i], false);
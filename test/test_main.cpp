@@ -1,12 +1,45 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <limits>
 #include <map>
+#include <random>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include "function.h"
 #include "model.h"
+#include "all_model.h"
+#include "rail_schedule.h"
+#include "instance_reader.h"
+#include "binary_instance.h"
+#include "binary_pso.h"
+#include "model_objective.h"
+#include "thread_pool.h"
+#include "schedule_sink.h"
+#include "instance_set.h"
+#include "instance_generator.h"
+#include "instrument.h"
+#include "trace_recorder.h"
+#include "perf_counters.h"
+#include "bench.h"
+#include "beam_search.h"
+#include "warm_start.h"
+#include "rolling_horizon.h"
+#include "branch_and_bound.h"
+#include "optimizers.h"
+#include "surrogate.h"
+#include "pareto_archive.h"
+#include "schedule_validator.h"
 
 // Simple assert macro
 #define ASSERT(condition) \
@@ -79,6 +112,1435 @@ void test_model() {
     ASSERT(m.fx_function_solve(3, x, false) == 0);
 }
 
+void test_all_model_joint() {
+    std::cout << "Testing All_Model joint evaluation..." << std::endl;
+    const char* files[] = {"data/example_data_all_small_01.txt", "data/example_data_all_small_02.txt"};
+    NullScheduleSink quiet;
+    srand(11);
+    for (const char* file : files) {
+        All_Model master(file);
+        int size = master.get_joint_bit_size();
+        int ss_size = master.get_ss_bit_size();
+        ASSERT(size >= ss_size);
+        std::vector<char> x(size);
+        for (int t = 0; t < 20; t++) {
+            for (auto& b : x) b = rand() % 2;
+            //! Record the short-span run, then score the rest on the yard it left
+            All_Model* rec = master.clone();
+            rec->set_schedule_sink(&quiet);
+            double ss = rec->fx_function_solve(ss_size, x.data(), true);
+            rec->set_schedule_sink(NULL);
+            rec->reanalyze();
+            double ls_y = rec->fx_function_solve_2(size - ss_size, x.data() + ss_size);
+
+            All_Model* a = master.clone();
+            All_Model* b = master.clone();
+            All_Model* c = master.clone();
+            double joint = a->fx_function_solve_joint(size, x.data());
+            ASSERT(joint == std::max(ss, ls_y));
+            ASSERT(b->fx_function_solve_joint_bounded(x.data(), std::numeric_limits<double>::infinity()) == joint);
+            ASSERT(c->fx_function_solve_joint_relaxed(x.data()) <= joint);
+            delete a;
+            delete b;
+            delete c;
+            delete rec;
+        }
+    }
+
+    //! The two-phase pipeline scores clones of the recorded master as it always has
+    const char* file = "data/example_data_all_small_03.txt";
+    All_Model master(file);
+    int n = master.get_bit_size();
+    std::mt19937 rng(5);
+    std::vector<char> x(n);
+    for (auto& b : x) b = rng() % 2;
+    master.set_schedule_sink(&quiet);
+    ASSERT(master.fx_function_solve(n, x.data(), true) == 640);
+    master.ls_analyze();
+    double sum = 0;
+    for (int t = 0; t < 30; t++) {
+        for (auto& b : x) b = rng() % 2;
+        All_Model* m = master.clone();
+        sum += m->fx_function_solve_2(n, x.data());
+        delete m;
+    }
+    ASSERT(sum == 23752);
+}
+
+void test_rail_schedule() {
+    std::cout << "Testing RailSchedule..." << std::endl;
+    RailSchedule rail(4, 10);
+    ASSERT(rail.size() == 4);
+    ASSERT(rail.home(0) == -1 && rail.home(3) == 10);
+    ASSERT(rail.home(0) < rail.home(1) && rail.home(1) < rail.home(2) && rail.home(2) < rail.home(3));
+    ASSERT(rail.zone(0) == 1 && rail.zone(9) == 2);
+
+    //! Two cranes reproduce the joint evaluator
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    int size = master.get_joint_bit_size();
+    std::vector<char> x(size);
+    srand(7);
+    for (int t = 0; t < 20; t++) {
+        for (auto& b : x) b = rand() % 2;
+        All_Model* a = master.clone();
+        All_Model* b = master.clone();
+        ASSERT(a->fx_function_solve_joint(size, x.data()) == b->fx_function_solve_rail(x.data(), 2));
+        delete a;
+        delete b;
+    }
+
+    //! No pair of neighbours ever crosses, waits and idle time included, nor does any crane jump
+    YardSpec spec;
+    spec.W = 20;
+    spec.H = 5;
+    spec.L = 4;
+    spec.fill = 0.6;
+    spec.exp_ss = spec.exp_ls = 6;
+    spec.imp_ss = spec.imp_ls = 5;
+    spec.res_ss = spec.res_ls = -1;
+    spec.seed = 3;
+    std::string yard = "/tmp/pso_rail_" + std::to_string(getpid()) + ".txt";
+    generate_instance(spec, yard.c_str());
+    const char* path = yard.c_str();
+    All_Model generated(path);
+    unlink(path);
+    All_Model* masters[] = {&master, &generated};
+    int yields = 0;
+    std::vector<ScheduleEvent> shown;
+    for (All_Model* mm : masters) {
+        int n = mm->get_joint_bit_size();
+        std::vector<char> y(n);
+        for (int k = 2; k <= 4; k++) {
+            for (int t = 0; t < 50; t++) {
+                for (auto& b : y) b = rand() % 2;
+                All_Model* m = mm->clone();
+                RailSchedule sched;
+                double makespan = m->fx_function_solve_rail(y.data(), k, &sched);
+                delete m;
+                ASSERT(sched.size() == k && makespan == sched.makespan());
+                std::vector<ScheduleEvent> events;
+                sched.events(events);
+                std::vector<ScheduleViolation> v = validate_schedule(events);
+                if (!v.empty()) std::cout << describe_violation(v[0]) << std::endl;
+                ASSERT(v.empty());
+                for (int c = 0; c < k; c++) {
+                    for (auto& s : sched.timeline(c)) yields += s.mode == 4;
+                }
+                if (k == 4 && yields > 0 && shown.empty()) shown = events;
+            }
+        }
+    }
+    //! Three or more cranes have to make room for each other
+    ASSERT(yields > 0 && !shown.empty());
+
+    //! The sinks name every crane and the yield mode
+    FILE* out = tmpfile();
+    CsvScheduleSink* csv = new CsvScheduleSink(out);
+    for (const ScheduleEvent& e : shown) csv->emit(e);
+    delete csv;
+    rewind(out);
+    std::string text;
+    for (int ch; (ch = fgetc(out)) != EOF;) text += (char) ch;
+    fclose(out);
+    ASSERT(text.find(",YIELD,") != std::string::npos && text.find(",C3,") != std::string::npos);
+    ASSERT(text.find(",SS,") != std::string::npos && text.find(",LS,") != std::string::npos);
+}
+
+static std::string write_temp(const char* text) {
+    char path[] = "/tmp/pso_reader_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT(fd >= 0);
+    ASSERT(write(fd, text, strlen(text)) == (ssize_t) strlen(text));
+    close(fd);
+    return path;
+}
+
+void test_instance_reader() {
+    std::cout << "Testing InstanceReader..." << std::endl;
+    std::string path = write_temp("3 -12\n 65.870 2.4e1 .5\n7");
+    {
+        InstanceReader in(path.c_str());
+        ASSERT(in.next_int("a") == 3);
+        ASSERT(in.next_int("b", -20, 0) == -12);
+        ASSERT(std::abs(in.next_double("c") - 65.87) < 1e-12);
+        ASSERT(in.next_double("d") == 24.0);
+        ASSERT(in.next_double("e") == 0.5);
+        ASSERT(!in.at_end());
+        bool thrown = false;
+        try {
+            in.next_int("f", 0, 5);
+        } catch (const std::runtime_error& e) {
+            thrown = std::string(e.what()).find(":3: f = 7") != std::string::npos;
+        }
+        ASSERT(thrown);
+        ASSERT(in.at_end());
+    }
+    unlink(path.c_str());
+
+    bool thrown = false;
+    try {
+        InstanceReader in("data/does_not_exist.txt");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    //! Truncated instances are rejected instead of read as garbage
+    thrown = false;
+    try {
+        const char* file = "data/example_data_03.txt";
+        All_Model m(file);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+//! Reads the payload words of a binary instance
+static std::vector<int32_t> read_payload(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<int32_t> words((bytes.size() - sizeof(BinaryInstanceHeader)) / sizeof(int32_t));
+    memcpy(words.data(), bytes.data() + sizeof(BinaryInstanceHeader), words.size() * sizeof(int32_t));
+    return words;
+}
+
+//! Writes a payload behind a valid header, so only the field checks can catch it
+static void write_payload(const char* path, const std::vector<int32_t>& words) {
+    BinaryInstanceHeader h;
+    memcpy(h.magic, BINARY_INSTANCE_MAGIC, 4);
+    h.version = BINARY_INSTANCE_VERSION;
+    h.words = words.size();
+    h.reserved = 0;
+    h.checksum = fnv1a_64(words.data(), words.size() * sizeof(int32_t));
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(int32_t));
+}
+
+//! Loads a binary instance that must be rejected, and returns the error
+static std::string load_error(const char* path) {
+    try {
+        All_Model broken(path);
+    } catch (const std::runtime_error& e) {
+        return e.what();
+    }
+    return "";
+}
+
+void test_binary_instance() {
+    std::cout << "Testing binary instance..." << std::endl;
+    const char* file = "data/example_data_all_small_03.txt";
+    All_Model text(file);
+    std::string path = write_temp("");
+    text.save_binary(path.c_str());
+    ASSERT(is_binary_instance(path.c_str()));
+    ASSERT(!is_binary_instance(file));
+
+    const char* bin = path.c_str();
+    All_Model binary(bin);
+    int size = text.get_joint_bit_size();
+    ASSERT(binary.get_joint_bit_size() == size);
+    ASSERT(binary.get_bit_size() == text.get_bit_size());
+    std::vector<char> x(size);
+    srand(11);
+    for (int t = 0; t < 20; t++) {
+        for (auto& b : x) b = rand() % 2;
+        All_Model* a = text.clone();
+        All_Model* b = binary.clone();
+        ASSERT(a->fx_function_solve_joint(size, x.data()) == b->fx_function_solve_joint(size, x.data()));
+        delete a;
+        delete b;
+        //! The master itself is usable without cloning
+        All_Model direct(bin);
+        All_Model* c = text.clone();
+        ASSERT(direct.fx_function_solve_joint(size, x.data()) == c->fx_function_solve_joint(size, x.data()));
+        delete c;
+    }
+
+    //! Out of range fields are reported with their offset; the containers start at word 23
+    std::vector<int32_t> words = read_payload(bin);
+    auto at = [](int word) {
+        return "byte " + std::to_string(sizeof(BinaryInstanceHeader) + word * sizeof(int32_t)) + ": ";
+    };
+    int c = 23, a = c + 1 + words[c], r = a + 1 + words[a], e = r + 1 + words[r];
+    ASSERT(words[c] % 3 == 0 && words[e] > 0);
+    std::vector<int32_t> bad = words;
+    bad[c + 2] = words[1];
+    write_payload(bin, bad);
+    ASSERT(load_error(bin).find(at(c + 2) + "container w = " + std::to_string(words[1])) != std::string::npos);
+    bad = words;
+    bad[e + 1] = words[c] / 3;
+    write_payload(bin, bad);
+    ASSERT(load_error(bin).find(at(e + 1) + "exp ss container") != std::string::npos);
+    bad = words;
+    bad[c]--;
+    write_payload(bin, bad);
+    ASSERT(load_error(bin).find(at(c) + "container array") != std::string::npos);
+
+    //! The genome layout (words 6 to 22) must be the one the instance needs
+    bad = words;
+    bad[20]++;
+    write_payload(bin, bad);
+    ASSERT(load_error(bin).find(at(20) + "ss_allocate_size = " + std::to_string(words[20] + 1)) != std::string::npos);
+    bad = words;
+    bad[3]--;
+    write_payload(bin, bad);
+    ASSERT(load_error(bin).find(at(3) + "last container id") != std::string::npos);
+    //! Each stacked container must be the one at that height of that stack
+    int rl = e + 1 + words[e], el = rl + 1 + words[rl], hs = el + 1 + words[el], st = hs + 1 + words[hs];
+    ASSERT(words[st] > 0);
+    bad = words;
+    bad[st + 1] = (words[st + 1] + 1) % (words[c] / 3);
+    write_payload(bin, bad);
+    ASSERT(load_error(bin).find(at(st + 1) + "stacked container " + std::to_string(bad[st + 1]) + " is not at") != std::string::npos);
+    write_payload(bin, words);
+    All_Model restored(bin);
+    ASSERT(restored.get_joint_bit_size() == size);
+
+    //! A flipped payload byte fails the checksum
+    FILE* ptr = fopen(bin, "r+b");
+    fseek(ptr, sizeof(BinaryInstanceHeader) + 5, SEEK_SET);
+    fputc(0x7f, ptr);
+    fclose(ptr);
+    bool thrown = false;
+    try {
+        All_Model broken(bin);
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find("checksum") != std::string::npos;
+    }
+    ASSERT(thrown);
+    unlink(bin);
+}
+
+void test_batch_solve() {
+    std::cout << "Testing batch solve..." << std::endl;
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 10;
+    configs["ITERATION"] = 20;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOParams params(configs);
+    ASSERT(params.restarts == 10);
+
+    const char* file = "data/data_10_1.txt";
+    Matrix_Model matrix(file);
+    MatrixObjective objective(&matrix);
+    BinaryPSOResult serial = BinaryPSO(params, 5).Run(objective);
+    ASSERT(serial.evaluations == 10 * 20);
+    ASSERT((int) serial.xbest.size() == matrix.get_bit_size());
+    ASSERT(matrix.fx_function_solve(matrix.get_bit_size(), serial.xbest.data(), false) == serial.best);
+    ASSERT(serial.best <= serial.mean_pbest);
+
+    //! Runs on the pool reproduce the serial runs of the same seeds
+    const char* all_file = "data/example_data_all_small_02.txt";
+    All_Model all(all_file);
+    JointObjective joint(&all);
+    std::vector<BinaryPSOResult> runs(8);
+    {
+        ThreadPool pool(3);
+        for (int r = 0; r < 8; r++) {
+            pool.submit([&, r] {
+                runs[r] = BinaryPSO(params, r).Run(r % 2 ? (Objective&) joint : (Objective&) objective);
+            });
+        }
+        pool.wait();
+    }
+    for (int r = 0; r < 8; r++) {
+        BinaryPSOResult again = BinaryPSO(params, r).Run(r % 2 ? (Objective&) joint : (Objective&) objective);
+        ASSERT(runs[r].best == again.best);
+        ASSERT(runs[r].xbest == again.xbest);
+    }
+
+    //! The history only improves and ends at the best fitness
+    ASSERT(!serial.history.empty() && serial.history.back().best == serial.best);
+    for (size_t i = 1; i < serial.history.size(); i++) {
+        ASSERT(serial.history[i].best < serial.history[i - 1].best);
+        ASSERT(serial.history[i].evaluations >= serial.history[i - 1].evaluations);
+        ASSERT(serial.history[i].seconds >= serial.history[i - 1].seconds);
+    }
+
+    //! The two phases of test_3: the long-span crane runs against the chosen short-span schedule
+    ShortSpanObjective ss(&all);
+    BinaryPSOResult first = BinaryPSO(params, 3).Run(ss);
+    All_Model* rec = all.clone();
+    NullScheduleSink quiet;
+    rec->set_schedule_sink(&quiet);
+    ASSERT(rec->fx_function_solve(ss.Size(), first.xbest.data(), true) == first.best);
+    rec->ls_analyze();
+    LongSpanObjective ls(rec);
+    BinaryPSOResult second = BinaryPSO(params, 3).Run(ls);
+    ASSERT(second.best > 0 && second.evaluations == 10 * 20);
+    delete rec;
+}
+
+void test_schedule_sink() {
+    std::cout << "Testing schedule sink..." << std::endl;
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    int size = master.get_joint_bit_size();
+    std::vector<char> x(size);
+    srand(17);
+    for (int t = 0; t < 10; t++) {
+        for (auto& b : x) b = rand() % 2;
+        All_Model* m = master.clone();
+        VectorScheduleSink events;
+        m->set_schedule_sink(&events);
+        double y = m->fx_function_solve_joint(size, x.data(), true);
+        delete m;
+        //! Each crane's events are back to back and the last one ends at the crane's finish
+        double end[2] = {0, 0};
+        int picks = 0, drops = 0;
+        for (auto& e : events.events) {
+            ASSERT(e.start == end[e.crane]);
+            end[e.crane] += e.duration;
+            picks += e.type == EVENT_PICK;
+            drops += e.type == EVENT_DROP;
+        }
+        ASSERT(picks == drops && picks > 0);
+        ASSERT(std::max(end[0], end[1]) == y);
+
+        //! The binary stream reads back the same events
+        std::string path = write_temp("");
+        FILE* out = fopen(path.c_str(), "wb");
+        ScheduleSink* bin = make_schedule_sink("bin", out);
+        for (auto& e : events.events) bin->emit(e);
+        delete bin;
+        fclose(out);
+        std::vector<ScheduleEvent> back;
+        BinaryScheduleSink::read(path.c_str(), back);
+        unlink(path.c_str());
+        ASSERT(back.size() == events.events.size());
+        for (size_t i = 0; i < back.size(); i++) {
+            ASSERT(memcmp(&back[i].container, &events.events[i].container, 8 * sizeof(int)) == 0);
+            ASSERT(back[i].type == events.events[i].type && back[i].loaded == events.events[i].loaded);
+            ASSERT(back[i].start == events.events[i].start && back[i].duration == events.events[i].duration);
+        }
+    }
+
+    char line[256];
+    ScheduleEvent wait = {EVENT_WAIT, 1, 0, false, 2, 3, -1, 5, -1, -1, 5, -1, 10, 4};
+    ScheduleEvent pick = {EVENT_PICK, 0, 1, false, 2, 3, -1, -1, -1, -1, -1, -1, 14, 28};
+    std::string path = write_temp("");
+    FILE* out = fopen(path.c_str(), "w");
+    TextScheduleSink* text = new TextScheduleSink(out);
+    text->emit(wait);
+    text->emit(pick);
+    delete text;
+    fclose(out);
+    out = fopen(path.c_str(), "r");
+    ASSERT(fgets(line, sizeof line, out) && std::string(line) == "WAIT 4.000000 (10.000000 + 4.000000 -> 14.000000)\n");
+    ASSERT(fgets(line, sizeof line, out) && std::string(line) == "PICK IMP-3 (14.000000 + 28.000000 -> 42.000000)\n");
+    fclose(out);
+
+    out = fopen(path.c_str(), "w");
+    CsvScheduleSink* csv = new CsvScheduleSink(out);
+    csv->emit(wait);
+    delete csv;
+    fclose(out);
+    out = fopen(path.c_str(), "r");
+    ASSERT(fgets(line, sizeof line, out) && strncmp(line, "event,crane,mode", 16) == 0);
+    ASSERT(fgets(line, sizeof line, out) && strncmp(line, "WAIT,LS,RES,0,2,3,", 18) == 0);
+    fclose(out);
+    unlink(path.c_str());
+    ASSERT(schedule_format("a/b.json") == "json" && schedule_format("out.txt") == "text");
+}
+
+void test_instance_set() {
+    std::cout << "Testing instance set..." << std::endl;
+    ASSERT(detect_instance_kind("data/data_10_1.txt") == "matrix");
+    ASSERT(detect_instance_kind("data/example_data_all_small_01.txt") == "all");
+
+    std::vector<std::string> files;
+    expand_instance_arg("data/data_1[02]_1.txt", files);
+    ASSERT(files.size() == 2 && files[0] == "data/data_10_1.txt" && files[1] == "data/data_12_1.txt");
+
+    std::string list = write_temp("# comment\ndata/data_14_1.txt\n\ndata/example_data_all_small_0*.txt\n");
+    files.clear();
+    expand_instance_arg("@" + list, files);
+    unlink(list.c_str());
+    ASSERT(files.size() == 4 && files[0] == "data/data_14_1.txt");
+
+    LoadedInstance good, bad;
+    good.file = files[0];
+    good.kind = detect_instance_kind(good.file);
+    good.load(2);
+    ASSERT(good.error.empty() && good.objective->Size() > 0);
+    bad.file = "data/data_10_1.txt";
+    bad.kind = "all";
+    bad.load(2);
+    ASSERT(!bad.error.empty() && bad.objective == NULL);
+}
+
+void test_instance_generator() {
+    std::cout << "Testing instance generator..." << std::endl;
+    YardSpec spec;
+    spec.W = 12;
+    spec.H = 5;
+    spec.L = 3;
+    spec.fill = 0.6;
+    spec.exp_ss = spec.exp_ls = 4;
+    spec.imp_ss = spec.imp_ls = 3;
+    spec.seed = 7;
+    std::string a = write_temp(""), b = write_temp("");
+    generate_instance(spec, a.c_str());
+    generate_instance(spec, b.c_str());
+    std::ifstream fa(a.c_str()), fb(b.c_str());
+    std::string ta((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+    std::string tb((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+    ASSERT(!ta.empty() && ta == tb);
+    {
+        InstanceReader in(a.c_str());
+        ASSERT(in.next_int("H") == 5 && in.next_int("W") == 12 && in.next_int("L") == 3);
+        ASSERT(in.next_int("containers") == 108);
+    }
+
+    //! Explicit reserved counts, and the yard survives random schedules
+    spec.res_ss = 6;
+    spec.res_ls = 2;
+    generate_instance(spec, b.c_str());
+    const char* file = b.c_str();
+    All_Model master(file);
+    int size = master.get_joint_bit_size();
+    std::vector<char> x(size);
+    srand(5);
+    for (int t = 0; t < 20; t++) {
+        for (auto& bit : x) bit = rand() % 2;
+        All_Model* m = master.clone();
+        ASSERT(m->fx_function_solve_joint(size, x.data(), false) > 0);
+        delete m;
+    }
+    unlink(a.c_str());
+
+    //! A full yard has no room for imports
+    spec.fill = 1.0;
+    bool thrown = false;
+    try {
+        generate_instance(spec, b.c_str());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    unlink(b.c_str());
+}
+
+void test_instrument() {
+    std::cout << "Testing instrumentation..." << std::endl;
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    std::vector<char> x(master.get_joint_bit_size(), 1);
+    instrument_reset();
+    All_Model* m = master.clone();
+    m->fx_function_solve_joint(master.get_joint_bit_size(), x.data(), false);
+    delete m;
+    InstrumentCounts c;
+    instrument_snapshot(c);
+    if (instrument_enabled()) {
+        ASSERT(c.counts[COUNT_CLONE] == 1 && c.calls[TIME_CLONE] == 1);
+        ASSERT(c.counts[COUNT_SS_SOLVE] == 1 && c.counts[COUNT_LS_SOLVE] == 1);
+        ASSERT(c.counts[COUNT_CHECK_SS] > 0 && c.counts[COUNT_CHECK_SS_STEP] >= c.counts[COUNT_CHECK_SS]);
+        ASSERT(c.counts[COUNT_FIXED_POINT_ROUND] > 0 && c.counts[COUNT_ALLOC] > 0);
+        ASSERT(c.ticks[TIME_CLONE] > 0);
+    } else {
+        ASSERT(c.counts[COUNT_CLONE] == 0 && c.calls[TIME_CLONE] == 0);
+    }
+    std::string path = write_temp("");
+    FILE* out = fopen(path.c_str(), "w");
+    instrument_report(out, true);
+    fclose(out);
+    std::ifstream in(path.c_str());
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(path.c_str());
+    ASSERT(text.find("\"check_ss_step\"") != std::string::npos);
+
+    //! Threads past the last counter block are left out rather than sharing one
+    if (instrument_enabled()) {
+        instrument_reset();
+        while (!instrument_uncounted()) {
+            std::thread t([] { PSO_COUNT(COUNT_RES_POP); });
+            t.join();
+        }
+        int threads = instrument_snapshot(c);
+        std::thread t([] { PSO_COUNT(COUNT_RES_POP); });
+        t.join();
+        InstrumentCounts after;
+        ASSERT(instrument_snapshot(after) == threads && threads == 256 && instrument_uncounted() == 2);
+        ASSERT(after.counts[COUNT_RES_POP] == c.counts[COUNT_RES_POP]);
+    } else {
+        ASSERT(instrument_uncounted() == 0);
+    }
+}
+
+void test_trace_recorder() {
+    std::cout << "Testing trace recorder..." << std::endl;
+    std::string base = write_temp("");
+    unlink(base.c_str());
+    std::string bin = base + ".bin", csv = base + ".csv";
+    {
+        TraceRecorder trace(bin);
+        ThreadPool pool(4);
+        for (int t = 0; t < 4; t++) {
+            pool.submit([&trace, t] {
+                TraceRecord r;
+                memset(&r, 0, sizeof r);
+                r.run = t;
+                for (int i = 0; i < 1000; i++) {
+                    r.iteration = i;
+                    r.gbest = i * 0.5;
+                    while (!trace.record(r)) {}
+                }
+            });
+        }
+        pool.wait();
+        trace.close();
+    }
+    std::vector<TraceRecord> records;
+    TraceRecorder::read(bin.c_str(), records);
+    ASSERT(records.size() == 4000);
+    //! Records of one thread keep their order
+    std::vector<int> next(4, 0);
+    for (size_t i = 0; i < records.size(); i++) {
+        TraceRecord& r = records[i];
+        ASSERT(r.run >= 0 && r.run < 4 && r.iteration == next[r.run]++ && r.gbest == r.iteration * 0.5);
+    }
+    unlink(bin.c_str());
+
+    //! A traced run writes one record per iteration that ends where the run does
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 10;
+    configs["ITERATION"] = 20;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOParams params(configs);
+    const char* file = "data/data_10_1.txt";
+    Matrix_Model matrix(file);
+    MatrixObjective objective(&matrix);
+    BinaryPSOResult plain = BinaryPSO(params, 5).Run(objective);
+    TraceRecorder* trace = new TraceRecorder(bin);
+    BinaryPSO pso(params, 5);
+    pso.Trace(trace, 7, 2);
+    BinaryPSOResult traced = pso.Run(objective);
+    trace->close();
+    ASSERT(trace->dropped() == 0);
+    delete trace;
+    ASSERT(traced.best == plain.best && traced.xbest == plain.xbest);
+    records.clear();
+    TraceRecorder::read(bin.c_str(), records);
+    unlink(bin.c_str());
+    ASSERT((int) records.size() == params.iterations);
+    for (size_t i = 0; i < records.size(); i++) {
+        TraceRecord& r = records[i];
+        ASSERT(r.run == 7 && r.restart == 2 && r.island == 0 && r.iteration == (int) i + 1);
+        ASSERT(r.min_obj <= r.avg_obj && r.avg_obj <= r.max_obj && r.gbest <= r.mean_pbest);
+        ASSERT(r.dispersion >= 0 && r.dispersion <= 1 && r.evaluations == (long long) (i + 1) * params.popsize);
+        ASSERT(r.diversity >= 0 && r.diversity <= 1 && r.unique >= 1 && r.unique <= params.popsize);
+        ASSERT(i == 0 || r.gbest <= records[i - 1].gbest);
+    }
+    ASSERT(records.back().gbest == traced.best);
+
+    //! CSV has a header and one line per record
+    trace = new TraceRecorder(csv);
+    pso.Trace(trace, 0, 0);
+    pso.Run(objective);
+    delete trace;
+    std::ifstream in(csv.c_str());
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) lines++;
+    unlink(csv.c_str());
+    ASSERT(lines == params.iterations + 1);
+}
+
+void test_perf_counters() {
+    std::cout << "Testing perf counters..." << std::endl;
+    //! Works with or without permission to count: without it every count is 0
+    PerfCounters perf;
+    ASSERT(perf.available() || !perf.error().empty());
+    PerfRegion region("loop");
+    double sum = 0;
+    for (int k = 0; k < 3; k++) {
+        PerfScope scope(&perf, region);
+        for (int i = 0; i < 100000; i++) sum += sqrt((double) i);
+    }
+    ASSERT(sum > 0 && region.calls == 3);
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        if (!perf.available((PerfEvent) e)) ASSERT(region.total.counts[e] == 0);
+    }
+    if (perf.available(PERF_INSTRUCTIONS)) ASSERT(region.total.counts[PERF_INSTRUCTIONS] > 300000);
+    PerfRegion calls_only;
+    {
+        PerfScope scope(NULL, calls_only);
+    }
+    ASSERT(calls_only.calls == 1 && calls_only.total.counts[PERF_CYCLES] == 0);
+    ASSERT(std::string(PerfCounters::name(PERF_BRANCH_MISSES)) == "branch_misses");
+}
+
+void test_bench_json() {
+    std::cout << "Testing benchmark JSON..." << std::endl;
+    Bench bench(0, 1, 0);
+    BenchCase c;
+    c.name = "say \"hi\"";
+    c.op = [](int i) { bench_keep(i); };
+    c.max_batch = 1;
+    bench.run(c);
+    std::string path = write_temp("");
+    FILE* out = fopen(path.c_str(), "w");
+    bench.write_json(out, "C:\\yard\t\"a\".txt");
+    fclose(out);
+    std::ifstream in(path.c_str());
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(path.c_str());
+    ASSERT(text.find("\"context\": \"C:\\\\yard\\u0009\\\"a\\\".txt\",") != std::string::npos);
+    ASSERT(text.find("{\"name\": \"say \\\"hi\\\"\",") != std::string::npos);
+    ASSERT(json_quote("a\"b\\c\nd") == "\"a\\\"b\\\\c\\u000ad\"");
+}
+
+void test_bounded_evaluation() {
+    std::cout << "Testing bounded evaluation..." << std::endl;
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    int ss_size = master.get_bit_size();
+    int size = master.get_joint_bit_size();
+    All_Model* rec = master.clone();
+    NullScheduleSink quiet;
+    rec->set_schedule_sink(&quiet);
+    std::vector<char> first(ss_size, 1);
+    rec->fx_function_solve(ss_size, first.data(), true);
+    rec->ls_analyze();
+    int ls_size = rec->get_bit_size();
+    srand(23);
+    std::vector<char> x(size);
+    for (int t = 0; t < 50; t++) {
+        for (auto& b : x) b = rand() % 2;
+        All_Model* m = master.clone();
+        double ss = m->fx_function_solve(ss_size, x.data(), false);
+        delete m;
+        m = rec->clone();
+        double ls = m->fx_function_solve_2(ls_size, x.data(), false);
+        delete m;
+        m = master.clone();
+        double joint = m->fx_function_solve_joint(size, x.data(), false);
+        delete m;
+        //! Exact below the cutoff, an admissible bound not below it otherwise
+        double cuts[] = {0, ss * 0.5, ss, ss + 1, std::numeric_limits<double>::infinity()};
+        for (double cut : cuts) {
+            m = master.clone();
+            double b = m->fx_function_solve_bounded(x.data(), cut);
+            delete m;
+            ASSERT(ss < cut ? b == ss : (b >= cut && b <= ss));
+            m = master.clone();
+            b = m->fx_function_solve_joint_bounded(x.data(), cut);
+            delete m;
+            ASSERT(joint < cut ? b == joint : (b >= cut && b <= joint));
+        }
+        double ls_cuts[] = {0, ls * 0.5, ls, ls + 1};
+        for (double cut : ls_cuts) {
+            m = rec->clone();
+            double b = m->fx_function_solve_2_bounded(x.data(), cut);
+            delete m;
+            ASSERT(ls < cut ? b == ls : (b >= cut && b <= ls));
+        }
+    }
+
+    //! Bounding changes the work done but not the outcome of a run
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 10;
+    configs["ITERATION"] = 20;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOParams params(configs);
+    ASSERT(params.bounded);
+    BinaryPSOParams full = params;
+    full.bounded = false;
+    JointObjective joint(&master);
+    ShortSpanObjective ss(&master);
+    LongSpanObjective ls(rec);
+    Objective* objectives[] = {&joint, &ss, &ls};
+    for (Objective* f : objectives) {
+        for (unsigned seed = 0; seed < 3; seed++) {
+            BinaryPSOResult a = BinaryPSO(params, seed).Run(*f);
+            BinaryPSOResult b = BinaryPSO(full, seed).Run(*f);
+            ASSERT(a.best == b.best && a.xbest == b.xbest && a.mean_pbest == b.mean_pbest);
+            ASSERT(a.evaluations == b.evaluations && a.history.size() == b.history.size());
+        }
+    }
+    delete rec;
+}
+
+void test_branch_and_bound() {
+    std::cout << "Testing branch and bound..." << std::endl;
+    //! Every genome of the smallest instance agrees with the search
+    const char* file = "data/example_data_all_small_01.txt";
+    All_Model small(file);
+    ShortSpanObjective small_ss(&small);
+    std::vector<char> x(small_ss.Size());
+    double brute = std::numeric_limits<double>::infinity();
+    for (int g = 0; g < (1 << small_ss.Size()); g++) {
+        for (int i = 0; i < small_ss.Size(); i++) x[i] = (g >> i) & 1;
+        brute = std::min(brute, small_ss.Evaluate(x.data()));
+    }
+    BranchAndBoundResult ss = BranchAndBound(&small, false).Run();
+    ASSERT(ss.optimal && ss.best == brute);
+    ASSERT(small_ss.Evaluate(ss.xbest.data()) == ss.best);
+
+    //! The optimum is returned as a genome, and is never worse than what the PSO finds
+    file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    BranchAndBoundResult serial = BranchAndBound(&master, true).Run();
+    ASSERT(serial.optimal && (int) serial.xbest.size() == joint.Size());
+    ASSERT(joint.Evaluate(serial.xbest.data()) == serial.best);
+    ASSERT(serial.pruned > 0 && serial.nodes > serial.pruned);
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 10;
+    configs["ITERATION"] = 20;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOParams params(configs);
+    for (unsigned seed = 0; seed < 3; seed++) {
+        ASSERT(serial.best <= BinaryPSO(params, seed).Run(joint).best);
+    }
+    BranchAndBound parallel(&master, true, 3);
+    BranchAndBoundResult split = parallel.Run();
+    ASSERT(split.optimal && split.best == serial.best);
+    ASSERT(joint.Evaluate(split.xbest.data()) == split.best);
+
+    //! Nothing beats the optimum, and a cut-short search is not reported optimal
+    parallel.upper = serial.best;
+    BranchAndBoundResult none = parallel.Run();
+    ASSERT(none.optimal && none.best == serial.best && none.xbest.empty());
+    BranchAndBound limited(&master, true);
+    limited.node_limit = 10;
+    ASSERT(!limited.Run().optimal);
+}
+
+void test_optimizers() {
+    std::cout << "Testing optimizers..." << std::endl;
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    double optimum = BranchAndBound(&master, true).Run().best;
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 10;
+    configs["ITERATION"] = 20;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    configs["METHOD"] = 3;
+    ASSERT(parse_method("tabu") == METHOD_TABU && parse_method("ga") == -1);
+    bool threw = false;
+    try {
+        delete make_optimizer(BinaryPSOParams(configs), 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw);
+
+    //! Every method spends the PSO budget and returns a genome that scores its best
+    for (int method = 0; method < METHODS; method++) {
+        for (int bounded = 0; bounded < 2; bounded++) {
+            configs["METHOD"] = method;
+            configs["BOUNDED"] = bounded;
+            BinaryPSOParams params(configs);
+            Optimizer* a = make_optimizer(params, 5);
+            Optimizer* b = make_optimizer(params, 5);
+            BinaryPSOResult ra = a->Run(joint);
+            BinaryPSOResult rb = b->Run(joint);
+            delete a;
+            delete b;
+            ASSERT(ra.evaluations == 200 && ra.best == rb.best && ra.xbest == rb.xbest);
+            ASSERT(joint.Evaluate(ra.xbest.data()) == ra.best && ra.best >= optimum);
+            ASSERT(!ra.history.empty() && ra.history.back().best == ra.best);
+            for (size_t i = 1; i < ra.history.size(); i++) ASSERT(ra.history[i].best < ra.history[i - 1].best);
+        }
+    }
+
+    //! The tempering replicas give the same run on any number of threads
+    configs["METHOD"] = METHOD_ANNEALING;
+    configs["BOUNDED"] = 1;
+    configs["REPLICAS"] = 3;
+    BinaryPSOParams params(configs);
+    BinaryPSOResult one = Annealing(params, 9, 1).Run(joint);
+    BinaryPSOResult three = Annealing(params, 9, 3).Run(joint);
+    ASSERT(one.best == three.best && one.xbest == three.xbest && one.evaluations == three.evaluations);
+    ASSERT(one.mean_pbest >= one.best);
+}
+
+void test_beam_search() {
+    std::cout << "Testing beam search..." << std::endl;
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    ShortSpanObjective ss(&master);
+    double optimum = BranchAndBound(&master, true).Run().best;
+    double ss_optimum = BranchAndBound(&master, false).Run().best;
+
+    //! A beam of any width builds a complete schedule, never better than the optimum
+    for (int width : {1, 4, 64}) {
+        BeamSearchResult r = BeamSearch(&master, width, true).Run();
+        ASSERT((int) r.xbest.size() == joint.Size() && joint.Evaluate(r.xbest.data()) == r.best);
+        ASSERT(r.best >= optimum && r.nodes > 0);
+        BeamSearchResult s = BeamSearch(&master, width, false).Run();
+        ASSERT((int) s.xbest.size() == ss.Size() && ss.Evaluate(s.xbest.data()) == s.best);
+        ASSERT(s.best >= ss_optimum);
+    }
+
+    //! A beam wide enough to hold every state finds the optimum
+    BeamSearchResult wide = BeamSearch(&master, 1 << 20, false).Run();
+    ASSERT(wide.best == ss_optimum);
+    BeamSearchResult split = BeamSearch(&master, 8, true, 3).Run();
+    BeamSearchResult serial = BeamSearch(&master, 8, true, 1).Run();
+    ASSERT(split.best == serial.best && split.xbest == serial.xbest && split.nodes == serial.nodes);
+}
+
+void test_surrogate() {
+    std::cout << "Testing surrogate screening..." << std::endl;
+    //! The nearest stored solution decides with one neighbour, and the oldest is forgotten first
+    Surrogate nearest(70, 2, 1);
+    std::vector<char> a(70, 0), b(70, 1), c(70, 0);
+    c[69] = 1;
+    ASSERT(!nearest.ready());
+    nearest.add(a.data(), 5);
+    nearest.add(b.data(), 9);
+    ASSERT(nearest.ready() && nearest.predict(c.data()) == 5 && nearest.predict(b.data()) == 9);
+    nearest.add(c.data(), 7);
+    ASSERT(nearest.predict(a.data()) == 7);
+    Surrogate mean(70, 8, 2);
+    mean.add(a.data(), 4);
+    mean.add(b.data(), 8);
+    double p = mean.predict(c.data());
+    ASSERT(p > 4 && p < 8);
+
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 30;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOResult plain = BinaryPSO(BinaryPSOParams(configs), 3).Run(joint);
+    ASSERT(plain.screened == 0 && plain.evaluations == 600);
+
+    //! The first iteration is evaluated in full, then a quarter of the swarm per iteration
+    configs["SCREEN"] = 0.25;
+    BinaryPSOResult screened = BinaryPSO(BinaryPSOParams(configs), 3).Run(joint);
+    ASSERT(screened.evaluations == 20 + 29 * 5 && screened.evaluations + screened.screened == 600);
+    ASSERT(joint.Evaluate(screened.xbest.data()) == screened.best);
+    for (size_t i = 1; i < screened.history.size(); i++) {
+        ASSERT(screened.history[i].best < screened.history[i - 1].best);
+    }
+}
+
+void test_relaxed_evaluation() {
+    std::cout << "Testing relaxed evaluation..." << std::endl;
+    const char* file = "data/example_data_all_small_03.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    All_Model* rec = master.clone();
+    NullScheduleSink quiet;
+    rec->set_schedule_sink(&quiet);
+    std::vector<char> first(master.get_bit_size(), 0);
+    rec->fx_function_solve(first.size(), first.data(), true);
+    rec->ls_analyze();
+    LongSpanObjective ls(rec);
+    ShortSpanObjective ss(&master);
+
+    //! The relaxed score never exceeds the exact one, and is exact without a long-span crane
+    srand(29);
+    bool below = false;
+    for (int t = 0; t < 100; t++) {
+        std::vector<char> x(joint.Size());
+        for (auto& b : x) b = rand() % 2;
+        double exact = joint.Evaluate(x.data()), relaxed = joint.EvaluateRelaxed(x.data());
+        ASSERT(relaxed <= exact && relaxed >= ss.Evaluate(x.data()));
+        double ls_exact = ls.Evaluate(x.data()), ls_relaxed = ls.EvaluateRelaxed(x.data());
+        ASSERT(ls_relaxed <= ls_exact);
+        below = below || ls_relaxed < ls_exact;
+        ASSERT(ss.EvaluateRelaxed(x.data()) == ss.Evaluate(x.data()));
+    }
+    ASSERT(below);
+
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 30;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    configs["FIDELITY"] = 0.25;
+    configs["SCREEN"] = 0.5;
+    BinaryPSOResult r = BinaryPSO(BinaryPSOParams(configs), 8).Run(joint);
+    ASSERT(r.relaxed == 29 * 20 && r.evaluations + r.screened == 600 && r.evaluations <= 20 + 29 * 5);
+    ASSERT(r.relaxed_gap >= 0 && r.relaxed_gap < 1);
+    ASSERT(joint.Evaluate(r.xbest.data()) == r.best);
+
+    //! Without a relaxation there is no cheaper tier, so FIDELITY changes nothing
+    ASSERT(!ss.Relaxes() && ls.Relaxes() && joint.Relaxes());
+    configs.erase("SCREEN");
+    BinaryPSOResult tiered = BinaryPSO(BinaryPSOParams(configs), 8).Run(ss);
+    configs.erase("FIDELITY");
+    BinaryPSOResult plain = BinaryPSO(BinaryPSOParams(configs), 8).Run(ss);
+    ASSERT(tiered.relaxed == 0 && tiered.screened == 0 && tiered.evaluations == plain.evaluations);
+    ASSERT(tiered.best == plain.best && tiered.xbest == plain.xbest);
+    delete rec;
+}
+
+void test_inertia_and_shrinking() {
+    std::cout << "Testing inertia schedules and swarm shrinking..." << std::endl;
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 11;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSO fixed(BinaryPSOParams(configs), 1);
+    ASSERT(fixed.Inertia(1, 1) == 0.9 && fixed.Inertia(11, 0) == 0.9);
+    configs["INERTIA"] = INERTIA_LINEAR;
+    BinaryPSO linear(BinaryPSOParams(configs), 1);
+    ASSERT(linear.Inertia(1, 0) == 0.9 && fabs(linear.Inertia(6, 0) - 0.65) < 1e-12 && fabs(linear.Inertia(11, 1) - 0.4) < 1e-12);
+    configs["INERTIA"] = INERTIA_ADAPTIVE;
+    configs["WEIGHTEND"] = 0.5;
+    BinaryPSO adaptive(BinaryPSOParams(configs), 1);
+    ASSERT(adaptive.Inertia(3, 1) == 0.9 && adaptive.Inertia(3, 0) == 0.5 && fabs(adaptive.Inertia(3, 0.5) - 0.7) < 1e-12);
+
+    //! Only a particle repeating both the position and the personal best of an earlier one is a duplicate
+    std::vector<std::vector<char> > x = {{0, 1, 1}, {0, 1, 1}, {1, 1, 1}, {0, 1, 1}, {0, 1, 1}};
+    std::vector<std::vector<char> > xpbest = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {1, 0, 0}, {0, 0, 0}};
+    std::vector<int> dup;
+    BinaryPSO::Duplicates(x, xpbest, dup);
+    ASSERT(dup == std::vector<int>({1, 4}));
+
+    //! A converging swarm retires duplicates but never below MINPOP, and the best stays exact
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    configs.erase("INERTIA");
+    configs["ITERATION"] = 40;
+    BinaryPSOResult full = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    configs["MINPOP"] = 5;
+    BinaryPSOResult shrunk = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    ASSERT(full.retired == 0 && full.evaluations == 800);
+    ASSERT(shrunk.retired > 0 && shrunk.retired <= 15 && shrunk.evaluations < 800);
+    ASSERT(joint.Evaluate(shrunk.xbest.data()) == shrunk.best);
+}
+
+void test_duplicates() {
+    std::cout << "Testing diversity and duplicate particles..." << std::endl;
+    PackedSwarm packed(70);
+    std::vector<std::vector<char> > x(3, std::vector<char>(70, 0));
+    x[1][3] = x[1][65] = 1;
+    packed.assign(x);
+    ASSERT(PackedSwarm::distance(packed.row(0), packed.row(1), 2) == 2 && packed.unique() == 2);
+    ASSERT(fabs(packed.diversity() - 4.0 / 3 / 70) < 1e-12 && fabs(packed.dispersion(x[1].data()) - 4.0 / 3 / 70) < 1e-12);
+    ASSERT(packed.hash(0) == packed.hash(2) && packed.hash(0) != packed.hash(1));
+
+    //! Genomes with the same decoded key have the same fitness
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    std::mt19937 rng(4);
+    int n = joint.Size(), same = 0;
+    std::vector<char> a(n), b;
+    for (int t = 0; t < 200; t++) {
+        for (int j = 0; j < n; j++) a[j] = rng() % 2;
+        b = a;
+        b[rng() % n] ^= 1;
+        if (joint.Key(a.data()) == joint.Key(b.data())) {
+            ASSERT(joint.Evaluate(a.data()) == joint.Evaluate(b.data()));
+            same++;
+        }
+    }
+    ASSERT(same > 0);
+
+    //! One crane's key needs no clone and equals the key decoded on one. In the last yard
+    //! container 1 is reserved for the export of container 0 below it and exported itself.
+    std::string yard = write_temp("3 1 2\n2\n0 0 0\n1 0 0\n1\n0 0 1\n1\n1\n0\n2\n0\n1\n0\n0\n0\n0\n");
+    const char* files[] = {"data/example_data_all_small_01.txt", file, "data/example_data_all_small_03.txt", yard.c_str()};
+    for (const char* f : files) {
+        All_Model phase(f);
+        All_Model* rec = phase.clone();
+        NullScheduleSink quiet;
+        rec->set_schedule_sink(&quiet);
+        std::vector<char> first(phase.get_bit_size(), 1);
+        rec->fx_function_solve(first.size(), first.data(), true);
+        rec->ls_analyze();
+        ShortSpanObjective ss(&phase);
+        LongSpanObjective ls(rec);
+        std::set<uint64_t> keys;
+        for (int t = 0; t < 100; t++) {
+            Objective* o = (t % 2) ? (Objective*) &ls : (Objective*) &ss;
+            std::vector<char> y(o->Size());
+            for (auto& bit : y) bit = rng() % 2;
+            All_Model* m = (t % 2 ? rec : &phase)->clone();
+            ASSERT(o->Key(y.data()) == m->decoded_key(y.data(), t % 2 == 0, t % 2 == 1));
+            delete m;
+            keys.insert(o->Key(y.data()));
+        }
+        ASSERT(keys.size() > 2);
+        delete rec;
+    }
+    unlink(yard.c_str());
+
+    //! Sharing an evaluation between duplicates leaves the search unchanged
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 40;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOResult plain = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    configs["DEDUP"] = DEDUP_BITS;
+    BinaryPSOResult bits = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    configs["DEDUP"] = DEDUP_DECODED;
+    BinaryPSOResult decoded = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    ASSERT(plain.duplicates == 0 && bits.duplicates > 0 && decoded.duplicates >= bits.duplicates);
+    ASSERT(plain.key_seconds == 0 && bits.key_seconds == 0 && decoded.key_seconds > 0);
+    ASSERT(bits.best == plain.best && bits.xbest == plain.xbest && bits.evaluations + bits.duplicates == plain.evaluations);
+    ASSERT(decoded.best == plain.best && decoded.evaluations + decoded.duplicates == plain.evaluations);
+    configs["RESEED"] = 1;
+    BinaryPSOResult reseeded = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    ASSERT(reseeded.reseeded > 0 && reseeded.evaluations + reseeded.duplicates == plain.evaluations);
+    ASSERT(joint.Evaluate(reseeded.xbest.data()) == reseeded.best);
+
+    //! A restart ends once the diversity falls below MINDIV, here after the first moves
+    configs.erase("DEDUP");
+    configs["MINDIV"] = 0.9;
+    BinaryPSOResult stopped = BinaryPSO(BinaryPSOParams(configs), 2).Run(joint);
+    ASSERT(stopped.evaluations == 40 && stopped.diversity < 0.9);
+}
+
+void test_warm_start() {
+    std::cout << "Testing warm starts on a changed instance..." << std::endl;
+    const char* file = "data/example_data_all_small_03.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    int n = joint.Size();
+
+    //! Remapped onto the same instance, a genome makes the same moves
+    std::mt19937 rng(6);
+    std::vector<char> x(n), y(n);
+    for (int t = 0; t < 20; t++) {
+        for (int j = 0; j < n; j++) x[j] = rng() % 2;
+        All_Model* a = master.clone();
+        All_Model* b = master.clone();
+        b->remap_genome(*a, x.data(), true, y.data());
+        delete a;
+        delete b;
+        ASSERT(joint.Key(x.data()) == joint.Key(y.data()) && joint.Evaluate(x.data()) == joint.Evaluate(y.data()));
+    }
+
+    //! One long-span import less: the old swarm starts the new run ahead of random genomes
+    std::ifstream in(file);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    ASSERT(lines.size() == 34 && lines[30] == "2");
+    lines[30] = "1";
+    std::string changed = "/tmp/pso_warm_start_" + std::to_string(getpid()) + ".txt";
+    std::ofstream out(changed.c_str());
+    for (const std::string& line : lines) out << line << "\n";
+    out.close();
+    const char* path = changed.c_str();
+    All_Model next(path);
+    unlink(path);
+    JointObjective moved(&next);
+
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 50;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    BinaryPSOResult old = BinaryPSO(BinaryPSOParams(configs), 1).Run(joint);
+    ASSERT((int) old.swarm.size() == 20 && old.best == 574);
+    std::vector<std::vector<char> > start = warm_start(master, next, true, old);
+    ASSERT(!start.empty() && (int) start[0].size() == moved.Size());
+    //! The old best still applies: one import less does not make its moves worse
+    double carried = moved.Evaluate(start[0].data());
+    ASSERT(carried <= old.best);
+    configs["ITERATION"] = 5;
+    BinaryPSO pso(BinaryPSOParams(configs), 2);
+    pso.start = start;
+    BinaryPSOResult warm = pso.Run(moved);
+    ASSERT(warm.best <= carried);
+    ASSERT(moved.Evaluate(warm.xbest.data()) == warm.best);
+
+    pso.start.assign(1, std::vector<char>(n + 1));
+    bool thrown = false;
+    try {
+        pso.Run(moved);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+void test_rolling_horizon() {
+    std::cout << "Testing the rolling-horizon scheduler..." << std::endl;
+    StreamJob job;
+    ASSERT(!parse_stream_job("", job) && !parse_stream_job("  # comment", job));
+    ASSERT(parse_stream_job("imp ls", job) && job.ls && job.import && job.container == -1);
+    ASSERT(parse_stream_job(" exp ss 7 ", job) && !job.ls && !job.import && job.container == 7);
+    const char* bad[] = {"exp ss", "imp xx", "mov ss 1", "imp ss 3"};
+    for (const char* line : bad) {
+        bool thrown = false;
+        try {
+            parse_stream_job(line, job);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+
+    //! The jobs of the instance and three streamed ones are served window by window, each
+    //! window's events inside its own span of time
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 10;
+    configs["ITERATION"] = 20;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    RollingHorizon horizon("data/example_data_all_small_03.txt", BinaryPSOParams(configs), 4);
+    VectorScheduleSink sink;
+    horizon.set_schedule_sink(&sink);
+    ASSERT(horizon.pending() == 10 && horizon.ready() && horizon.containers().size() == 10);
+    const char* stream[] = {"exp ss 0", "imp ls", "imp ss"};
+    for (const char* line : stream) {
+        ASSERT(parse_stream_job(line, job));
+        horizon.add(job);
+    }
+    bool thrown = false;
+    try {
+        parse_stream_job("exp ls 0", job);
+        horizon.add(job);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    int jobs = 0, windows = 0;
+    double end = 0;
+    while (horizon.pending() > 0) {
+        size_t first = sink.events.size();
+        RollingWindow w = horizon.step();
+        ASSERT(w.jobs > 0 && w.jobs <= 4 && w.moves >= w.jobs && w.start == end && w.makespan > 0 && w.dropped == 0);
+        ASSERT(w.evaluations == 200);
+        for (size_t e = first; e < sink.events.size(); e++) {
+            ASSERT(sink.events[e].start >= w.start && sink.events[e].start + sink.events[e].duration <= w.start + w.makespan);
+        }
+        end = w.start + w.makespan;
+        jobs += w.jobs;
+        windows++;
+    }
+    ASSERT(jobs == 13 && windows >= 4 && horizon.clock() == end);
+    //! Seven imports in, six exports out, and container 0 has left the yard
+    std::map<int, dat> yard = horizon.containers();
+    ASSERT(yard.size() == 11 && yard.count(0) == 0);
+    thrown = false;
+    try {
+        horizon.step();
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    //! A 2x1x2 yard whose one free slot, on stack 1, goes to its own import. Stack 0 takes
+    //! no containers, so exporting its top frees nothing; exporting container 2 does.
+    std::string path = write_temp("2 1 2\n3\n0 0 0\n1 0 0\n0 0 1\n1\n1 0 1\n0\n1\n0\n0\n0\n0\n");
+    RollingHorizon full(path.c_str(), BinaryPSOParams(configs), 4);
+    unlink(path.c_str());
+    const char* lines[] = {"imp ls", "exp ss 1", "imp ls", "exp ls 2", "imp ls"};
+    bool accepted[] = {false, true, false, true, true};
+    for (int i = 0; i < 5; i++) {
+        ASSERT(parse_stream_job(lines[i], job));
+        thrown = false;
+        try {
+            full.add(job);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown != accepted[i]);
+    }
+    //! The import and the top export fit. Container 2 is then under the new import with no
+    //! slot to move it to, and the last import waits for its slot, so nothing fits and one
+    //! window drops each of them instead of aborting the run.
+    RollingWindow w = full.step();
+    ASSERT(w.jobs == 2 && w.dropped == 0 && full.pending() == 2);
+    for (int i = 0; i < 2; i++) {
+        w = full.step();
+        ASSERT(w.jobs == 0 && w.dropped == 1 && w.moves == 0 && w.makespan == 0 && w.evaluations == 0);
+    }
+    ASSERT(full.pending() == 0 && full.containers().size() == 3);
+}
+
+void test_pareto_archive() {
+    std::cout << "Testing the Pareto archive..." << std::endl;
+    ParetoArchive archive(2, 3);
+    const char bits[2] = {0, 1};
+    double points[][2] = {{1, 5}, {2, 4}, {3, 6}, {2, 4}, {0, 10}, {1.5, 1}};
+    bool kept[] = {true, true, false, false, true, true};
+    for (int i = 0; i < 6; i++) ASSERT(archive.insert(points[i], bits, 2) == kept[i]);
+    //! (1.5, 1) pushed (2, 4) out, and the most crowded point goes once over capacity
+    ASSERT(archive.front().size() == 3 && archive.front()[2].f[0] == 1.5 && archive.front()[2].x[1] == 1);
+    double crowded[2] = {1.2, 3};
+    ASSERT(!archive.insert(crowded, bits, 2) && archive.front().size() == 3);
+    ASSERT(archive.front()[0].f[1] == 10 && archive.front()[1].f[1] == 5);
+
+    //! Without pruning the archive is the non-dominated set, checked pair by pair
+    std::mt19937 rng(3);
+    for (int m = 2; m <= 3; m++) {
+        ParetoArchive all(m, 1000);
+        std::vector<std::vector<double> > seen;
+        for (int t = 0; t < 400; t++) {
+            std::vector<double> f(m);
+            for (int k = 0; k < m; k++) f[k] = rng() % 50;
+            all.insert(f.data(), bits, 2);
+            seen.push_back(f);
+        }
+        std::set<std::vector<double> > expected;
+        for (auto& a : seen) {
+            bool dominated = false;
+            for (auto& b : seen) dominated = dominated || ParetoArchive::dominates(b.data(), a.data(), m);
+            if (!dominated) expected.insert(a);
+        }
+        std::set<std::vector<double> > got;
+        for (size_t i = 0; i < all.front().size(); i++) {
+            got.insert(all.front()[i].f);
+            ASSERT(i == 0 || all.front()[i - 1].f[0] <= all.front()[i].f[0]);
+        }
+        ASSERT(got == expected && got.size() == all.front().size());
+    }
+
+    //! The makespan of the objective vector is the fitness, waits and travel stay apart
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    JointObjective joint(&master);
+    int n = joint.Size();
+    std::vector<char> x(n);
+    for (int j = 0; j < n; j++) x[j] = rng() % 2;
+    double f[3];
+    ASSERT(joint.Objectives() == 3 && joint.EvaluateVector(x.data(), f) == joint.Evaluate(x.data()));
+    ASSERT(f[0] == joint.Evaluate(x.data()) && f[1] >= 0 && f[2] > 0);
+
+    //! A PSO run keeps a non-dominated front whose first point is the best makespan
+    std::map<std::string, double> configs;
+    configs["POPSIZE"] = 20;
+    configs["ITERATION"] = 30;
+    configs["WEIGHT"] = 0.9;
+    configs["C1"] = 2;
+    configs["C2"] = 2;
+    configs["VMAX"] = 4;
+    configs["PARETO"] = 8;
+    BinaryPSOResult res = BinaryPSO(BinaryPSOParams(configs), 5).Run(joint);
+    ASSERT(!res.front.empty() && res.front.size() <= 8 && res.front[0].f[0] == res.best);
+    for (auto& a : res.front) {
+        double g[3];
+        joint.EvaluateVector(std::vector<char>(a.x).data(), g);
+        ASSERT(g[0] == a.f[0] && g[1] == a.f[1] && g[2] == a.f[2]);
+        for (auto& b : res.front) ASSERT(!ParetoArchive::dominates(b.f.data(), a.f.data(), 3));
+    }
+}
+
+static ScheduleEvent crane_event(int crane, int type, int from, int to, double start, double duration) {
+    ScheduleEvent e;
+    memset(&e, 0, sizeof e);
+    e.type = type;
+    e.crane = crane;
+    e.from_w = from;
+    e.to_w = to;
+    e.start = start;
+    e.duration = duration;
+    return e;
+}
+
+//! The bay of a crane at a time, found event by event as the old per-time-unit scan did
+static int bay_at(const std::vector<ScheduleEvent>& events, int crane, int t) {
+    const ScheduleEvent* last = NULL;
+    for (const ScheduleEvent& e : events) {
+        if (e.crane == crane && e.start <= t) last = &e;
+        if (e.crane == crane && !last) return e.from_w;
+    }
+    if (t >= last->start + last->duration || last->from_w == last->to_w) return last->to_w;
+    int steps = abs(last->to_w - last->from_w);
+    int k = (int) ((t - last->start) / (last->duration / steps));
+    return last->from_w + (last->to_w > last->from_w ? k : -k);
+}
+
+void test_schedule_validator() {
+    std::cout << "Testing the schedule validator..." << std::endl;
+    //! The long-span crane comes down onto the short-span one parked at bay 5
+    std::vector<ScheduleEvent> events;
+    events.push_back(crane_event(0, EVENT_MOVE, 0, 5, 0, 15));
+    events.push_back(crane_event(0, EVENT_PICK, 5, 5, 15, 28));
+    events.push_back(crane_event(1, EVENT_WAIT, 8, 8, 0, 15));
+    events.push_back(crane_event(1, EVENT_MOVE, 8, 2, 15, 18));
+    std::vector<ScheduleViolation> v = validate_schedule(events);
+    ASSERT(v.size() == 1 && v[0].type == VIOLATION_CROSSING && v[0].time == 24 && v[0].bay == 5 && v[0].other_bay == 5);
+    ASSERT(v[0].crane == 0 && v[0].event == 1 && v[0].other == 3 && !describe_violation(v[0]).empty());
+    events[3].to_w = 6;
+    events[3].duration = 6;
+    ASSERT(validate_schedule(events).empty());
+
+    //! Broken ordering of one crane
+    events.push_back(crane_event(1, EVENT_DROP, 7, 7, 20, 28));
+    events.push_back(crane_event(1, EVENT_MOVE, 7, 9, 40, 0));
+    events.push_back(crane_event(1, EVENT_PICK, 9, 9, 30, 1));
+    int count[5] = {0, 0, 0, 0, 0};
+    for (const ScheduleViolation& w : validate_schedule(events)) count[w.type]++;
+    ASSERT(count[VIOLATION_CROSSING] == 0 && count[VIOLATION_ORDER] == 1 && count[VIOLATION_OVERLAP] == 3);
+    ASSERT(count[VIOLATION_JUMP] == 3 && count[VIOLATION_DURATION] == 1);
+
+    //! Simulated schedules are valid, and shifting the long-span crane in time finds the
+    //! same first crossing as a scan of every time unit
+    const char* file = "data/example_data_all_small_02.txt";
+    All_Model master(file);
+    int n = master.get_joint_bit_size();
+    std::mt19937 rng(6);
+    int crossed = 0;
+    for (int t = 0; t < 20; t++) {
+        std::vector<char> x(n);
+        for (int j = 0; j < n; j++) x[j] = rng() % 2;
+        VectorScheduleSink sink;
+        All_Model* m = master.clone();
+        m->set_schedule_sink(&sink);
+        double makespan = m->fx_function_solve_joint(n, x.data(), true);
+        ASSERT(validate_schedule(sink.events).empty() && m->validate().empty());
+        delete m;
+        int shift = (int) (rng() % 60) - 30;
+        for (ScheduleEvent& e : sink.events) {
+            if (e.crane == 1) e.start += shift;
+        }
+        v = validate_schedule(sink.events);
+        int first = -1;
+        for (int u = std::min(0, shift); u <= makespan + 30 && first < 0; u++) {
+            if (bay_at(sink.events, 0, u) >= bay_at(sink.events, 1, u)) first = u;
+        }
+        double found = -1;
+        for (const ScheduleViolation& w : v) {
+            ASSERT(w.type == VIOLATION_CROSSING);
+            if (found < 0 || w.time < found) found = w.time;
+        }
+        ASSERT(found == first);
+        if (first >= 0) crossed++;
+    }
+    ASSERT(crossed > 0);
+}
+
 int main() {
     test_sigmoid();
     test_logsig();
@@ -88,6 +1550,30 @@ int main() {
     test_binary_2_decimal();
     test_adjust();
     test_model();
+    test_all_model_joint();
+    test_rail_schedule();
+    test_instance_reader();
+    test_binary_instance();
+    test_batch_solve();
+    test_schedule_sink();
+    test_instance_set();
+    test_instance_generator();
+    test_instrument();
+    test_trace_recorder();
+    test_perf_counters();
+    test_bench_json();
+    test_bounded_evaluation();
+    test_branch_and_bound();
+    test_optimizers();
+    test_beam_search();
+    test_surrogate();
+    test_relaxed_evaluation();
+    test_inertia_and_shrinking();
+    test_duplicates();
+    test_warm_start();
+    test_rolling_horizon();
+    test_pareto_archive();
+    test_schedule_validator();
 
     std::cout << "All tests passed!" << std::endl;
 